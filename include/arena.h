@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Monotonic bump allocator for data that lives at most one generation.
+// allocate() only moves a pointer; individual frees do nothing. reset()
+// rewinds everything at once (the generation boundary) and, if the
+// generation needed more than one block, replaces them by a single block
+// as large as the high-water mark, so steady-state generations never call
+// malloc. Not thread-safe: one arena per owning thread (per Swarm).
+class Arena {
+public:
+    explicit Arena(size_t blockBytes = 64 * 1024);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Free everything allocated since the last reset
+    void reset();
+
+    // Stack-like scratch: everything allocated after mark() is released by
+    // rewind(mark) (per-step temporaries inside a generation)
+    struct Mark {
+        size_t block;
+        size_t used;
+    };
+    Mark mark() const { return {current, used}; }
+    void rewind(const Mark& mark);
+
+    // Statistics
+    size_t getBytesInUse() const;                          // Since the last reset
+    size_t getHighWaterMark() const { return highWater; }  // Largest getBytesInUse() so far
+    size_t getReservedBytes() const;                       // Held from the system
+    size_t getBlockCount() const { return blocks.size(); }
+    long long getBlockAllocations() const { return blockAllocations; }  // mallocs so far
+    long long getResets() const { return resets; }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t current;      // Block being filled
+    size_t used;         // Bytes used in the current block
+    size_t blockBytes;   // Minimum size of a new block
+    size_t highWater;
+    long long blockAllocations;
+    long long resets;
+
+    void addBlock(size_t minBytes);
+};
+
+// Releases the arena's allocations made during its lifetime on scope exit
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena), start(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena;
+    Arena::Mark start;
+};
+
+// STL allocator over an Arena. Without an arena (default-constructed) it
+// uses the global heap, so containers work the same outside a Swarm.
+// A container must be emptied before its arena is reset.
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : arena(nullptr) {}
+    explicit ArenaAllocator(Arena* arena) noexcept : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        if (arena) {
+            return arena->allocateArray<T>(count);
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+        if (!arena) {
+            ::operator delete(pointer);
+        }
+    }
+
+    Arena* getArena() const noexcept { return arena; }
+
+    // Containers take their arena along when moved or swapped
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+private:
+    Arena* arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) noexcept {
+    return !(a == b);
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
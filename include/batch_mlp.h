@@ -0,0 +1,57 @@
+#pragma once
+#include "neural_network.h"
+#include <Eigen/Dense>
+#include <vector>
+#include <cstdint>
+
+// Fully connected tanh network evaluated on a whole batch at once (one sample
+// per column), with backpropagation and Adam. Weights are initialized and laid
+// out like NeuralNetwork, so a trained actor converts to the networks the
+// swarm and the viewer use. With linearOutput the last layer has no tanh
+// (critics).
+class BatchMlp {
+public:
+    BatchMlp(const std::vector<int>& layerSizes, bool linearOutput, uint32_t seed);
+
+    // Outputs for every column of input; activations are kept for backward()
+    const Eigen::MatrixXf& forward(const Eigen::MatrixXf& input);
+
+    // Outputs only (no state kept; usable while another batch is in flight)
+    Eigen::MatrixXf predict(const Eigen::MatrixXf& input) const;
+
+    // Backpropagate dLoss/dOutput of the last forward(): adds to the parameter
+    // gradients (unless accumulate is false) and returns dLoss/dInput
+    Eigen::MatrixXf backward(const Eigen::MatrixXf& outputGradient, bool accumulate = true);
+
+    // Apply the accumulated gradients with Adam and clear them
+    void adamStep(float learningRate);
+    void clearGradients();
+
+    // this = tau * source + (1 - tau) * this (target networks)
+    void softUpdate(const BatchMlp& source, float tau);
+
+    // Flat parameters in NeuralNetwork order
+    void getParameters(std::vector<float>& params) const;
+    void setParameters(const std::vector<float>& params);
+    void copyTo(NeuralNetwork& network) const;  // Same layer sizes required
+
+    const std::vector<int>& getLayerSizes() const { return layerSizes; }
+
+private:
+    std::vector<int> layerSizes;
+    bool linearOutput;
+
+    std::vector<Eigen::MatrixXf> weights;
+    std::vector<Eigen::VectorXf> biases;
+    std::vector<Eigen::MatrixXf> weightGrads;
+    std::vector<Eigen::VectorXf> biasGrads;
+
+    // Adam moments
+    std::vector<Eigen::MatrixXf> weightM, weightV;
+    std::vector<Eigen::VectorXf> biasM, biasV;
+    int adamSteps;
+
+    std::vector<Eigen::MatrixXf> activations;  // Input + every layer's output
+
+    bool isLinear(size_t layer) const { return linearOutput && layer + 1 == weights.size(); }
+};
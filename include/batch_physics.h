@@ -0,0 +1,28 @@
+#pragma once
+#include "vec3xn.h"
+#include "drone.h"
+#include "environment.h"
+
+// Drone physics and wall tests for simdLanes drones at once (one drone and
+// one environment per lane, as in VecEnv). Each function gives per lane
+// bit for bit what the scalar method named in its comment gives; lanes
+// outside `active` are left as they were.
+
+// Drone::applyControl: velocity += control * strength, forward bias, speed limit
+void applyControlN(Vec3xN& velocity, const Vec3xN& control, MaskN active, float controlStrength, float maxSpeed);
+
+// Drone::update: position += velocity * dt, then damping
+void updateN(Vec3xN& position, Vec3xN& velocity, MaskN active, float dt);
+
+// Wall, hole and bounds of simdLanes Environments
+struct WallN {
+    FloatN wallZ, holeX, holeY, holeRadius;
+    Vec3xN boundsMin, boundsMax;
+
+    WallN();
+    void setLane(int i, const Environment& environment);
+};
+
+MaskN isInHoleN(const WallN& wall, const Vec3xN& position);                               // Environment::isInHole
+MaskN collidesWithWallN(const WallN& wall, const Vec3xN& position, FloatN droneRadius);  // Environment::collidesWithWall
+MaskN isOutOfBoundsN(const WallN& wall, const Vec3xN& position);                          // Environment::isOutOfBounds
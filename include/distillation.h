@@ -0,0 +1,37 @@
+#pragma once
+#include "batch_mlp.h"
+#include "policy_eval.h"
+#include "sim_config.h"
+#include <vector>
+#include <cstdint>
+
+// Teacher's (observation, action) pairs, one sample per column: both arrays
+// are contiguous column-major matrices (observationSize x size and
+// actionSize x size), so a batch maps straight onto Eigen
+struct DistillDataset {
+    std::vector<float> observations;
+    std::vector<float> actions;
+
+    int size() const;
+    void clear();
+};
+
+struct DistillTraining {
+    int epochs = 30;
+    int batchSize = 256;
+    float learningRate = 1e-3f;
+    uint64_t seed = 1;  // Shuffling order
+};
+
+// Fly `episodes` episodes, episode i from deriveSeed(config.seed,
+// SeedStream::Trial, i), and append the teacher's action for every
+// observation seen. The flight is driven by `driver` (the teacher if empty)
+// plus gaussian noise of actionNoise on every control; recorded labels are
+// always the teacher's clean actions, so noise and a student driver (DAgger)
+// show the student the states its own mistakes lead to.
+void recordTeacher(const BatchPolicy& teacher, const BatchPolicy& driver, const SimConfig& config, int episodes,
+                   float actionNoise, DistillDataset& dataset);
+
+// Minibatch Adam on the mean squared error to the teacher's actions; returns
+// the last epoch's mean loss (per sample, summed over actions)
+float trainStudent(BatchMlp& student, const DistillDataset& dataset, const DistillTraining& training);
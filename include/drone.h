@@ -1,6 +1,8 @@
 #pragma once
 #include "vec3.h"
 #include "environment.h"
+#include "sim_config.h"
+#include "arena.h"
 #include <vector>
 #include <memory>
 
@@ -9,7 +11,14 @@ class NeuralNetwork;
 // Represents a single drone
 class Drone {
 public:
-    Drone(const Vec3& startPos);
+    static const int sensorCount = 22;
+    static const int controlCount = 4;
+
+    // Velocity kept per update() and +z per applyControl() (see drone.cpp)
+    static constexpr float damping = 0.995f;
+    static constexpr float forwardBias = 0.06f;
+
+    Drone(const Vec3& startPos, const SimConfig& config = SimConfig());
 
     // Reset drone to starting position
     void reset(const Vec3& startPos);
@@ -19,10 +28,14 @@ public:
 
     // Apply control from neural network output
     void applyControl(const std::vector<float>& control);
+    void applyControl(const float* control);  // controlCount values
 
     // Get sensor readings for neural network input
     std::vector<float> getSensorReadings(const Environment& env) const;
 
+    // Same readings into out[0..sensorCount) without allocating
+    void writeSensorReadings(const Environment& env, float* out) const;
+
     // Check if drone passed through hole
     bool hasPassedThroughHole(const Environment& env) const;
 
@@ -36,16 +49,26 @@ public:
     bool isActive() const { return active; }
     bool isSuccessful() const { return successful; }
 
-    // Get trajectory history for learning
-    const std::vector<std::vector<float>>& getTrajectory() const { return trajectory; }
-    void recordStep(const std::vector<float>& sensors) {
-        trajectory.push_back(sensors);
+    // Trajectory history for learning: the sensor readings of every step,
+    // sensorCount floats each, back to back
+    size_t getTrajectoryLength() const { return trajectory.size() / sensorCount; }
+    const float* getTrajectoryStep(size_t step) const { return trajectory.data() + step * sensorCount; }
+    void recordStep(const float* sensors) {
+        trajectory.insert(trajectory.end(), sensors, sensors + sensorCount);
     }
-    void clearTrajectory() { trajectory.clear(); }
+    // Releases the storage (required before the trajectory arena is reset)
+    void clearTrajectory() { trajectory = ArenaVector<float>(trajectory.get_allocator()); }
+
+    // Allocate the trajectory from a per-generation arena (nullptr = heap)
+    void setTrajectoryArena(Arena* arena) { trajectory = ArenaVector<float>(ArenaAllocator<float>(arena)); }
 
     // Setters
     void setActive(bool val) { active = val; }
     void setSuccessful(bool val) { successful = val; }
+    void setState(const Vec3& pos, const Vec3& vel) { position = pos; velocity = vel; }  // Batched physics
+
+    // Cast a ray and return distance to wall
+    float castRay(const Vec3& direction, const Environment& env) const;
 
 private:
     Vec3 position;
@@ -54,9 +77,10 @@ private:
     bool active;      // Still trying to find hole
     bool successful;  // Found the hole
 
-    // Store trajectory for learning from successful runs
-    std::vector<std::vector<float>> trajectory;
+    // Control parameters (from SimConfig)
+    float maxSpeed;
+    float controlStrength;
 
-    // Cast a ray and return distance to wall
-    float castRay(const Vec3& direction, const Environment& env) const;
+    // Store trajectory for learning from successful runs
+    ArenaVector<float> trajectory;
 };
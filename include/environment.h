@@ -1,13 +1,15 @@
 #pragma once
 #include "vec3.h"
-#include <random>
+#include "sim_config.h"
+#include <cstdint>
 
 // Represents the wall with a hole
 class Environment {
 public:
-    Environment();
+    Environment(const SimConfig& config = SimConfig());
 
-    // Reset environment with random hole position
+    // Reset environment with random hole position (the n-th reset of a given
+    // master seed always places the hole at the same spot)
     void reset();
 
     // Check if point is inside the hole
@@ -16,6 +18,9 @@ public:
     // Check if point collides with wall (but not in hole)
     bool collidesWithWall(const Vec3& position, float droneRadius) const;
 
+    // Place the hole explicitly (e.g. same task for several populations)
+    void setHoleCenter(const Vec3& center) { holeCenter = Vec3(center.x, center.y, wallZ); }
+
     // Check if drone is out of bounds
     bool isOutOfBounds(const Vec3& position) const;
 
@@ -33,5 +38,6 @@ private:
     Vec3 boundsMin;       // Minimum bounds of the environment
     Vec3 boundsMax;       // Maximum bounds of the environment
 
-    std::mt19937 rng;
+    uint64_t seed;        // Master seed (SimConfig::seed, drawn if unset)
+    uint64_t resets;      // Resets so far (counter of the hole stream)
 };
@@ -0,0 +1,191 @@
+#pragma once
+#include "drone.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// How a drone's step ended
+enum class EpisodeStatus : uint8_t { Flying, Success, Collided, OutOfBounds };
+
+const char* episodeStatusName(EpisodeStatus status);
+
+// One drone in one simulation step
+struct EpisodeRow {
+    int32_t generation;
+    uint32_t step;     // Since the start of the episode
+    uint32_t drone;
+    Vec3 position;     // After the step
+    Vec3 velocity;
+    float control[Drone::controlCount];
+    float reward;      // Fitness gained in the step
+    EpisodeStatus status;
+};
+
+// Where a chunk is and what it holds (also the on-disk index entry)
+struct EpisodeChunkInfo {
+    uint64_t offset;
+    int32_t generation;
+    uint32_t rows;
+    uint32_t firstStep;
+    uint32_t lastStep;
+};
+static_assert(sizeof(EpisodeChunkInfo) == 24, "episode log index layout");
+
+// Rows of one chunk, column by column. A chunk holds rows of a single
+// generation in recording order (step by step, drone by drone). Steps are
+// not stored per row: stepStart[s] is the first row of step firstStep + s,
+// and every step in the chunk has at least one row.
+struct EpisodeColumns {
+    enum Column {
+        StepStart, DroneIndex,
+        PositionX, PositionY, PositionZ,
+        VelocityX, VelocityY, VelocityZ,
+        Control0, Control1, Control2, Control3,
+        Reward, Status,
+        ColumnCount
+    };
+    static const int floatColumns = Status - PositionX;
+
+    int32_t generation = 0;
+    uint32_t firstStep = 0;
+    size_t rows = 0;
+    std::vector<uint32_t> stepStart;
+    std::vector<uint32_t> drone;              // The row columns hold at least `rows`
+    std::vector<float> values[floatColumns];  // PositionX .. Reward
+    std::vector<uint8_t> status;
+
+    size_t size() const { return rows; }
+    uint32_t lastStep() const { return firstStep + static_cast<uint32_t>(stepStart.size()) - 1; }
+    void clear() { rows = 0; stepStart.clear(); }
+    void resize(size_t rows);  // Grows the row columns, never shrinks them
+    uint32_t stepOf(size_t i) const;
+    EpisodeRow row(size_t i) const;
+
+    // Raw bytes of a column, its length in elements and its element size
+    const uint8_t* columnData(int column) const;
+    uint8_t* columnData(int column);
+    size_t columnLength(int column) const { return column == StepStart ? stepStart.size() : rows; }
+    static size_t elementSize(int column);
+};
+
+// Streams every step of every drone to a chunked columnar file. record()
+// only stores into the current chunk's preallocated columns; a full chunk (or the end of
+// a generation) goes to a background thread that compresses (optional:
+// byte shuffle + LZ, see lz_codec.h) and writes it. At most maxQueuedChunks
+// wait for the writer; beyond that record() blocks until one is written, so
+// memory stays bounded and nothing is dropped.
+//
+// File: header, then chunks (chunk header, one column header per column,
+// 8-byte-aligned column payloads), then an index of all chunks and a
+// trailer pointing to it. A file cut short (crash) lacks the index; the
+// reader then scans the complete chunks.
+class EpisodeRecorder {
+public:
+    struct Options {
+        size_t chunkRows = 16384;    // Rows per chunk (about 0.8 MB raw: stays in L2 while filled)
+        size_t maxQueuedChunks = 4;
+        bool compress = false;       // Worth it when the writer has its own core
+    };
+
+    EpisodeRecorder(const std::string& path, const Options& options, uint64_t seed = 0);
+    explicit EpisodeRecorder(const std::string& path) : EpisodeRecorder(path, Options()) {}
+    ~EpisodeRecorder();  // Writes everything recorded, then the index
+
+    EpisodeRecorder(const EpisodeRecorder&) = delete;
+    EpisodeRecorder& operator=(const EpisodeRecorder&) = delete;
+
+    bool isOpen() const { return open; }
+
+    void record(int generation, uint32_t step, uint32_t droneIndex, const Drone& drone, const float* control,
+                float reward, EpisodeStatus status);
+
+    // Hand the current chunk to the writer (also done when the generation changes)
+    void endGeneration();
+
+    // Block until the writer has handled every row recorded before the call
+    void flush();
+
+    // Statistics
+    uint64_t getRowsRecorded() const { return rowsRecorded; }
+    uint64_t getChunksWritten() const;
+    uint64_t getRawBytes() const;       // Column bytes before compression
+    uint64_t getStoredBytes() const;    // Column bytes in the file
+    double getWriterSeconds() const;    // CPU time of the writer thread (compressing, writing)
+    double getStallSeconds() const { return stallSeconds; }  // record() waiting for the writer
+
+private:
+    Options options;
+    bool open;
+    FILE* file;
+    uint64_t rowsRecorded;
+    double stallSeconds;
+
+    std::unique_ptr<EpisodeColumns> current;
+
+    // Writer thread only
+    std::vector<EpisodeChunkInfo> index;
+    uint64_t fileOffset;
+    std::vector<uint8_t> shuffled, packed;
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<std::unique_ptr<EpisodeColumns>> queue;
+    std::vector<std::unique_ptr<EpisodeColumns>> freeChunks;
+    uint64_t chunksSubmitted;
+    uint64_t chunksWritten;
+    uint64_t rawBytes;
+    uint64_t storedBytes;
+    double writerSeconds;
+    bool stopping;
+
+    void submitCurrent();
+    void run();
+    bool writeChunk(const EpisodeColumns& chunk);
+    bool writeBytes(const void* data, size_t size);
+};
+
+// Memory-maps an episode log for random access. Chunks are decoded on
+// demand; queries touch only the chunks of the requested generation (and
+// step range). Not thread-safe.
+class EpisodeReader {
+public:
+    explicit EpisodeReader(const std::string& path);
+    ~EpisodeReader();
+
+    EpisodeReader(const EpisodeReader&) = delete;
+    EpisodeReader& operator=(const EpisodeReader&) = delete;
+
+    bool isOpen() const { return base != nullptr; }
+    bool hasIndex() const { return indexed; }  // false: recovered by scanning a cut-short file
+    uint64_t getSeed() const { return seed; }
+
+    const std::vector<EpisodeChunkInfo>& getChunks() const { return chunks; }
+    std::vector<int32_t> getGenerations() const;  // Ascending, each once
+    uint64_t getRowCount() const;
+    size_t getFileBytes() const { return mappedBytes; }
+
+    // Decode one chunk; false if it is corrupt
+    bool readChunk(size_t chunk, EpisodeColumns& out) const;
+
+    // Rows of a generation, optionally only one drone and/or one step (-1 = all)
+    std::vector<EpisodeRow> query(int32_t generation, int64_t drone = -1, int64_t step = -1) const;
+
+private:
+    const uint8_t* base;
+    size_t mappedBytes;
+    uint64_t seed;
+    bool indexed;
+    std::vector<EpisodeChunkInfo> chunks;
+    mutable std::vector<uint8_t> scratch;
+
+    bool loadIndex();
+    void scanChunks();
+    bool parseChunk(uint64_t offset, EpisodeChunkInfo& info, uint64_t& next) const;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Caches episode results by genome hash so unchanged genomes (the elite kept by
+// RLTrainer::trainStep) are not re-simulated. Evaluation is deterministic for a
+// given environment, so entries stay valid until the evaluation key changes.
+class FitnessCache {
+public:
+    struct Entry {
+        float fitness;
+        std::vector<float> descriptor;  // Behavior descriptor (for novelty search)
+    };
+
+    FitnessCache(size_t capacity = 100000);
+
+    // Key describing the evaluation setup (hole, start, episode length...)
+    // Changing it drops all entries
+    void setEvaluationKey(uint64_t key);
+
+    // Returns nullptr on miss; updates hit/miss counters
+    const Entry* lookup(uint64_t genomeHash);
+
+    void store(uint64_t genomeHash, float fitness, const std::vector<float>& descriptor);
+
+    void clear();
+
+    // Counters
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    size_t size() const { return entries.size(); }
+    float getHitRate() const {
+        size_t total = hits + misses;
+        return total > 0 ? (float)hits / total : 0.0f;
+    }
+
+private:
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t evaluationKey;
+    size_t capacity;
+    size_t hits;
+    size_t misses;
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "software_renderer.h"
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+
+enum class FrameFormat {
+    PPM,  // One binary P6 file per frame
+    PNG,  // One PNG file per frame (uncompressed deflate - no zlib dependency)
+    Raw   // Back-to-back RGB24 frames into one file or pipe ("-" = stdout)
+};
+
+bool parseFrameFormat(const std::string& name, FrameFormat& format);
+
+// Streams rendered frames to disk on a background thread so encoding and file
+// I/O never run on the simulation thread. Frame buffers are recycled; submit()
+// only blocks when `maxQueuedFrames` frames are already waiting.
+class FrameWriter {
+public:
+    // PPM/PNG: `path` is a directory (frame_000000.ppm, ...); Raw: a file, FIFO or "-"
+    FrameWriter(FrameFormat format, const std::string& path, size_t maxQueuedFrames = 8);
+    ~FrameWriter();  // Writes out everything queued
+
+    FrameWriter(const FrameWriter&) = delete;
+    FrameWriter& operator=(const FrameWriter&) = delete;
+
+    bool isOpen() const { return open; }
+
+    // Queue a copy of the frame
+    void submit(const Framebuffer& frame);
+
+    size_t getFramesWritten() const;
+
+private:
+    FrameFormat format;
+    std::string path;
+    size_t maxQueuedFrames;
+    bool open;
+    FILE* rawOut;
+
+    std::thread thread;
+    mutable std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<Framebuffer> queue;
+    std::vector<Framebuffer> freeFrames;
+    size_t framesWritten;
+    bool stopping;
+
+    std::vector<uint8_t> encoded;  // Writer thread scratch
+
+    void run();
+    bool writeFrame(const Framebuffer& frame, size_t index);
+};
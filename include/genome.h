@@ -0,0 +1,99 @@
+#pragma once
+#include "neural_network.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+// Compact genome: a seed for the initial weights plus the chain of seeded
+// mutations applied since. Chains are stored as shared parent links, so a
+// whole population that descends from one elite shares its ancestry and each
+// genome costs one node instead of a full set of weights.
+class Genome {
+public:
+    Genome() = default;
+
+    // Genome whose parameters are NeuralNetwork(layerSizes, initSeed)
+    static Genome root(uint32_t initSeed);
+
+    // Child genome: this one plus NeuralNetwork::mutate(rate, strength, seed)
+    Genome mutated(uint32_t seed, float rate, float strength) const;
+
+    bool isValid() const { return node != nullptr; }
+
+    // Unique key of the whole chain (used by the materializer cache)
+    uint64_t getKey() const { return node ? node->key : 0; }
+
+    // Number of mutations applied since the root
+    uint32_t getDepth() const { return node ? node->depth : 0; }
+
+    // Shared node pointer (identity for deduplication when saving)
+    const void* getNodeId() const { return node.get(); }
+
+    // Genome this one was mutated from (invalid for roots)
+    Genome getParent() const { return node ? Genome(node->parent) : Genome(); }
+
+    // Approximate heap footprint of a single lineage node
+    static size_t getNodeBytes();
+
+private:
+    struct Node {
+        std::shared_ptr<const Node> parent;  // nullptr for roots
+        uint32_t seed;                       // Init seed for roots, mutation seed otherwise
+        float rate;
+        float strength;
+        uint32_t depth;
+        uint64_t key;
+    };
+
+    std::shared_ptr<const Node> node;
+
+    explicit Genome(std::shared_ptr<const Node> node) : node(std::move(node)) {}
+
+    friend class GenomeMaterializer;
+    friend bool saveGenomes(const std::string&, const std::vector<int>&, const std::vector<Genome>&, uint64_t);
+    friend bool loadGenomes(const std::string&, std::vector<int>&, std::vector<Genome>&, uint64_t*);
+};
+
+// Turns genomes back into network parameters.
+// Materializes into a caller-provided network (reused between calls) and keeps
+// an LRU cache of recently materialized parameters, so siblings only replay
+// the last mutation on top of their cached parent.
+class GenomeMaterializer {
+public:
+    GenomeMaterializer(const std::vector<int>& layerSizes, size_t cacheCapacity = 64);
+
+    // Write the genome's parameters into `network` (layer sizes must match)
+    void materialize(const Genome& genome, NeuralNetwork& network);
+
+    // Materialize into an internal reusable buffer (valid until the next call)
+    const NeuralNetwork& materialize(const Genome& genome);
+
+    size_t getCacheHits() const { return hits; }
+    size_t getCacheMisses() const { return misses; }
+
+private:
+    std::vector<int> layerSizes;
+    NeuralNetwork buffer;
+    size_t capacity;
+    size_t hits;
+    size_t misses;
+
+    // LRU: most recent at the front
+    std::list<std::pair<uint64_t, std::vector<float>>> lru;
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, std::vector<float>>>::iterator> index;
+    std::vector<float> scratch;
+
+    const std::vector<float>* findCached(uint64_t key);
+    void storeCached(uint64_t key, const NeuralNetwork& network);
+};
+
+// Compact checkpoint: unique lineage nodes (16 bytes each) + one index per genome.
+// Also records the run's master seed (0 in files written before seeds existed).
+// loadGenomes returns false on a damaged file and then leaves its outputs untouched.
+bool saveGenomes(const std::string& filename, const std::vector<int>& layerSizes,
+                 const std::vector<Genome>& genomes, uint64_t masterSeed = 0);
+bool loadGenomes(const std::string& filename, std::vector<int>& layerSizes,
+                 std::vector<Genome>& genomes, uint64_t* masterSeed = nullptr);
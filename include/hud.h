@@ -0,0 +1,50 @@
+#pragma once
+#include "swarm_snapshot.h"
+#include "metrics.h"
+#include <chrono>
+#include <deque>
+#include <string>
+#include <utility>
+
+// In-window performance overlay (toggled with H in the viewer).
+// Reads the Metrics registry, which is only enabled while the HUD is visible,
+// so hidden HUD = no timing or allocation counting anywhere.
+class Hud {
+public:
+    Hud();
+
+    void setVisible(bool visible);
+    bool isVisible() const { return visible; }
+
+    // Once per rendered frame, before draw()
+    void update(const SwarmSnapshot& snapshot);
+
+    // Draw over the current frame (immediate mode, restores GL state)
+    void draw(int width, int height) const;
+
+private:
+    bool visible;
+
+    // Averaging window: values are refreshed twice a second
+    std::chrono::steady_clock::time_point windowStart;
+    int windowFrames;
+    uint64_t windowTimes[Metrics::zoneCount];
+    uint64_t windowAllocations;
+    long long windowSteps;
+
+    // Displayed values
+    float zoneMs[Metrics::zoneCount];
+    float fps;
+    double stepsPerSecond;
+    double allocationsPerFrame;
+    int activeDrones;
+    int totalDrones;
+    int generation;
+
+    // Best/mean fitness per finished generation
+    std::deque<std::pair<float, float>> history;
+    int historyGeneration;
+
+    void drawText(float x, float y, const std::string& text, float scale) const;
+    void drawChart(float x, float y, float w, float h) const;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "migration_ring.h"
+#include "vec3.h"
+#include "sim_config.h"
+#include <string>
+
+// How genomes move between islands
+enum class MigrationTopology {
+    None,   // Independent islands
+    Ring,   // Island i receives from island i-1
+    Full    // Every island receives from all others
+};
+
+struct IslandConfig {
+    int numIslands = 4;
+    int populationPerIsland = 100;
+    int migrationInterval = 5;      // Generations between migrations
+    int migrantsPerInterval = 2;    // Top-k genomes sent (and at most k accepted)
+    MigrationTopology topology = MigrationTopology::Ring;
+    int maxGenerations = 500;
+    int slotsPerIsland = 32;        // Outbox ring capacity
+    SimConfig sim;                  // Simulation parameters for every island
+};
+
+struct IslandResult {
+    bool solved;
+    int island;        // Island that solved it (-1 for a single population)
+    int generation;    // Generation of the first success
+    float seconds;     // Wall time to solve (or to give up)
+};
+
+// Parse "none" / "ring" / "full"
+bool parseTopology(const std::string& name, MigrationTopology& topology);
+const char* topologyName(MigrationTopology topology);
+
+// Fork one worker process per island, all evolving towards the same hole.
+// Returns as soon as any island solves the task (the others stop at their next step).
+IslandResult runIslands(const IslandConfig& config, const Vec3& holeCenter);
+
+// Worker body: evolve one population, migrating through the shared ring
+void runIsland(int island, const IslandConfig& config, const Vec3& holeCenter, MigrationRing& ring);
+
+// Baseline: one big population in a single process, its drones moved on
+// `threads` threads (Swarm::setNumThreads; same evolution for any count)
+IslandResult runSinglePopulation(int populationSize, int maxGenerations, const Vec3& holeCenter,
+                                 const SimConfig& config = SimConfig(), int threads = 1);
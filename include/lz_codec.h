@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Small LZ77 codec in the LZ4 block format (token with literal/match length
+// nibbles, 16-bit offsets, greedy hash-table matcher): hundreds of MB/s both
+// ways, no dependencies. Meant for the episode log's columns, which are
+// byte-shuffled first so the similar high bytes of floats line up.
+
+// Worst-case compressed size of `size` bytes
+size_t lzCompressBound(size_t size);
+
+// Compress in[0..size) into out (lzCompressBound(size) bytes); returns the
+// compressed size
+size_t lzCompress(const uint8_t* in, size_t size, uint8_t* out);
+
+// Decompress exactly outSize bytes; false on malformed or truncated input
+// (never reads or writes out of bounds)
+bool lzDecompress(const uint8_t* in, size_t size, uint8_t* out, size_t outSize);
+
+// Byte planes of count elements of elementSize bytes: all first bytes, then
+// all second bytes, ... (and back)
+void shuffleBytes(const uint8_t* in, size_t count, size_t elementSize, uint8_t* out);
+void unshuffleBytes(const uint8_t* in, size_t count, size_t elementSize, uint8_t* out);
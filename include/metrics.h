@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Where a frame's time goes, as shown by the viewer HUD
+enum class MetricZone {
+    Sensors,
+    Inference,
+    Physics,
+    Reward,
+    Training,
+    Render,
+    Count
+};
+
+// Process-wide performance counters. While disabled, every instrumentation
+// point costs one relaxed atomic load; nothing is timed or counted.
+class Metrics {
+public:
+    static const int zoneCount = static_cast<int>(MetricZone::Count);
+
+    static void setEnabled(bool enabled) { enabledFlag.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    static void addTime(MetricZone zone, uint64_t nanoseconds) {
+        zoneTimes[static_cast<int>(zone)].fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    // Heap allocations through operator new (counted only while enabled;
+    // the viewer's allocation_counter.cpp calls it, other binaries never do)
+    static void countAllocation() {
+        if (isEnabled()) {
+            allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Totals accumulated since the previous call; counters restart from zero
+    static void collect(uint64_t times[zoneCount], uint64_t& allocationCount);
+
+    static const char* zoneName(MetricZone zone);
+
+private:
+    static std::atomic<bool> enabledFlag;
+    static std::atomic<uint64_t> zoneTimes[zoneCount];
+    static std::atomic<uint64_t> allocations;
+};
+
+// Adds the lifetime of the scope to a zone (if metrics are enabled)
+class ScopedZoneTimer {
+public:
+    explicit ScopedZoneTimer(MetricZone zone) : zone(zone), active(Metrics::isEnabled()) {
+        if (active) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedZoneTimer() {
+        if (active) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            Metrics::addTime(zone, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    ScopedZoneTimer(const ScopedZoneTimer&) = delete;
+    ScopedZoneTimer& operator=(const ScopedZoneTimer&) = delete;
+
+private:
+    MetricZone zone;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Summary of one finished generation. Fixed layout: the binary log is an
+// 8-byte magic, the record size (uint32) and then these records back to back.
+struct GenerationRecord {
+    enum Outcome : int32_t { Timeout, AllInactive, Success };
+
+    int32_t generation;
+    int32_t outcome;
+    int32_t drones;
+    int32_t successes;
+    int32_t collisions;
+    int32_t outOfBounds;
+    int32_t cached;          // Results taken from the fitness cache
+    float episodeSeconds;    // Simulated time
+    float wallSeconds;       // Real time spent on the generation
+    float bestFitness;
+    float meanFitness;
+    float p10Fitness;
+    float medianFitness;
+    float p90Fitness;
+    double stepsPerSecond;   // Drone-steps per wall-clock second
+    uint64_t seed;           // Master seed of the run
+
+    static const char* outcomeName(int32_t outcome);
+};
+static_assert(sizeof(GenerationRecord) == 72, "binary metrics log layout");
+
+enum class MetricsLogFormat {
+    CSV,    // Header row + one row per generation
+    JSONL,  // One JSON object per line
+    Binary  // Raw GenerationRecord structs
+};
+
+// .jsonl / .bin by extension, CSV otherwise
+MetricsLogFormat metricsLogFormatFromPath(const std::string& path);
+
+// Per-generation metrics sink. push() copies the record into a bounded
+// lock-free queue and returns immediately (a full queue drops the record and
+// counts it); a background thread writes the file and calls subscribers, so
+// the simulation thread never does I/O. Any number of threads may push.
+class MetricsLog {
+public:
+    using Subscriber = std::function<void(const GenerationRecord&)>;
+
+    // Empty path = no file, subscribers only
+    explicit MetricsLog(const std::string& path = "", size_t capacity = 1024);
+    ~MetricsLog();  // Handles everything pushed so far
+
+    MetricsLog(const MetricsLog&) = delete;
+    MetricsLog& operator=(const MetricsLog&) = delete;
+
+    bool isOpen() const { return open; }
+
+    // Called on the writer thread for every record
+    void subscribe(Subscriber subscriber);
+
+    bool push(const GenerationRecord& record);
+
+    // Block until every record pushed before the call was handled
+    void flush();
+
+    uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Bounded MPSC queue: each slot's sequence number says whether it is free
+    // for the producer of lap N or holds a record for the consumer (Vyukov)
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        GenerationRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t capacity;
+    alignas(64) std::atomic<uint64_t> enqueuePos;
+    alignas(64) std::atomic<uint64_t> handled;
+    alignas(64) std::atomic<uint64_t> dropped;
+    uint64_t dequeuePos;  // Writer thread only
+
+    MetricsLogFormat format;
+    FILE* file;
+    bool open;
+
+    std::mutex subscribersMutex;
+    std::vector<Subscriber> subscribers;
+
+    std::atomic<bool> stopping;
+    std::thread thread;
+
+    void run();
+    bool pop(GenerationRecord& record);
+    void write(const GenerationRecord& record);
+};
+
+// Console subscriber: at most one line per `intervalSeconds` (successes are
+// always shown), noting how many generations were skipped in between
+MetricsLog::Subscriber makeConsoleReporter(float intervalSeconds = 1.0f);
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Genome exchange between island processes through POSIX shared memory.
+// Every island owns an outbox ring it alone writes to; any island can read any
+// outbox. Slots are guarded by a per-slot sequence number (seqlock), so writers
+// never wait for readers and a slow reader just skips what was overwritten -
+// a straggler island can't block the others.
+class MigrationRing {
+public:
+    struct Migrant {
+        uint32_t sourceIsland;
+        uint32_t generation;
+        float fitness;
+        std::vector<float> params;
+    };
+
+    // Create a new segment (owner unlinks it on destruction)
+    static MigrationRing* create(const std::string& name, int numIslands,
+                                 int slotsPerIsland, int paramCount);
+
+    // Attach to an existing segment
+    static MigrationRing* attach(const std::string& name);
+
+    ~MigrationRing();
+
+    // Write a genome into this island's outbox (never blocks)
+    void publish(int island, uint32_t generation, float fitness, const std::vector<float>& params);
+
+    // Read everything published by `sourceIsland` since `cursor` (advanced in place)
+    size_t collect(int sourceIsland, uint64_t& cursor, std::vector<Migrant>& out) const;
+
+    // First island to solve the task; -1 while unsolved
+    void markSolved(int island, uint32_t generation);
+    int getSolvedIsland() const;
+    uint32_t getSolvedGeneration() const;
+
+    int getNumIslands() const;
+    int getParamCount() const;
+
+private:
+    struct Header;
+    struct Outbox;
+    struct Slot;
+
+    std::string name;
+    void* base;
+    size_t mappedBytes;
+    bool owner;
+    Header* header;
+    size_t slotBytes;
+
+    MigrationRing(const std::string& name, void* base, size_t mappedBytes, bool owner);
+
+    Outbox* outbox(int island) const;
+    Slot* slot(int island, uint64_t position) const;
+
+    static size_t computeSlotBytes(int paramCount);
+    static size_t computeTotalBytes(int numIslands, int slotsPerIsland, int paramCount);
+};
@@ -1,16 +1,30 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <Eigen/Dense>
 
+class Arena;
+
 // Simple feedforward neural network
 class NeuralNetwork {
 public:
     NeuralNetwork(const std::vector<int>& layerSizes);
 
+    // Deterministic construction: same seed -> same initial weights
+    NeuralNetwork(const std::vector<int>& layerSizes, uint32_t seed);
+
+    // Re-initialize weights in place from a seed (reuses existing storage)
+    void randomize(uint32_t seed);
+
     // Forward pass: input -> output
     std::vector<float> forward(const std::vector<float>& input);
 
+    // Same result without heap allocation: input/output hold the first/last
+    // layer's sizes, intermediate activations come from scratch (released
+    // before returning)
+    void forward(const float* input, float* output, Arena& scratch) const;
+
     // Get/Set weights (for RL training)
     std::vector<Eigen::MatrixXf> getWeights() const { return weights; }
     std::vector<Eigen::VectorXf> getBiases() const { return biases; }
@@ -19,6 +33,9 @@ public:
     // Mutate weights slightly (for evolutionary approach)
     void mutate(float mutationRate, float mutationStrength);
 
+    // Deterministic mutation: the same seed always adds the same perturbation
+    void mutate(float mutationRate, float mutationStrength, uint32_t seed);
+
     // Learn from gradient: nudge weights towards better behavior
     // direction: desired direction vector for output adjustment
     void learnFromGradient(const std::vector<float>& lastInput,
@@ -28,13 +45,23 @@ public:
     // Clone network
     NeuralNetwork clone() const;
 
-    // Save/Load weights
+    // Save/Load weights. load() validates the whole file and leaves the
+    // network unchanged (false) if it is missing, truncated or malformed.
     void save(const std::string& filename) const;
-    void load(const std::string& filename);
+    bool load(const std::string& filename);
 
     // Get total number of parameters
     int getParameterCount() const;
 
+    // All parameters as one flat array (per layer: weights column-major, then biases)
+    void getParameters(std::vector<float>& params) const;
+    void setParameters(const std::vector<float>& params);
+
+    const std::vector<int>& getLayerSizes() const { return layerSizes; }
+
+    // Hash of layer sizes and all parameters (for caching evaluations)
+    uint64_t hashParameters() const;
+
 private:
     std::vector<int> layerSizes;
     std::vector<Eigen::MatrixXf> weights;  // Weight matrices for each layer
@@ -0,0 +1,53 @@
+#ifndef NNDRONS_ENV_H
+#define NNDRONS_ENV_H
+
+/* Plain C interface to VecEnv (libnndrons_env), for trainers in C/C++ and
+ * for Python through ctypes. All buffers belong to the caller and are
+ * row-major and contiguous:
+ *   observations  num_envs * nndrons_env_observation_size() floats
+ *   actions       num_envs * nndrons_env_action_size() floats
+ *   rewards       num_envs floats
+ *   dones         num_envs bytes (NNDRONS_DONE_*)
+ * A finished env is reset inside the same step: its done byte is nonzero and
+ * its observation row is the first one of the next episode.
+ * Functions returning int give 0 on success and -1 on error (message on stderr). */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct NndronsEnv NndronsEnv;
+
+enum {
+    NNDRONS_DONE_RUNNING = 0,
+    NNDRONS_DONE_SUCCESS = 1,  /* Passed through the hole */
+    NNDRONS_DONE_CRASHED = 2,  /* Hit the wall or left the bounds */
+    NNDRONS_DONE_TIMEOUT = 3   /* maxEpisodeTime reached */
+};
+
+int nndrons_env_observation_size(void);
+int nndrons_env_action_size(void);
+
+/* settings: "name=value" pairs separated by spaces, as with --set (NULL = defaults);
+ * num_threads 0 = hardware concurrency. Returns NULL on error. */
+NndronsEnv* nndrons_env_create(int num_envs, int num_threads, const char* settings);
+void nndrons_env_destroy(NndronsEnv* env);
+
+int nndrons_env_num_envs(const NndronsEnv* env);
+uint64_t nndrons_env_seed(const NndronsEnv* env);
+int nndrons_env_set_dt(NndronsEnv* env, float dt);
+
+/* seeds: num_envs values or NULL (continue each env's hole sequence);
+ * observations may be NULL */
+int nndrons_env_reset(NndronsEnv* env, const uint64_t* seeds, float* observations);
+
+int nndrons_env_step(NndronsEnv* env, const float* actions, float* observations,
+                     float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
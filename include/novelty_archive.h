@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+// Archive of behavior descriptors for novelty search.
+// Points are indexed by a k-d tree so k-nearest-neighbour queries stay
+// sublinear while the archive grows to 100k+ entries.
+class NoveltyArchive {
+public:
+    NoveltyArchive(int descriptorSize, int k = 15);
+
+    // Add a behavior descriptor to the archive
+    void add(const std::vector<float>& descriptor);
+
+    // Novelty = mean distance to the k nearest archived descriptors
+    // (0 if the archive is empty)
+    float novelty(const std::vector<float>& descriptor) const;
+
+    size_t size() const { return points.size() / dims; }
+    int getDescriptorSize() const { return dims; }
+    void clear();
+
+private:
+    struct Node {
+        int point;   // Index of the stored point
+        int axis;    // Splitting dimension
+        int left;    // Child node indices (-1 = none)
+        int right;
+    };
+
+    int dims;
+    int k;
+    std::vector<float> points;  // Flat storage: size() * dims
+    std::vector<Node> nodes;
+    int root;
+    size_t builtSize;           // Archive size at the last balanced rebuild
+
+    // Rebuild a balanced tree over all points (called when size doubles)
+    void rebuild();
+    int build(std::vector<int>& indices, int begin, int end, int depth);
+
+    // Insert a single point by descending the existing tree
+    void insert(int pointIdx);
+
+    // k-NN search: keeps a bounded max-heap of (squared distance, point)
+    void search(int nodeIdx, const float* query,
+                std::vector<std::pair<float, int>>& heap, int count) const;
+
+    float distanceSquared(const float* a, const float* b) const;
+};
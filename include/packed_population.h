@@ -0,0 +1,68 @@
+#pragma once
+#include "neural_network.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Storage format of population parameters
+enum class ParameterPrecision : uint8_t { Float32, Float16, BFloat16 };
+
+const char* precisionName(ParameterPrecision precision);  // "fp32", "fp16", "bf16"
+bool parsePrecision(const std::string& name, ParameterPrecision& precision);
+
+// IEEE half and bfloat16, round to nearest even (same as F16C's vcvtps2ph)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+uint16_t floatToBFloat16(float value);
+float bfloat16ToFloat(uint16_t value);
+
+// Parameters of a whole population of same-shaped networks in one contiguous
+// buffer, one fixed-stride slot per member, stored as fp32, fp16 or bf16.
+// Slots use NeuralNetwork::getParameters order. Narrow slots are widened to
+// fp32 on the fly, one member at a time into an L1-sized scratch, inside
+// forward() (F16C / AVX-512 when the CPU has them); mutation is applied in
+// fp32 and rounded once when stored back. With Float32 storage, forward and
+// mutate give exactly NeuralNetwork's results.
+class PackedPopulation {
+public:
+    PackedPopulation(const std::vector<int>& layerSizes, int size, ParameterPrecision precision);
+
+    // params: getParameterCount() floats, rounded to the storage precision
+    void setParameters(int member, const float* params);
+    void getParameters(int member, float* params) const;
+    void setNetwork(int member, const NeuralNetwork& network);
+    void getNetwork(int member, NeuralNetwork& network) const;
+
+    // Raw slot copy (elite into a slot: stride bytes, no conversion)
+    void copyMember(int destination, int source);
+
+    // NeuralNetwork::mutate(rate, strength, seed) in fp32 on the member
+    void mutate(int member, float rate, float strength, uint32_t seed);
+
+    // Member i maps column i of observations (input size rows) to column i
+    // of actions (output size rows); members with active[i] == 0 are skipped
+    // (active may be nullptr). Uses internal scratch: one call at a time.
+    void forward(const float* observations, float* actions, const uint8_t* active = nullptr) const;
+
+    int getSize() const { return size; }
+    int getParameterCount() const { return parameterCount; }
+    ParameterPrecision getPrecision() const { return precision; }
+    const std::vector<int>& getLayerSizes() const { return layerSizes; }
+    size_t getMemberBytes() const { return stride; }
+    size_t getStorageBytes() const { return storage.size(); }
+
+private:
+    std::vector<int> layerSizes;
+    int size;
+    int parameterCount;
+    ParameterPrecision precision;
+    size_t stride;                  // Bytes per slot, whole cache lines
+    std::vector<uint8_t> storage;
+
+    mutable std::vector<float> params;      // One member widened to fp32
+    mutable std::vector<float> activations[2];
+
+    uint8_t* slot(int member) { return storage.data() + member * stride; }
+    const uint8_t* slot(int member) const { return storage.data() + member * stride; }
+};
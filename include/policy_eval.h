@@ -0,0 +1,18 @@
+#pragma once
+#include "sim_config.h"
+#include <Eigen/Dense>
+#include <functional>
+
+struct PolicyEvaluation {
+    float successRate = 0.0f;
+    float meanReturn = 0.0f;  // Same as the swarm's fitness for the same flight
+};
+
+// Deterministic policy over a batch: one observation per column
+// (VecEnv::observationSize rows) in, one action per column out
+using BatchPolicy = std::function<void(const Eigen::MatrixXf& observations, Eigen::MatrixXf& actions)>;
+
+// One episode per env on a fixed set of holes: episode i starts from
+// deriveSeed(config.seed, SeedStream::Trial, i), so every policy evaluated
+// with the same config and count flies the same episodes
+PolicyEvaluation evaluatePolicy(const BatchPolicy& policy, const SimConfig& config, int episodes);
@@ -0,0 +1,16 @@
+#pragma once
+#include "neural_network.h"
+#include <string>
+
+struct PolicyExportOptions {
+    std::string nameSpace = "nndrons_policy";
+    std::string source;     // Shown in the header comment
+    bool fastTanh = false;  // Rational tanh (the one Eigen uses) instead of std::tanh
+};
+
+// Write a self-contained C++ header with the network baked in: constexpr
+// aligned weight arrays and an inline policy(in, out) with fixed loop bounds
+// and the same math as NeuralNetwork::forward. The header needs no Eigen, heap or I/O
+// (and not even <cmath> with fastTanh).
+bool exportPolicyHeader(const NeuralNetwork& network, const std::string& filename,
+                        const PolicyExportOptions& options = PolicyExportOptions());
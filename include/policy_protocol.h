@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+// Wire format of the policy inference server (nndrons_serve) over a Unix
+// domain stream socket. All fields are native-endian (the socket is local).
+//
+// Request: PolicyRequestHeader, then count * policyInputSize floats (sensor
+// readings, Drone::getSensorReadings order).
+// Reply: PolicyReplyHeader, then count * policyOutputSize floats (controls,
+// Drone::applyControl order) if status is PolicyStatusOk.
+//
+// A client may pipeline requests; replies come back in request order.
+
+constexpr uint32_t policyRequestMagic = 0x51504E4E;  // "NNPQ"
+constexpr uint32_t policyReplyMagic = 0x52504E4E;    // "NNPR"
+constexpr int policyInputSize = 22;
+constexpr int policyOutputSize = 4;
+constexpr int policyMaxRequestCount = 1024;          // Vectors per request
+
+enum PolicyStatus : uint32_t {
+    PolicyStatusOk = 0,
+    PolicyStatusBadRequest = 1,  // Wrong magic or count; the server closes the connection
+};
+
+struct PolicyRequestHeader {
+    uint32_t magic;
+    uint32_t count;
+};
+
+struct PolicyReplyHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint32_t status;
+    uint32_t modelVersion;  // Increases on every hot reload
+};
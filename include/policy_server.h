@@ -0,0 +1,108 @@
+#pragma once
+#include "policy_protocol.h"
+#include <Eigen/Dense>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct PolicyServerConfig {
+    std::string socketPath = "/tmp/nndrons_policy.sock";
+    std::string modelFile = "best_network.bin";
+    int maxClients = 64;
+    int maxBatch = 4096;        // Vectors per micro-batch
+    int maxDelayMicros = 100;   // Longest a request waits for others to join its batch
+    double reportSeconds = 5.0; // Latency report interval (0 = off)
+};
+
+// Single-threaded inference daemon (Linux: epoll, inotify, eventfd). Serves a
+// network saved by NeuralNetwork::save to local clients over a Unix domain
+// socket (policy_protocol.h). Requests from concurrent clients are coalesced
+// into one batched forward pass, flushed when the batch is full, when every
+// client is waiting, or when the oldest request has waited maxDelayMicros.
+// All buffers are allocated up front: serving a request allocates nothing.
+// The model is reloaded when its file is rewritten or renamed into place.
+class PolicyServer {
+public:
+    explicit PolicyServer(const PolicyServerConfig& config);
+    ~PolicyServer();
+
+    PolicyServer(const PolicyServer&) = delete;
+    PolicyServer& operator=(const PolicyServer&) = delete;
+
+    // Load the model and listen; false (with a message) on failure
+    bool start();
+
+    // Event loop; returns after requestStop()
+    void run();
+
+    // Async-signal-safe
+    void requestStop();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        int fd = -1;
+        bool readable = false;   // Edge-triggered: data may be waiting
+        bool busy = false;       // Request in the batch or reply being sent
+        bool closing = false;    // Bad request: close once the reply is out
+        std::vector<char> in;    // Header + largest request
+        size_t inBytes = 0;
+        std::vector<char> out;   // Header + largest reply
+        size_t outBytes = 0;
+        size_t outSent = 0;
+        uint32_t count = 0;
+        int batchOffset = 0;
+        Clock::time_point received;
+    };
+
+    PolicyServerConfig config;
+    int listenFd, epollFd, inotifyFd, stopFd, timerFd;
+    bool stopping;
+    int watchId;
+    std::string modelName;  // File name inside the watched directory
+
+    // Model: Eigen layout of NeuralNetwork, tanh after every layer
+    std::vector<int> layerSizes;
+    std::vector<Eigen::MatrixXf> weights;
+    std::vector<Eigen::VectorXf> biases;
+    uint32_t modelVersion;
+
+    // Micro-batch: one vector per column
+    Eigen::MatrixXf batchInput;
+    std::vector<Eigen::MatrixXf> layerOutputs;
+    std::vector<Connection*> pending;
+    std::vector<Connection*> flushing;  // Batch whose replies are being written
+    int pendingRows;
+    Clock::time_point oldestPending;
+
+    std::vector<Connection> connections;
+    std::vector<Connection*> freeConnections;
+    int activeConnections;
+    int busyConnections;
+    // Connections whose reply just went out and that may have more requests
+    // waiting; served after the current event (swapped, never reallocated)
+    std::vector<Connection*> resume, resumeScratch;
+
+    // Server-side latency (request read -> reply written), per report window
+    std::vector<uint32_t> latencies;  // Nanoseconds; ring of the latest samples
+    std::vector<uint32_t> sortScratch;
+    uint64_t windowRequests, windowVectors, windowBatches;
+    Clock::time_point windowStart;
+
+    bool loadModel(bool initial);
+    void allocateBatch();
+
+    void acceptClients();
+    void closeConnection(Connection* connection);
+    void readRequests(Connection* connection);
+    void enqueue(Connection* connection);
+    void flush();
+    void serviceClients();
+    void writeReply(Connection* connection);
+    void handleModelChange();
+
+    void recordLatency(Clock::time_point received);
+    void report();
+};
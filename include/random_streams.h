@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <random>
+
+// Reproducible randomness. A run has one master seed; every random decision
+// seeds from deriveSeed(master, stream, counter) instead of sharing a generator,
+// so a result depends only on the master seed and on what is being decided -
+// not on thread count, scheduling or the order work is done in.
+enum class SeedStream : uint64_t {
+    Environment = 1,   // Counter: environment reset number
+    NetworkInit,       // Counter: drone index
+    InitialMutation,   // Counter: drone index
+    Mutation,          // Counter: (trainStep number << 32) | network index
+    Island,            // Counter: island index
+    Repeat,            // Counter: sweep repeat
+    Trial,             // Counter: trial of a comparison or benchmark
+    VecEnv,            // Counter: environment index in a VecEnv
+    Exploration,       // Counter: off-policy collector thread
+    ReplaySample,      // Counter: off-policy learner (sampling and target noise)
+    SweepSample        // Counter: always 0 (random-search configurations)
+};
+
+// splitmix64 finalizer: consecutive inputs give unrelated outputs
+inline uint64_t mixSeed(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t deriveSeed(uint64_t master, SeedStream stream, uint64_t counter) {
+    return mixSeed(mixSeed(master ^ mixSeed(static_cast<uint64_t>(stream))) + counter);
+}
+
+// For the 32-bit seeds of networks and genomes
+inline uint32_t deriveSeed32(uint64_t master, SeedStream stream, uint64_t counter) {
+    return static_cast<uint32_t>(deriveSeed(master, stream, counter) >> 32);
+}
+
+// Master seed for runs started without one (never 0, which means "unset")
+inline uint64_t randomMasterSeed() {
+    std::random_device device;
+    uint64_t seed = (static_cast<uint64_t>(device()) << 32) | device();
+    return seed ? seed : 1;
+}
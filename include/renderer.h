@@ -1,19 +1,30 @@
 #pragma once
-#include "swarm.h"
+#include "swarm_snapshot.h"
+#include "hud.h"
 #include <GLFW/glfw3.h>
 #include <string>
+#include <vector>
 
 // Handles OpenGL rendering
 class Renderer {
 public:
+    // Drone detail levels, nearest first
+    enum DroneLod { LodHigh, LodMedium, LodLow, LodPoint, LodCount };
+
+    // Drone counts of the last rendered frame
+    struct RenderStats {
+        int culled = 0;
+        int drawn[LodCount] = {};
+    };
+
     Renderer(int width, int height);
     ~Renderer();
 
     // Initialize OpenGL context
     bool init();
 
-    // Render the scene
-    void render(const Swarm& swarm);
+    // Render the scene (snapshot published by the simulation thread)
+    void render(const SwarmSnapshot& snapshot);
 
     // Check if window should close
     bool shouldClose() const;
@@ -27,6 +38,11 @@ public:
     // Set window title (for success message)
     void setWindowTitle(const std::string& title);
 
+    // Trail length in samples per drone (T toggles trails)
+    void setTrailLength(int samples);
+
+    const RenderStats& getStats() const { return stats; }
+
 private:
     GLFWwindow* window;
     int width, height;
@@ -36,11 +52,79 @@ private:
     float cameraAngleX;
     float cameraAngleY;
 
+    // Sphere meshes per LOD, built once in init(): unit spheres, position = normal.
+    // All LODs share one vertex/index array; LodPoint is a single vertex.
+    struct SphereMesh {
+        int firstIndex;
+        int indexCount;
+    };
+    std::vector<float> sphereVertices;
+    std::vector<unsigned short> sphereIndices;
+    SphereMesh sphereMeshes[LodCount];
+
+    // View frustum of the current camera (inward normals) for culling,
+    // camera position and projection scale for picking the LOD
+    Vec3 frustumNormals[6];
+    float frustumOffsets[6];
+    Vec3 cameraPos;
+    float pixelsPerUnit;           // Projected size of 1 unit at distance 1
+    std::vector<uint8_t> droneLods;
+    RenderStats stats;
+
+    // Instanced path: mesh + per-frame instance buffer (center, radius, color)
+    bool instancing;
+    GLuint sphereVbo;
+    GLuint sphereIbo;
+    GLuint instanceVbo;
+    GLuint instanceProgram;
+    std::vector<float> instanceData;
+
+    // Fallback for contexts without instancing: meshes compiled into display lists
+    GLuint sphereLists[LodPoint];
+
+    // Trails: persistently mapped ring of 2 * trailLength samples per drone.
+    // Every sample is written twice (slot and slot + trailLength), so the newest
+    // trailLength samples are always contiguous and each drone is one line strip.
+    bool trailsAvailable;
+    bool trailsEnabled;
+    bool trailKeyDown;
+    int trailLength;
+    GLuint trailVbo;
+    GLuint trailProgram;
+    float* trailMapped;          // xyz + sample number per vertex
+    void* trailFence;            // GLsync of the last draw that read the buffer
+    int trailDrones;
+    int trailGeneration;
+    long long trailSteps;        // Snapshot the newest sample came from
+    long long trailSample;       // Samples written since the last reset
+    std::vector<GLint> trailFirsts;
+    std::vector<GLsizei> trailCounts;
+
+    // Performance overlay, toggled with H
+    Hud hud;
+    bool hudKeyDown;
+
+    SphereMesh appendSphereMesh(int slices, int stacks);
+    bool initInstancing();
+    bool initTrails();
+
+    // Trail buffer lifetime and per-frame update (newest sample only)
+    bool allocateTrails(int numDrones);
+    void releaseTrails();
+    void updateTrails(const SwarmSnapshot& snapshot);
+    void drawTrails();
+
+    // Culled (LodCount) or the detail level a drone is drawn with
+    int classifyDrone(const DroneSnapshot& drone) const;
+
     // Draw primitives
-    void drawSphere(const Vec3& position, float radius, float r, float g, float b);
-    void drawWall(const Environment& env);
-    void drawHole(const Environment& env);
-    void drawDrone(const Drone& drone);
+    void drawSphere(const Vec3& position, float radius, float r, float g, float b, int lod);
+    void drawWall(const SwarmSnapshot& snapshot);
+    void drawHole(const SwarmSnapshot& snapshot);
+    void drawDrone(const DroneSnapshot& drone, int lod);
+
+    // All drones: one instanced draw call (or display-list calls as a fallback)
+    void drawDrones(const SwarmSnapshot& snapshot);
 
     // Setup camera
     void setupCamera();
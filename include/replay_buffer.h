@@ -0,0 +1,62 @@
+#pragma once
+#include <Eigen/Dense>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+// Fixed-capacity ring of transitions in structure-of-arrays layout (one
+// contiguous array per field). Any number of simulation threads push at once
+// without locks while a learner samples; when full, the oldest transitions are
+// overwritten.
+//
+// A push claims a slot with one fetch_add and brackets its writes with an odd
+// and then an even version number; a sampler drops slots whose version was
+// odd or changed while it copied (a seqlock per slot). Fields are relaxed
+// atomics, so reading a slot under rewrite is well defined - and still a
+// plain load on x86.
+class ReplayBuffer {
+public:
+    // Sampled transitions, one per column (ready for batched networks)
+    struct Batch {
+        Eigen::MatrixXf observations;      // observationSize x n
+        Eigen::MatrixXf actions;           // actionSize x n
+        Eigen::RowVectorXf rewards;
+        Eigen::MatrixXf nextObservations;  // observationSize x n
+        Eigen::RowVectorXf terminals;      // 1 = episode ended, no bootstrap
+    };
+
+    ReplayBuffer(size_t capacity, int observationSize, int actionSize);
+
+    ReplayBuffer(const ReplayBuffer&) = delete;
+    ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+    void push(const float* observation, const float* action, float reward,
+              const float* nextObservation, bool terminal);
+
+    // Uniform sample with replacement; false while fewer than batchSize
+    // transitions are stored
+    bool sample(int batchSize, std::mt19937& rng, Batch& batch) const;
+
+    size_t size() const;
+    size_t getCapacity() const { return capacity; }
+    int getObservationSize() const { return observationSize; }
+    int getActionSize() const { return actionSize; }
+
+    // Transitions pushed since construction (including overwritten ones)
+    uint64_t getPushed() const { return writePos.load(std::memory_order_relaxed); }
+
+private:
+    size_t capacity;
+    int observationSize;
+    int actionSize;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> versions;  // 0 = never written
+    std::unique_ptr<std::atomic<float>[]> observations;
+    std::unique_ptr<std::atomic<float>[]> actions;
+    std::unique_ptr<std::atomic<float>[]> rewards;
+    std::unique_ptr<std::atomic<float>[]> nextObservations;
+    std::unique_ptr<std::atomic<uint8_t>[]> terminals;
+
+    alignas(64) std::atomic<uint64_t> writePos;
+};
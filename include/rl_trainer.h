@@ -2,20 +2,30 @@
 #include "neural_network.h"
 #include "drone.h"
 #include "environment.h"
+#include "genome.h"
+#include "packed_population.h"
+#include "sim_config.h"
 #include <vector>
 #include <memory>
+#include <cstdint>
 
 // Handles reinforcement learning training
 class RLTrainer {
 public:
-    RLTrainer();
+    RLTrainer(const SimConfig& config = SimConfig());
 
     // Calculate reward for a drone's current state
     float calculateReward(const Drone& drone, const Environment& env, bool reachedGoal, bool collided) const;
 
     // Train using simple evolutionary strategy
+    // If genomes is given, it is kept in sync with the networks (seed-chain lineage)
     void trainStep(std::vector<std::shared_ptr<NeuralNetwork>>& networks,
-                   const std::vector<float>& fitnessScores);
+                   const std::vector<float>& fitnessScores,
+                   std::vector<Genome>* genomes = nullptr);
+
+    // Same step on a packed population: the elite's slot is copied into every
+    // other slot, then mutated in fp32 with the same seeds as above
+    void trainStep(PackedPopulation& population, const std::vector<float>& fitnessScores);
 
     // Get best network index
     int getBestNetworkIndex(const std::vector<float>& fitnessScores) const;
@@ -23,4 +33,17 @@ public:
 private:
     float mutationRate;
     float mutationStrength;
+
+    // Mutation seeds come from the master seed, the trainStep number and the
+    // network index (so every mutation can be replayed from its seed)
+    uint64_t seed;
+    uint64_t trainSteps;
+
+    // Mutation rate/strength multiplier of population slot i
+    static float mutationScale(size_t i, size_t count);
+
+    // Mutate networks[i] and record it in the genome lineage
+    void mutateNetwork(std::vector<std::shared_ptr<NeuralNetwork>>& networks,
+                       std::vector<Genome>* genomes, size_t i, int parentIdx,
+                       float rate, float strength);
 };
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Runtime simulation/training parameters (previously hard-coded literals)
+struct SimConfig {
+    // Evolution (RLTrainer)
+    float mutationRate = 0.05f;
+    float mutationStrength = 0.1f;
+
+    // Network architecture: 22 sensors in, 4 controls out
+    std::vector<int> layerSizes = {22, 24, 16, 4};
+
+    // Episode (Swarm)
+    float maxEpisodeTime = 40.0f;
+
+    // Environment
+    float holeRadius = 0.6f;
+
+    // Drone control (Drone::applyControl)
+    float controlStrength = 1.5f;
+    float maxSpeed = 10.0f;
+
+    // Master seed of all randomness (random_streams.h); 0 = pick one at startup
+    uint64_t seed = 0;
+
+    // Set a parameter by name from text ("mutationRate", "0.1").
+    // layerSizes is written as "22-24-16-4". Returns false on unknown name/bad value.
+    bool set(const std::string& name, const std::string& value);
+
+    // Parameter value as text (empty for unknown names)
+    std::string get(const std::string& name) const;
+
+    // Names accepted by set()/get()
+    static const std::vector<std::string>& parameterNames();
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include "swarm_snapshot.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// 8-bit RGB image, top row first
+struct Framebuffer {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;  // width * height * 3
+};
+
+// CPU rasterizer for machines without a display or GPU. Draws the same scene
+// as Renderer (translucent wall, hole ring, lit drone spheres) from the same
+// camera, so recorded frames match what the viewer shows.
+//
+// The frame is split into tiles; drones are binned by screen bounds and the
+// tiles are shaded in parallel on a persistent worker pool. Spheres are ray-cast
+// per pixel instead of tessellated - exact silhouettes at any distance and
+// no triangle setup for drones that cover a handful of pixels.
+class SoftwareRenderer {
+public:
+    SoftwareRenderer(int width, int height, int numThreads = 0);  // 0 = hardware concurrency
+    ~SoftwareRenderer();
+
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    // Render a frame into the internal framebuffer
+    void render(const SwarmSnapshot& snapshot);
+    const Framebuffer& getFramebuffer() const { return framebuffer; }
+
+    // Same parameters as the viewer's camera controls
+    void setCamera(float distance, float angleX, float angleY);
+
+    int getNumThreads() const { return static_cast<int>(workers.size()) + 1; }
+
+private:
+    static const int tileSize = 32;
+
+    struct ScreenDrone {
+        Vec3 center;
+        float radius;
+        float r, g, b;
+        int x0, y0, x1, y1;  // Conservative pixel bounds (inclusive)
+    };
+
+    struct ScreenPoint {
+        float x, y;     // Pixel coordinates
+        Vec3 world;
+        bool visible;   // In front of the near plane
+    };
+
+    int width, height;
+    Framebuffer framebuffer;
+
+    // Camera
+    float cameraDistance;
+    float cameraAngleX;
+    float cameraAngleY;
+    Vec3 eye, forward, right, up;
+    float tanHalfX, tanHalfY;
+    Vec3 lightPos;  // GL_LIGHT0 is given in eye space; this is its world position
+
+    // Per-frame scene
+    const SwarmSnapshot* scene;
+    std::vector<ScreenDrone> screenDrones;
+    std::vector<ScreenPoint> ring;
+    int tilesX, tilesY;
+    std::vector<std::vector<int>> tileBins;  // Drone indices overlapping each tile
+
+    // Worker pool: the calling thread shades tiles too
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable frameDone;
+    uint64_t frameId;
+    int busyWorkers;
+    bool stopping;
+    std::atomic<int> nextTile;
+
+    void setupCamera();
+    void projectScene(const SwarmSnapshot& snapshot);
+    bool project(const Vec3& p, float& x, float& y, float& depth) const;
+
+    void workerLoop();
+    void shadeTiles();
+    void shadeTile(int tileIdx);
+};
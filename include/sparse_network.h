@@ -0,0 +1,52 @@
+#pragma once
+#include "neural_network.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Magnitude pruning: smallest |weight| that survives when `sparsity` (0..1)
+// of all weights (biases excluded) are to be removed
+float pruningThreshold(const NeuralNetwork& network, float sparsity);
+
+// Zero every weight with |w| < threshold; returns how many weights are zero now
+int pruneWeights(NeuralNetwork& network, float threshold);
+
+// Inference-only copy of a pruned network: every weight matrix in compressed
+// sparse row form, only non-zero weights kept. Each row's entries are padded
+// to a multiple of 4 (zero weight, column 0), so the kernel runs four
+// independent accumulators without a remainder loop. Same math as
+// NeuralNetwork::forward (Eigen's tanh after every layer).
+class SparseNetwork {
+public:
+    SparseNetwork() = default;
+    // Leaves the network empty (no layer sizes) if a layer is wider than 65536
+    explicit SparseNetwork(const NeuralNetwork& network);
+
+    // input: layerSizes.front() floats, output: layerSizes.back() floats.
+    // Uses internal scratch: one call at a time per instance.
+    void forward(const float* input, float* output) const;
+
+    // Dense network with the same weights (pruned ones zero)
+    void copyTo(NeuralNetwork& network) const;
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    const std::vector<int>& getLayerSizes() const { return layerSizes; }
+    int getNonZeroCount() const { return nonZeros; }
+    size_t getStorageBytes() const;  // Values, indices, row starts and biases
+
+private:
+    struct Layer {
+        int rows = 0, cols = 0;
+        std::vector<uint32_t> rowStart;  // rows + 1 entries
+        std::vector<uint16_t> columns;
+        std::vector<float> values;
+        std::vector<float> biases;
+    };
+
+    std::vector<int> layerSizes;
+    std::vector<Layer> layers;
+    int nonZeros = 0;
+    mutable std::vector<float> scratch[2];
+};
@@ -3,13 +3,26 @@
 #include "neural_network.h"
 #include "environment.h"
 #include "rl_trainer.h"
+#include "novelty_archive.h"
+#include "fitness_cache.h"
+#include "sim_config.h"
+#include "metrics_log.h"
+#include "arena.h"
 #include <vector>
 #include <memory>
+#include <functional>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class EpisodeRecorder;
 
 // Manages the swarm of drones
 class Swarm {
 public:
-    Swarm(int numDrones);
+    Swarm(int numDrones, const SimConfig& config = SimConfig());
+    ~Swarm();
 
     // Reset all drones and environment
     void reset();
@@ -31,31 +44,162 @@ public:
 
     // Getters
     const std::vector<std::shared_ptr<Drone>>& getDrones() const { return drones; }
+    const std::vector<std::shared_ptr<NeuralNetwork>>& getNetworks() const { return networks; }
     const Environment& getEnvironment() const { return environment; }
     int getGeneration() const { return generation; }
     float getBestFitness() const { return bestFitness; }
+
+    // Raw fitness of the last finished generation
+    float getLastGenerationBest() const { return lastGenerationBest; }
+    float getLastGenerationMean() const { return lastGenerationMean; }
     float getEpisodeTime() const { return episodeTime; }
     float getMaxEpisodeTime() const { return maxEpisodeTime; }
+    const SimConfig& getConfig() const { return config; }
+
+    // Total drone-steps simulated (throughput counter)
+    long long getSimulatedSteps() const { return simulatedSteps; }
     bool hasAnyDroneSucceeded() const; // Check if any drone found the hole
 
+    // Novelty search: blend behavior novelty into selection (off by default)
+    void enableNoveltySearch(bool enabled, float weight = 0.5f);
+    bool isNoveltySearchEnabled() const { return noveltyEnabled; }
+    size_t getNoveltyArchiveSize() const { return noveltyArchive.size(); }
+
+    // Fitness cache: skip simulating genomes already evaluated in this environment
+    void enableFitnessCache(bool enabled);
+    const FitnessCache& getFitnessCache() const { return fitnessCache; }
+
+    // Called at the end of every failed generation, before selection
+    // (fitness scores are final at that point)
+    void setGenerationCallback(std::function<void(Swarm&)> callback) { generationCallback = callback; }
+    const std::vector<float>& getFitnessScores() const { return fitnessScores; }
+
+    // Replace a network with foreign parameters (island migration)
+    void importGenome(int droneIdx, const std::vector<float>& params, float fitness);
+
+    // Move the hole (keeps the current population)
+    void setHoleCenter(const Vec3& center) { environment.setHoleCenter(center); }
+
+    // Per-generation arena (trajectories, per-step scratch); reset in reset()
+    const Arena& getArena() const { return arena; }
+
+    // Move the drones on this many threads (1, the default: all in the
+    // calling thread). Each thread owns a fixed slice of the drones and its
+    // own arena; wall, bounds and reward checks still run in drone order.
+    // Call before the run: trajectories recorded so far are dropped.
+    void setNumThreads(int threads);
+    int getNumThreads() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Console messages while learning from a success (turn off for headless batch runs)
+    void setVerbose(bool val) { verbose = val; }
+
+    // Per-generation records go here (not owned; nullptr = none). Generation
+    // reports are no longer printed by the swarm: subscribe a console reporter.
+    void setMetricsLog(MetricsLog* log) { metricsLog = log; }
+
+    // Every step of every active drone goes here (not owned; nullptr = none)
+    void setEpisodeRecorder(EpisodeRecorder* recorder) { episodeRecorder = recorder; }
+
     // Save/load best network
     void saveBestNetwork(const std::string& filename);
-    void loadNetwork(const std::string& filename);
+    bool loadNetwork(const std::string& filename);  // false: file missing or invalid, networks unchanged
+
+    // Compact seed-chain genomes of the population (empty once the networks were
+    // changed outside of seeded mutation, e.g. loaded from file)
+    const std::vector<Genome>& getGenomes() const { return genomes; }
+    const std::vector<int>& getLayerSizes() const { return layerSizes; }
+    bool saveGenomeCheckpoint(const std::string& filename) const;
+    bool loadGenomeCheckpoint(const std::string& filename);
 
 private:
+    // Declared first: outlive the drones whose trajectories live in them
+    Arena arena;
+    std::vector<std::unique_ptr<Arena>> workerArenas;  // Slices 1.. (setNumThreads)
+
     std::vector<std::shared_ptr<Drone>> drones;
     std::vector<std::shared_ptr<NeuralNetwork>> networks;
     std::vector<float> fitnessScores;
+    std::vector<Genome> genomes;
+    std::vector<int> layerSizes;
 
+    SimConfig config;
     Environment environment;
     RLTrainer trainer;
 
     int numDrones;
     int generation;
     float bestFitness;
+    float lastGenerationBest;
+    float lastGenerationMean;
     float episodeTime;
     float maxEpisodeTime;
+    long long simulatedSteps;
+    bool verbose;
+
+    // Novelty search state
+    NoveltyArchive noveltyArchive;
+    bool noveltyEnabled;
+    float noveltyWeight;
+
+    // Fitness cache state (per drone: result taken from cache this episode)
+    FitnessCache fitnessCache;
+    bool fitnessCacheEnabled;
+    std::vector<bool> cachedEvaluation;
+    std::vector<std::vector<float>> cachedDescriptors;
+
+    std::function<void(Swarm&)> generationCallback;
+
+    // Current generation's counters for the metrics log
+    MetricsLog* metricsLog;
+    int generationCollisions;
+    int generationOutOfBounds;
+    long long generationStartSteps;
+    std::chrono::steady_clock::time_point generationStart;
+
+    EpisodeRecorder* episodeRecorder;
+    uint32_t episodeSteps;  // Steps of the current episode
+
+    // Worker threads: worker w moves slice w (the calling thread slice 0)
+    std::vector<std::thread> workers;
+    std::mutex workerMutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    uint64_t workerJob;
+    int busyWorkers;
+    bool stoppingWorkers;
+    float workerDt;
+    std::vector<float> controls;  // Per drone, from the move to the settle phase
+
+    // One step of a drone: sensors, network, physics (no shared state but the scratch arena)
+    void moveDrone(size_t i, float dt, float* control, Arena& scratch);
+
+    // Outcome of that step: hole, wall, bounds, reward, episode log. True if
+    // the drone found the hole (the generation is over)
+    bool settleDrone(size_t i, float dt, const float* control);
+
+    size_t sliceBegin(int slice, int threads) const;
+    void moveSlice(int slice, float dt);
+    void workerLoop(int slice);
+    void stopWorkers();
+
+    // Summarize the generation, update lastGeneration* and push it to the log
+    void finishGeneration(GenerationRecord::Outcome outcome);
 
     // Calculate fitness for a drone
     float calculateFitness(int droneIdx);
+
+    // Behavior descriptor: positions sampled along the trajectory + final position
+    std::vector<float> getBehaviorDescriptor(int droneIdx) const;
+
+    // Look up every genome in the fitness cache; hits are marked inactive and skip simulation
+    void applyFitnessCache();
+
+    // Store results of the genomes simulated this episode
+    void storeFitnessCache();
+
+    // Hash of everything that affects an episode's outcome besides the genome
+    uint64_t evaluationKey() const;
+
+    // Fitness blended with novelty (both min-max normalized over the population)
+    std::vector<float> calculateSelectionScores();
 };
@@ -0,0 +1,67 @@
+#pragma once
+#include "vec3.h"
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+class Swarm;
+
+// What the viewer needs to draw one drone
+struct DroneSnapshot {
+    enum Status : uint8_t { Active, Failed, Successful };
+
+    Vec3 position;
+    float radius;
+    Status status;
+};
+
+// Immutable copy of the swarm state for drawing on another thread.
+// Holds no pointers into the Swarm, so the simulation can keep running
+// while a frame is being rendered.
+struct SwarmSnapshot {
+    std::vector<DroneSnapshot> drones;
+
+    Vec3 holeCenter;
+    float holeRadius = 0.0f;
+    float wallZ = 0.0f;
+    Vec3 boundsMin;
+    Vec3 boundsMax;
+
+    int generation = 0;
+    float bestFitness = 0.0f;
+    float lastGenerationBest = 0.0f;
+    float lastGenerationMean = 0.0f;
+    float episodeTime = 0.0f;
+    float maxEpisodeTime = 0.0f;
+    long long simulatedSteps = 0;
+    bool succeeded = false;
+
+    // Copy the current swarm state (reuses the drone array's storage)
+    void capture(const Swarm& swarm);
+};
+
+// Lock-free triple buffer: one producer (simulation) and one consumer (renderer).
+// The producer always has a private back buffer to fill, the consumer a private
+// front buffer to draw from, and the third buffer holds the latest published
+// state. Neither side ever waits; the consumer simply sees the newest snapshot.
+class SnapshotBuffer {
+public:
+    SnapshotBuffer();
+
+    // Producer: fill the returned snapshot, then publish() it
+    SwarmSnapshot& beginWrite() { return buffers[backIdx]; }
+    void publish();
+
+    // Consumer: take the newest published snapshot if there is one.
+    // Returns false when nothing new was published since the last call.
+    bool acquire();
+    const SwarmSnapshot& latest() const { return buffers[frontIdx]; }
+
+private:
+    static const uint8_t freshBit = 4;
+
+    SwarmSnapshot buffers[3];
+    std::atomic<uint8_t> middle;  // Index of the shared buffer | freshBit
+    int backIdx;                  // Owned by the producer
+    int frontIdx;                 // Owned by the consumer
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "sim_config.h"
+#include <vector>
+#include <string>
+#include <utility>
+
+// Hyperparameter sweeps: expand a grid or random search over SimConfig and
+// run headless training jobs on a pool of threads with work stealing.
+
+struct SweepOptions {
+    int numDrones = 100;
+    int maxGenerations = 200;
+    int repeats = 1;        // Independent runs per configuration
+    int threads = 0;        // 0 = hardware concurrency
+    bool progress = true;   // Print a line per finished job
+};
+
+struct SweepResult {
+    int configId;
+    int repeat;
+    SimConfig config;
+    bool solved;
+    int generations;        // Generations to success (or run length if unsolved)
+    float seconds;          // Wall time to success (or to give up)
+    float bestFitness;
+    double stepsPerSecond;  // Simulated drone-steps per second
+};
+
+// Grid: one configuration per combination of values ("name" -> {"v1", "v2"...})
+// Returns false (and leaves configs empty) on an unknown name or bad value
+bool expandGrid(const SimConfig& base,
+                const std::vector<std::pair<std::string, std::vector<std::string>>>& grid,
+                std::vector<SimConfig>& configs);
+
+// Random search: `count` configurations, each named parameter uniform in [lo, hi]
+struct SweepRange {
+    std::string name;
+    float lo;
+    float hi;
+};
+bool sampleRandom(const SimConfig& base, const std::vector<SweepRange>& ranges,
+                  int count, unsigned seed, std::vector<SimConfig>& configs);
+
+// Run every configuration `repeats` times; results are ordered by (configId, repeat)
+std::vector<SweepResult> runSweep(const std::vector<SimConfig>& configs, const SweepOptions& options);
+
+// One row per run: config id, repeat, every SimConfig parameter, then the metrics
+bool writeSweepCsv(const std::string& filename, const std::vector<SweepResult>& results);
@@ -0,0 +1,71 @@
+#pragma once
+#include "batch_mlp.h"
+#include "replay_buffer.h"
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct TD3Config {
+    std::vector<int> criticHidden = {64, 64};
+    int batchSize = 256;
+    float gamma = 0.99f;
+    float tau = 0.005f;              // Target network averaging
+    float actorLearningRate = 3e-4f;
+    float criticLearningRate = 1e-3f;
+    int policyDelay = 2;             // Critic updates per actor update
+    float targetNoise = 0.2f;        // Target policy smoothing
+    float noiseClip = 0.5f;
+    float rewardScale = 0.01f;       // Success is worth 2000, a step ~1
+    int publishInterval = 50;        // Updates between actor snapshots for the collectors
+};
+
+// Off-policy actor-critic learner (TD3: twin critics, delayed actor updates,
+// target policy smoothing) for the continuous 4-value drone control. The
+// actor has the swarm's layer sizes and tanh outputs, so it converts directly
+// to a NeuralNetwork. Collectors write transitions into a ReplayBuffer while
+// the learner samples it, either through trainStep() or on its own thread.
+class TD3Learner {
+public:
+    TD3Learner(const std::vector<int>& actorLayers, const TD3Config& config, uint64_t seed);
+    ~TD3Learner();
+
+    TD3Learner(const TD3Learner&) = delete;
+    TD3Learner& operator=(const TD3Learner&) = delete;
+
+    // One mini-batch update; false if the buffer holds less than a batch
+    bool trainStep(ReplayBuffer& buffer);
+
+    // Learn on a background thread, keeping at most replayRatio sampled
+    // transitions per transition pushed into the buffer
+    void start(ReplayBuffer& buffer, float replayRatio);
+    void stop();
+
+    // Latest published actor (thread-safe); version changes on every publish
+    uint64_t getActorVersion() const { return actorVersion.load(std::memory_order_acquire); }
+    void getActorParameters(std::vector<float>& params) const;
+
+    long long getUpdates() const { return updates.load(std::memory_order_relaxed); }
+    float getCriticLoss() const { return criticLoss.load(std::memory_order_relaxed); }
+
+private:
+    TD3Config config;
+    BatchMlp actor, actorTarget;
+    BatchMlp critic1, critic2, critic1Target, critic2Target;
+    std::mt19937 rng;
+    ReplayBuffer::Batch batch;
+
+    std::atomic<long long> updates;
+    std::atomic<float> criticLoss;
+
+    mutable std::mutex publishMutex;
+    std::vector<float> publishedActor;
+    std::atomic<uint64_t> actorVersion;
+
+    std::thread thread;
+    std::atomic<bool> stopping;
+
+    void publishActor();
+    void run(ReplayBuffer* buffer, float replayRatio);
+};
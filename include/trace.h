@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Hot-path tracing. TRACE_SCOPE("name") records the scope as a complete event
+// into a lock-free ring buffer owned by the calling thread; writeChromeJson()
+// dumps all threads as Chrome/Perfetto trace-event JSON (chrome://tracing,
+// ui.perfetto.dev). The macros compile to nothing unless the build defines
+// NNDRONS_TRACE (cmake -DNNDRONS_TRACE=ON); at runtime recording is off until
+// Trace::setEnabled(true). Names must be string literals.
+class Trace {
+public:
+    // Newest events kept per thread
+    static const uint32_t ringCapacity = 1u << 16;
+
+    static bool compiledIn();
+
+    static void setEnabled(bool enabled) { enabledFlag.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    // Nanoseconds on the steady clock
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    // Label for the calling thread in the trace viewer
+    static void setThreadName(const std::string& name);
+
+    // Snapshot of every thread's ring; safe while other threads keep recording
+    static bool writeChromeJson(const std::string& filename);
+
+private:
+    static std::atomic<bool> enabledFlag;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(Trace::isEnabled() ? name : nullptr), start(0) {
+        if (this->name) {
+            start = Trace::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (name) {
+            Trace::record(name, start, Trace::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#ifdef NNDRONS_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,233 @@
+#pragma once
+#include "vec3.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Lanes of the wide types, one register each: 16 with AVX-512 (zmm), 8 with
+// AVX (ymm), else 4 (xmm; GCC splits wider vectors without AVX into scalar
+// compares). Fixed at compile time, so -march decides.
+#if defined(__AVX512F__)
+constexpr int simdLanes = 16;
+#elif defined(__AVX__)
+constexpr int simdLanes = 8;
+#else
+constexpr int simdLanes = 4;
+#endif
+
+// simdLanes floats / int32 masks in one GCC/Clang vector. + - * / and the
+// comparisons work lane by lane; a comparison gives -1 (true) or 0 per lane.
+// GCC notes that passing them by value differs between -march levels; they
+// never cross a boundary between differently compiled code. That note and
+// GCC 12's false "may be used uninitialized" from the AVX-512 intrinsics are
+// silenced for this header only.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+typedef float FloatN __attribute__((vector_size(simdLanes * sizeof(float))));
+typedef int32_t MaskN __attribute__((vector_size(simdLanes * sizeof(int32_t))));
+
+inline FloatN splat(float value) {
+    FloatN result;
+    for (int i = 0; i < simdLanes; i++) {
+        result[i] = value;
+    }
+    return result;
+}
+
+inline MaskN splatMask(int32_t value) {
+    MaskN result;
+    for (int i = 0; i < simdLanes; i++) {
+        result[i] = value;
+    }
+    return result;
+}
+
+// Lanes [0, count) set: the tail of a batch
+inline MaskN maskFirst(int count) {
+    MaskN result;
+    for (int i = 0; i < simdLanes; i++) {
+        result[i] = i < count ? -1 : 0;
+    }
+    return result;
+}
+
+inline bool anyLane(MaskN mask) {
+    int32_t bits = 0;
+    for (int i = 0; i < simdLanes; i++) {
+        bits |= mask[i];
+    }
+    return bits != 0;
+}
+
+// mask ? a : b per lane, bitwise (no arithmetic on the unselected lane)
+inline FloatN select(MaskN mask, FloatN a, FloatN b) {
+    return (FloatN)(((MaskN)a & mask) | ((MaskN)b & ~mask));
+}
+
+inline FloatN absN(FloatN value) {
+    return (FloatN)((MaskN)value & splatMask(0x7FFFFFFF));
+}
+
+// Same comparisons as std::min / std::max: a on ties (signed zeros) and NaN
+inline FloatN minN(FloatN a, FloatN b) {
+    return select(b < a, b, a);
+}
+
+inline FloatN maxN(FloatN a, FloatN b) {
+    return select(a < b, b, a);
+}
+
+// Correctly rounded, lane i equals std::sqrt(value[i])
+inline FloatN sqrtN(FloatN value) {
+#if defined(__AVX512F__)
+    return (FloatN)_mm512_sqrt_ps((__m512)value);
+#elif defined(__AVX__)
+    return (FloatN)_mm256_sqrt_ps((__m256)value);
+#elif defined(__SSE2__)
+    return (FloatN)_mm_sqrt_ps((__m128)value);
+#else
+    for (int i = 0; i < simdLanes; i++) {
+        value[i] = std::sqrt(value[i]);
+    }
+    return value;
+#endif
+}
+
+// 1 / sqrt(value): the hardware estimate (12 or 14 bits) refined by one
+// Newton step to within a few ulp. No division, no sqrt.
+inline FloatN rsqrtN(FloatN value) {
+#if defined(__AVX512F__)
+    FloatN estimate = (FloatN)_mm512_rsqrt14_ps((__m512)value);
+#elif defined(__AVX__)
+    FloatN estimate = (FloatN)_mm256_rsqrt_ps((__m256)value);
+#elif defined(__SSE2__)
+    FloatN estimate = (FloatN)_mm_rsqrt_ps((__m128)value);
+#else
+    FloatN estimate;
+    for (int i = 0; i < simdLanes; i++) {
+        estimate[i] = 1.0f / std::sqrt(value[i]);
+    }
+#endif
+    return estimate * (splat(1.5f) - splat(0.5f) * value * estimate * estimate);
+}
+
+// simdLanes Vec3s as three registers (SoA). Every operation does per lane
+// the same float operations in the same order as Vec3, so results are
+// bit-identical to the scalar ones; normalizedFast() is the exception.
+struct Vec3xN {
+    FloatN x, y, z;
+
+    Vec3xN() : x(splat(0.0f)), y(splat(0.0f)), z(splat(0.0f)) {}
+    Vec3xN(FloatN x, FloatN y, FloatN z) : x(x), y(y), z(z) {}
+    explicit Vec3xN(const Vec3& v) : x(splat(v.x)), y(splat(v.y)), z(splat(v.z)) {}
+
+    // From / to three float arrays of simdLanes values each
+    static Vec3xN load(const float* xs, const float* ys, const float* zs) {
+        Vec3xN result;
+        std::memcpy(&result.x, xs, sizeof(FloatN));
+        std::memcpy(&result.y, ys, sizeof(FloatN));
+        std::memcpy(&result.z, zs, sizeof(FloatN));
+        return result;
+    }
+
+    void store(float* xs, float* ys, float* zs) const {
+        std::memcpy(xs, &x, sizeof(FloatN));
+        std::memcpy(ys, &y, sizeof(FloatN));
+        std::memcpy(zs, &z, sizeof(FloatN));
+    }
+
+    Vec3 lane(int i) const { return Vec3(x[i], y[i], z[i]); }
+
+    void setLane(int i, const Vec3& v) {
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+
+    Vec3xN operator+(const Vec3xN& other) const {
+        return Vec3xN(x + other.x, y + other.y, z + other.z);
+    }
+
+    Vec3xN operator-(const Vec3xN& other) const {
+        return Vec3xN(x - other.x, y - other.y, z - other.z);
+    }
+
+    Vec3xN operator*(float scalar) const {
+        FloatN s = splat(scalar);
+        return Vec3xN(x * s, y * s, z * s);
+    }
+
+    Vec3xN operator*(FloatN scalar) const {
+        return Vec3xN(x * scalar, y * scalar, z * scalar);
+    }
+
+    Vec3xN& operator+=(const Vec3xN& other) {
+        x += other.x; y += other.y; z += other.z;
+        return *this;
+    }
+
+    FloatN length() const {
+        return sqrtN(lengthSquared());
+    }
+
+    FloatN lengthSquared() const {
+        return x * x + y * y + z * z;
+    }
+
+    FloatN dot(const Vec3xN& other) const {
+        return x * other.x + y * other.y + z * other.z;
+    }
+
+    // Vec3::normalized per lane: divides by the sqrt, zero at length <= 0.0001
+    Vec3xN normalized() const {
+        FloatN len = length();
+        MaskN nonZero = len > splat(0.0001f);
+        return Vec3xN(select(nonZero, x / len, splat(0.0f)),
+                      select(nonZero, y / len, splat(0.0f)),
+                      select(nonZero, z / len, splat(0.0f)));
+    }
+
+    // Same up to a few ulp, via rsqrtN (no sqrt, no division)
+    Vec3xN normalizedFast() const {
+        FloatN lengthSq = lengthSquared();
+        MaskN nonZero = lengthSq > splat(0.0001f * 0.0001f);
+        FloatN inverse = select(nonZero, rsqrtN(lengthSq), splat(0.0f));
+        return *this * inverse;
+    }
+
+    // Drone's speed limit: lanes longer than maxLength become
+    // normalized() * maxLength, the rest stay as they are
+    Vec3xN clampLength(float maxLength) const {
+        MaskN tooLong = lengthSquared() > splat(maxLength * maxLength);
+        if (!anyLane(tooLong)) {
+            return *this;
+        }
+        Vec3xN limited = normalized() * maxLength;
+        return Vec3xN(select(tooLong, limited.x, x), select(tooLong, limited.y, y),
+                      select(tooLong, limited.z, z));
+    }
+
+    // Component-wise into [lo, hi]
+    Vec3xN clamp(const Vec3& lo, const Vec3& hi) const {
+        return Vec3xN(minN(maxN(x, splat(lo.x)), splat(hi.x)),
+                      minN(maxN(y, splat(lo.y)), splat(hi.y)),
+                      minN(maxN(z, splat(lo.z)), splat(hi.z)));
+    }
+};
+
+inline Vec3xN select(MaskN mask, const Vec3xN& a, const Vec3xN& b) {
+    return Vec3xN(select(mask, a.x, b.x), select(mask, a.y, b.y), select(mask, a.z, b.z));
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
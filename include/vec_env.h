@@ -0,0 +1,94 @@
+#pragma once
+#include "drone.h"
+#include "environment.h"
+#include "rl_trainer.h"
+#include "sim_config.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// N independent single-drone environments stepped in lockstep, for external
+// learners (PPO, SAC, ...) that bring their own policy. The caller owns every
+// buffer: observations are numEnvs x observationSize floats, actions
+// numEnvs x actionSize, rewards numEnvs floats, dones numEnvs bytes, all
+// row-major and contiguous. Nothing is copied or allocated per step.
+//
+// Per-step physics, success/collision checks and rewards
+// (RLTrainer::calculateReward) are the same as in Swarm::update. An env that
+// finishes its episode is reset in the same step: its done byte says why and
+// its observation row already belongs to the next episode.
+class VecEnv {
+public:
+    static constexpr int observationSize = Drone::sensorCount;
+    static constexpr int actionSize = Drone::controlCount;
+
+    // Why an episode ended (0 = still running)
+    enum Done : uint8_t { Running = 0, Success = 1, Crashed = 2, Timeout = 3 };
+
+    // Env i is seeded with deriveSeed(config.seed, SeedStream::VecEnv, i);
+    // numThreads 0 = hardware concurrency
+    VecEnv(int numEnvs, const SimConfig& config = SimConfig(), int numThreads = 0);
+    ~VecEnv();
+
+    VecEnv(const VecEnv&) = delete;
+    VecEnv& operator=(const VecEnv&) = delete;
+
+    // Start a new episode in every env. With seeds (numEnvs values) each env
+    // restarts its hole sequence from its seed; without, it continues it.
+    // observations may be nullptr.
+    void reset(const uint64_t* seeds, float* observations);
+
+    void step(const float* actions, float* observations, float* rewards, uint8_t* dones);
+
+    int getNumEnvs() const { return numEnvs; }
+    int getNumThreads() const { return static_cast<int>(workers.size()) + 1; }
+    uint64_t getSeed() const { return config.seed; }
+
+    // Simulated seconds per step (default 1/60, as in the viewer)
+    float getDt() const { return dt; }
+    void setDt(float value) { dt = value; }
+
+private:
+    // Envs handed to a thread at a time: big enough to amortize the atomic,
+    // small enough to balance uneven episode ends
+    static const int chunkSize = 256;
+
+    int numEnvs;
+    SimConfig config;
+    RLTrainer trainer;  // Reward function only
+    float dt;
+    Vec3 startPosition;
+
+    std::vector<Environment> environments;
+    std::vector<Drone> drones;
+    std::vector<float> episodeTimes;
+
+    // Current job, published to the workers by the mutex
+    enum class Job { Reset, Step };
+    Job job;
+    const uint64_t* jobSeeds;
+    const float* jobActions;
+    float* jobObservations;
+    float* jobRewards;
+    uint8_t* jobDones;
+
+    // Worker pool: the calling thread takes chunks too
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    uint64_t jobId;
+    int busyWorkers;
+    bool stopping;
+    std::atomic<int> nextChunk;
+
+    void run(Job job);
+    void workerLoop();
+    void processChunks();
+    void resetRange(int begin, int end);
+    void stepRange(int begin, int end);
+    void resetEnv(int i);
+};
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Compare two nndrons_bench JSON results and flag regressions.
+
+    ./nndrons_bench --out bench_baseline.json        # once, on the reference build
+    ./nndrons_bench --out bench.json                 # after a change
+    python3 scripts/bench_compare.py bench_baseline.json bench.json [--threshold 0.1]
+
+Exit code 1 if any benchmark got slower than the threshold (relative, on the
+median time per item).
+"""
+import argparse
+import json
+import sys
+
+# Reported, but not used to flag regressions (convergence, not speed)
+INFO_METRICS = ["solved", "mean_generations"]
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return {(b["name"], b["batch"]): b for b in data["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression (default 0.10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    print(f"{'benchmark':<32} {'batch':>6} {'baseline':>12} {'current':>12} {'change':>8}")
+    for key in sorted(set(baseline) | set(current)):
+        name, batch = key
+        if key not in baseline or key not in current:
+            print(f"{name:<32} {batch:>6} {'(only in ' + ('current' if key in current else 'baseline') + ')':>34}")
+            continue
+
+        old = baseline[key]["ns_per_item"]
+        new = current[key]["ns_per_item"]
+        change = (new - old) / old if old > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  faster"
+        print(f"{name:<32} {batch:>6} {old:>12.1f} {new:>12.1f} {change:>+7.1%}{flag}")
+
+        for metric in INFO_METRICS:
+            if metric in baseline[key] and metric in current[key]:
+                print(f"{'  ' + metric:<39} {baseline[key][metric]:>12.2f} {current[key][metric]:>12.2f}")
+
+    if regressions:
+        print(f"\n{regressions} regression(s) over {args.threshold:.0%}")
+        return 1
+    print("\nNo regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
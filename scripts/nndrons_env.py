@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""ctypes wrapper of the vectorized environment C API (libnndrons_env).
+
+    env = VecEnv(4096, settings="holeRadius=1.0", library="build/libnndrons_env.so")
+    obs = env.reset(seeds=range(4096))
+    obs, rewards, dones = env.step(actions)      # actions: (4096, 4) float32
+
+The arrays returned by reset()/step() are the buffers the library writes
+into (no copies); they are overwritten by the next call. A nonzero done value
+(DONE_SUCCESS/CRASHED/TIMEOUT) means the episode ended and that env's
+observation row already belongs to the next episode.
+
+Run directly for a random-action smoke test and a throughput figure:
+
+    python3 scripts/nndrons_env.py build/libnndrons_env.so [--envs N] [--steps N]
+"""
+import argparse
+import ctypes
+import time
+
+import numpy as np
+
+DONE_RUNNING, DONE_SUCCESS, DONE_CRASHED, DONE_TIMEOUT = 0, 1, 2, 3
+
+_float_p = ctypes.POINTER(ctypes.c_float)
+_uint8_p = ctypes.POINTER(ctypes.c_uint8)
+_uint64_p = ctypes.POINTER(ctypes.c_uint64)
+
+
+def _load(path):
+    lib = ctypes.CDLL(path)
+    lib.nndrons_env_observation_size.restype = ctypes.c_int
+    lib.nndrons_env_action_size.restype = ctypes.c_int
+    lib.nndrons_env_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_char_p]
+    lib.nndrons_env_create.restype = ctypes.c_void_p
+    lib.nndrons_env_destroy.argtypes = [ctypes.c_void_p]
+    lib.nndrons_env_seed.argtypes = [ctypes.c_void_p]
+    lib.nndrons_env_seed.restype = ctypes.c_uint64
+    lib.nndrons_env_set_dt.argtypes = [ctypes.c_void_p, ctypes.c_float]
+    lib.nndrons_env_reset.argtypes = [ctypes.c_void_p, _uint64_p, _float_p]
+    lib.nndrons_env_step.argtypes = [ctypes.c_void_p, _float_p, _float_p, _float_p, _uint8_p]
+    return lib
+
+
+class VecEnv:
+    def __init__(self, num_envs, threads=0, settings="", library="libnndrons_env.so"):
+        self._lib = _load(library)
+        self._env = self._lib.nndrons_env_create(num_envs, threads, settings.encode())
+        if not self._env:
+            raise RuntimeError("nndrons_env_create failed")
+        self.num_envs = num_envs
+        self.observation_size = self._lib.nndrons_env_observation_size()
+        self.action_size = self._lib.nndrons_env_action_size()
+        self.seed = self._lib.nndrons_env_seed(self._env)
+
+        self.observations = np.zeros((num_envs, self.observation_size), dtype=np.float32)
+        self.rewards = np.zeros(num_envs, dtype=np.float32)
+        self.dones = np.zeros(num_envs, dtype=np.uint8)
+
+    def close(self):
+        if self._env:
+            self._lib.nndrons_env_destroy(self._env)
+            self._env = None
+
+    def __del__(self):
+        self.close()
+
+    def set_dt(self, dt):
+        self._lib.nndrons_env_set_dt(self._env, dt)
+
+    def reset(self, seeds=None):
+        seeds_p = None
+        if seeds is not None:
+            seeds = np.ascontiguousarray(np.fromiter(seeds, dtype=np.uint64, count=self.num_envs))
+            seeds_p = seeds.ctypes.data_as(_uint64_p)
+        self._lib.nndrons_env_reset(self._env, seeds_p, self.observations.ctypes.data_as(_float_p))
+        return self.observations
+
+    def step(self, actions):
+        actions = np.ascontiguousarray(actions, dtype=np.float32)
+        if actions.shape != (self.num_envs, self.action_size):
+            raise ValueError(f"actions must have shape ({self.num_envs}, {self.action_size})")
+        if self._lib.nndrons_env_step(self._env, actions.ctypes.data_as(_float_p),
+                                      self.observations.ctypes.data_as(_float_p),
+                                      self.rewards.ctypes.data_as(_float_p),
+                                      self.dones.ctypes.data_as(_uint8_p)) != 0:
+            raise RuntimeError("nndrons_env_step failed")
+        return self.observations, self.rewards, self.dones
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("library")
+    parser.add_argument("--envs", type=int, default=4096)
+    parser.add_argument("--steps", type=int, default=1000)
+    parser.add_argument("--threads", type=int, default=0)
+    args = parser.parse_args()
+
+    env = VecEnv(args.envs, threads=args.threads, library=args.library)
+    env.reset(seeds=range(1, args.envs + 1))
+    rng = np.random.default_rng(0)
+    actions = rng.uniform(-1.0, 1.0, (args.envs, env.action_size)).astype(np.float32)
+
+    episodes = np.zeros(4, dtype=np.int64)
+    start = time.perf_counter()
+    for _ in range(args.steps):
+        _, _, dones = env.step(actions)
+        episodes += np.bincount(dones, minlength=4)
+    seconds = time.perf_counter() - start
+
+    print(f"{args.envs * args.steps / seconds:.3e} env-steps/s "
+          f"(episodes: {episodes[DONE_SUCCESS]} success, {episodes[DONE_CRASHED]} crashed, "
+          f"{episodes[DONE_TIMEOUT]} timeout)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,23 @@
+#include "metrics.h"
+#include <cstdlib>
+#include <new>
+
+// Global operator new replacement so the HUD can show allocations per frame.
+// (Eigen's own aligned allocations go through malloc and are not counted.)
+// Linked into the viewer only: in nndrons_core it would also interpose the
+// allocator of every tool and of the process that loads libnndrons_env.so.
+void* operator new(std::size_t size) {
+    Metrics::countAllocation();
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
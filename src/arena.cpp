@@ -0,0 +1,71 @@
+#include "arena.h"
+#include <algorithm>
+
+Arena::Arena(size_t blockBytes)
+    : current(0), used(0), blockBytes(std::max<size_t>(blockBytes, 256)), highWater(0),
+      blockAllocations(0), resets(0) {}
+
+Arena::~Arena() = default;
+
+void Arena::addBlock(size_t minBytes) {
+    // Blocks double, so a generation needs O(log size) of them
+    size_t size = std::max(minBytes, blocks.empty() ? blockBytes : blocks.back().size * 2);
+    blocks.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+    blockAllocations++;
+}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        if (current < blocks.size()) {
+            Block& block = blocks[current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            size_t offset = ((base + used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+            if (offset + bytes <= block.size) {
+                used = offset + bytes;
+                highWater = std::max(highWater, getBytesInUse());
+                return block.data.get() + offset;
+            }
+            if (current + 1 < blocks.size()) {
+                current++;  // Kept from an earlier rewind
+                used = 0;
+                continue;
+            }
+        }
+        addBlock(bytes + alignment);
+        current = blocks.size() - 1;
+        used = 0;
+    }
+}
+
+void Arena::rewind(const Mark& mark) {
+    current = mark.block;
+    used = mark.used;
+}
+
+void Arena::reset() {
+    resets++;
+    if (blocks.size() > 1) {
+        // One block big enough for the whole peak next time
+        size_t total = getReservedBytes();
+        blocks.clear();
+        addBlock(total);
+    }
+    current = 0;
+    used = 0;
+}
+
+size_t Arena::getBytesInUse() const {
+    size_t bytes = used;
+    for (size_t b = 0; b < current && b < blocks.size(); b++) {
+        bytes += blocks[b].size;  // Earlier blocks count as full
+    }
+    return bytes;
+}
+
+size_t Arena::getReservedBytes() const {
+    size_t bytes = 0;
+    for (const Block& block : blocks) {
+        bytes += block.size;
+    }
+    return bytes;
+}
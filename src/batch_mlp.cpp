@@ -0,0 +1,125 @@
+#include "batch_mlp.h"
+#include <algorithm>
+#include <cmath>
+
+BatchMlp::BatchMlp(const std::vector<int>& layerSizes, bool linearOutput, uint32_t seed)
+    : layerSizes(layerSizes), linearOutput(linearOutput), adamSteps(0) {
+    // Same initialization as NeuralNetwork
+    NeuralNetwork init(layerSizes, seed);
+    weights = init.getWeights();
+    biases = init.getBiases();
+
+    for (size_t i = 0; i < weights.size(); i++) {
+        weightGrads.push_back(Eigen::MatrixXf::Zero(weights[i].rows(), weights[i].cols()));
+        biasGrads.push_back(Eigen::VectorXf::Zero(biases[i].size()));
+    }
+    weightM = weightV = weightGrads;
+    biasM = biasV = biasGrads;
+}
+
+const Eigen::MatrixXf& BatchMlp::forward(const Eigen::MatrixXf& input) {
+    activations.resize(weights.size() + 1);
+    activations[0] = input;
+    for (size_t i = 0; i < weights.size(); i++) {
+        activations[i + 1].noalias() = weights[i] * activations[i];
+        activations[i + 1].colwise() += biases[i];
+        if (!isLinear(i)) {
+            activations[i + 1] = activations[i + 1].array().tanh();
+        }
+    }
+    return activations.back();
+}
+
+Eigen::MatrixXf BatchMlp::predict(const Eigen::MatrixXf& input) const {
+    Eigen::MatrixXf activation = input;
+    for (size_t i = 0; i < weights.size(); i++) {
+        Eigen::MatrixXf next = weights[i] * activation;
+        next.colwise() += biases[i];
+        activation = isLinear(i) ? next : Eigen::MatrixXf(next.array().tanh());
+    }
+    return activation;
+}
+
+Eigen::MatrixXf BatchMlp::backward(const Eigen::MatrixXf& outputGradient, bool accumulate) {
+    Eigen::MatrixXf delta = outputGradient;
+    for (size_t i = weights.size(); i-- > 0;) {
+        // Through the activation: tanh' = 1 - tanh^2
+        if (!isLinear(i)) {
+            delta = (delta.array() * (1.0f - activations[i + 1].array().square())).matrix();
+        }
+        if (accumulate) {
+            weightGrads[i].noalias() += delta * activations[i].transpose();
+            biasGrads[i] += delta.rowwise().sum();
+        }
+        delta = weights[i].transpose() * delta;
+    }
+    return delta;
+}
+
+void BatchMlp::adamStep(float learningRate) {
+    const float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-8f;
+    adamSteps++;
+    float correction1 = 1.0f - std::pow(beta1, (float)adamSteps);
+    float correction2 = 1.0f - std::pow(beta2, (float)adamSteps);
+    float stepSize = learningRate * std::sqrt(correction2) / correction1;
+
+    for (size_t i = 0; i < weights.size(); i++) {
+        weightM[i] = beta1 * weightM[i] + (1.0f - beta1) * weightGrads[i];
+        weightV[i] = beta2 * weightV[i] + (1.0f - beta2) * weightGrads[i].cwiseAbs2();
+        weights[i].array() -= stepSize * weightM[i].array() / (weightV[i].array().sqrt() + epsilon);
+
+        biasM[i] = beta1 * biasM[i] + (1.0f - beta1) * biasGrads[i];
+        biasV[i] = beta2 * biasV[i] + (1.0f - beta2) * biasGrads[i].cwiseAbs2();
+        biases[i].array() -= stepSize * biasM[i].array() / (biasV[i].array().sqrt() + epsilon);
+    }
+    clearGradients();
+}
+
+void BatchMlp::clearGradients() {
+    for (size_t i = 0; i < weights.size(); i++) {
+        weightGrads[i].setZero();
+        biasGrads[i].setZero();
+    }
+}
+
+void BatchMlp::softUpdate(const BatchMlp& source, float tau) {
+    for (size_t i = 0; i < weights.size(); i++) {
+        weights[i] = tau * source.weights[i] + (1.0f - tau) * weights[i];
+        biases[i] = tau * source.biases[i] + (1.0f - tau) * biases[i];
+    }
+}
+
+void BatchMlp::getParameters(std::vector<float>& params) const {
+    size_t count = 0;
+    for (size_t i = 0; i < weights.size(); i++) {
+        count += weights[i].size() + biases[i].size();
+    }
+    params.resize(count);
+    float* out = params.data();
+    for (size_t i = 0; i < weights.size(); i++) {
+        out = std::copy(weights[i].data(), weights[i].data() + weights[i].size(), out);
+        out = std::copy(biases[i].data(), biases[i].data() + biases[i].size(), out);
+    }
+}
+
+void BatchMlp::setParameters(const std::vector<float>& params) {
+    size_t count = 0;
+    for (size_t i = 0; i < weights.size(); i++) {
+        count += weights[i].size() + biases[i].size();
+    }
+    if (params.size() != count) {
+        return; // Size mismatch
+    }
+
+    const float* in = params.data();
+    for (size_t i = 0; i < weights.size(); i++) {
+        std::copy(in, in + weights[i].size(), weights[i].data());
+        in += weights[i].size();
+        std::copy(in, in + biases[i].size(), biases[i].data());
+        in += biases[i].size();
+    }
+}
+
+void BatchMlp::copyTo(NeuralNetwork& network) const {
+    network.setWeights(weights, biases);
+}
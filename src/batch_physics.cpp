@@ -0,0 +1,47 @@
+#include "batch_physics.h"
+
+void applyControlN(Vec3xN& velocity, const Vec3xN& control, MaskN active, float controlStrength, float maxSpeed) {
+    Vec3xN result = velocity + control * controlStrength;
+    result.z += splat(Drone::forwardBias);
+    velocity = select(active, result.clampLength(maxSpeed), velocity);
+}
+
+void updateN(Vec3xN& position, Vec3xN& velocity, MaskN active, float dt) {
+    position = select(active, position + velocity * dt, position);
+    velocity = select(active, velocity * Drone::damping, velocity);
+}
+
+WallN::WallN()
+    : wallZ(splat(0.0f)), holeX(splat(0.0f)), holeY(splat(0.0f)), holeRadius(splat(0.0f)) {}
+
+void WallN::setLane(int i, const Environment& environment) {
+    Vec3 hole = environment.getHoleCenter();
+    wallZ[i] = environment.getWallZ();
+    holeX[i] = hole.x;
+    holeY[i] = hole.y;
+    holeRadius[i] = environment.getHoleRadius();
+    boundsMin.setLane(i, environment.getBoundsMin());
+    boundsMax.setLane(i, environment.getBoundsMax());
+}
+
+MaskN isInHoleN(const WallN& wall, const Vec3xN& position) {
+    // Written as negations of the scalar early-outs so NaN lanes agree too
+    MaskN nearWall = ~(absN(position.z - wall.wallZ) > splat(0.5f));
+    FloatN dx = position.x - wall.holeX;
+    FloatN dy = position.y - wall.holeY;
+    FloatN distSq = dx * dx + dy * dy;
+    return nearWall & (distSq <= wall.holeRadius * wall.holeRadius);
+}
+
+MaskN collidesWithWallN(const WallN& wall, const Vec3xN& position, FloatN droneRadius) {
+    MaskN notPassed = ~(position.z > wall.wallZ + splat(0.5f));
+    MaskN notFar = ~(position.z < wall.wallZ - splat(1.0f));
+    MaskN touching = absN(position.z - wall.wallZ) < droneRadius;
+    return notPassed & notFar & ~isInHoleN(wall, position) & touching;
+}
+
+MaskN isOutOfBoundsN(const WallN& wall, const Vec3xN& position) {
+    return (position.x < wall.boundsMin.x) | (position.x > wall.boundsMax.x) |
+           (position.y < wall.boundsMin.y) | (position.y > wall.boundsMax.y) |
+           (position.z < wall.boundsMin.z) | (position.z > wall.boundsMax.z);
+}
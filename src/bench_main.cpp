@@ -0,0 +1,1494 @@
+#include "swarm.h"
+#include "neural_network.h"
+#include "drone.h"
+#include "environment.h"
+#include "rl_trainer.h"
+#include "vec_env.h"
+#include "random_streams.h"
+#include "sparse_network.h"
+#include "packed_population.h"
+#include "policy_eval.h"
+#include "batch_physics.h"
+#include "episode_log.h"
+#include "lz_codec.h"
+#include "bench_policy_exact.h"
+#include "bench_policy_fast.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <cmath>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <limits>
+
+// Micro- and macro-benchmarks of the simulation hot paths. Results go out as
+// JSON (stdout or --out); compare two runs with scripts/bench_compare.py.
+// --determinism instead checks that a seeded run is bit-exact reproducible;
+// --export-check that nndrons_export's headers compute what NeuralNetwork does;
+// --precision-check that fp16/bf16 population storage leaves evolution intact;
+// --simd-check that Vec3xN and the batched physics match the scalar code;
+// --episode-check that the episode log stores exactly what was simulated.
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchResult {
+    std::string name;
+    int batch;              // Items processed per timed call
+    double nsPerItem;       // Median over samples
+    double nsPerItemMin;
+    int samples;
+    std::vector<std::pair<std::string, double>> extra;  // Macro-benchmark metrics
+};
+
+struct BenchOptions {
+    std::string filter;
+    double minSampleSeconds = 0.05;
+    int samples = 7;
+    bool micro = true;
+    bool macro = true;
+    int trials = 5;
+    int maxGenerations = 200;
+    uint64_t seed = 1;      // Master seed of the macro-benchmarks
+};
+
+// Keeps results observable so the compiler can't drop the benchmarked work
+static volatile float sink;
+
+// Heap allocations, counted for the generation benchmarks. On glibc the
+// bench's own malloc family wraps the real one; it also sees operator new
+// and Eigen's temporaries. Elsewhere the count stays 0.
+static std::atomic<long long> mallocCalls{0};
+
+#if defined(__GLIBC__)
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) {
+    mallocCalls.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    mallocCalls.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    mallocCalls.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+}
+#endif
+
+static bool selected(const BenchOptions& options, const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+// Time `run` (which processes `batch` items) until each sample takes at least
+// minSampleSeconds; report per-item time
+static BenchResult measure(const BenchOptions& options, const std::string& name, int batch,
+                           const std::function<void()>& run) {
+    // Warm up and find how many calls fill a sample
+    long long calls = 1;
+    while (true) {
+        auto start = Clock::now();
+        for (long long i = 0; i < calls; i++) {
+            run();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= options.minSampleSeconds || calls >= (1LL << 30)) {
+            break;
+        }
+        calls = seconds > 0.0 ? std::max(calls * 2, (long long)(calls * options.minSampleSeconds / seconds * 1.2))
+                              : calls * 10;
+    }
+
+    std::vector<double> perItem;
+    for (int s = 0; s < options.samples; s++) {
+        auto start = Clock::now();
+        for (long long i = 0; i < calls; i++) {
+            run();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        perItem.push_back(seconds * 1e9 / ((double)calls * batch));
+    }
+    std::sort(perItem.begin(), perItem.end());
+
+    BenchResult result;
+    result.name = name;
+    result.batch = batch;
+    result.nsPerItem = perItem[perItem.size() / 2];
+    result.nsPerItemMin = perItem.front();
+    result.samples = options.samples;
+
+    std::cerr << std::left << std::setw(28) << name << " batch " << std::setw(6) << batch
+              << std::right << std::fixed << std::setprecision(1) << std::setw(12) << result.nsPerItem
+              << " нс/эл." << std::endl;
+    return result;
+}
+
+// Drones spread over the space in front of the wall (fixed seed)
+static std::vector<Drone> makeDrones(int count, const SimConfig& config) {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> xy(-12.0f, 12.0f);
+    std::uniform_real_distribution<float> z(-35.0f, -1.0f);
+    std::vector<Drone> drones;
+    drones.reserve(count);
+    for (int i = 0; i < count; i++) {
+        drones.emplace_back(Vec3(xy(rng), xy(rng), z(rng)), config);
+    }
+    return drones;
+}
+
+static void runMicro(const BenchOptions& options, std::vector<BenchResult>& results) {
+    SimConfig config;
+    Environment env(config);
+    env.setHoleCenter(Vec3(2.0f, -1.5f, env.getWallZ()));
+    const int batches[] = {1, 100, 10000};
+
+    if (selected(options, "NeuralNetwork::forward")) {
+        for (int batch : batches) {
+            // One network per item, as in the swarm (cold weights at large batches)
+            int networks = std::min(batch, 1000);
+            std::vector<NeuralNetwork> nets;
+            for (int i = 0; i < networks; i++) {
+                nets.emplace_back(config.layerSizes, 1000 + i);
+            }
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+            std::vector<std::vector<float>> inputs(batch, std::vector<float>(config.layerSizes.front()));
+            for (auto& input : inputs) {
+                for (float& v : input) {
+                    v = value(rng);
+                }
+            }
+            results.push_back(measure(options, "NeuralNetwork::forward", batch, [&] {
+                float sum = 0.0f;
+                for (int i = 0; i < batch; i++) {
+                    sum += nets[i % networks].forward(inputs[i])[0];
+                }
+                sink = sum;
+            }));
+        }
+    }
+
+    if (selected(options, "Drone::getSensorReadings")) {
+        for (int batch : batches) {
+            std::vector<Drone> drones = makeDrones(batch, config);
+            results.push_back(measure(options, "Drone::getSensorReadings", batch, [&] {
+                float sum = 0.0f;
+                for (const Drone& drone : drones) {
+                    sum += drone.getSensorReadings(env)[10];
+                }
+                sink = sum;
+            }));
+        }
+    }
+
+    if (selected(options, "Drone::castRay")) {
+        for (int batch : batches) {
+            std::vector<Drone> drones = makeDrones(batch, config);
+            const Vec3 direction = Vec3(0.3f, -0.2f, 1.0f).normalized();
+            results.push_back(measure(options, "Drone::castRay", batch, [&] {
+                float sum = 0.0f;
+                for (const Drone& drone : drones) {
+                    sum += drone.castRay(direction, env);
+                }
+                sink = sum;
+            }));
+        }
+    }
+
+    if (selected(options, "Environment::collidesWithWall")) {
+        for (int batch : batches) {
+            std::vector<Drone> drones = makeDrones(batch, config);
+            std::vector<Vec3> positions;
+            for (const Drone& drone : drones) {
+                // Pull half of them right up to the wall so both branches run
+                Vec3 p = drone.getPosition();
+                positions.push_back(positions.size() % 2 ? Vec3(p.x, p.y, env.getWallZ() - 0.2f) : p);
+            }
+            results.push_back(measure(options, "Environment::collidesWithWall", batch, [&] {
+                int hits = 0;
+                for (const Vec3& p : positions) {
+                    hits += env.collidesWithWall(p, 0.5f);
+                }
+                sink = (float)hits;
+            }));
+        }
+    }
+
+    if (selected(options, "Vec3")) {
+        const int batch = 10000;
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> value(-15.0f, 15.0f);
+        std::vector<Vec3> vectors(batch);
+        std::vector<float> xs(batch), ys(batch), zs(batch);
+        for (int i = 0; i < batch; i++) {
+            vectors[i] = Vec3(value(rng), value(rng), value(rng));
+            xs[i] = vectors[i].x;
+            ys[i] = vectors[i].y;
+            zs[i] = vectors[i].z;
+        }
+        results.push_back(measure(options, "Vec3::normalized", batch, [&] {
+            float sum = 0.0f;
+            for (const Vec3& v : vectors) {
+                sum += v.normalized().x;
+            }
+            sink = sum;
+        }));
+        for (bool fast : {false, true}) {
+            results.push_back(measure(options, fast ? "Vec3xN::normalizedFast" : "Vec3xN::normalized", batch, [&] {
+                FloatN sum = splat(0.0f);
+                for (int i = 0; i < batch; i += simdLanes) {
+                    Vec3xN v = Vec3xN::load(&xs[i], &ys[i], &zs[i]);
+                    sum += (fast ? v.normalizedFast() : v.normalized()).x;
+                }
+                sink = sum[0];
+            }));
+        }
+    }
+
+    if (selected(options, "Drone physics")) {
+        // applyControl + update + wall and bounds tests, one step of every drone
+        const int batch = 10000;
+        const float dt = 1.0f / 60.0f;
+        std::vector<Drone> drones = makeDrones(batch, config);
+        std::mt19937 rng(19);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        std::vector<float> controls((size_t)batch * Drone::controlCount);
+        for (float& c : controls) {
+            c = value(rng);
+        }
+        results.push_back(measure(options, "Drone physics scalar", batch, [&] {
+            int hits = 0;
+            for (int i = 0; i < batch; i++) {
+                Drone& drone = drones[i];
+                drone.applyControl(&controls[(size_t)i * Drone::controlCount]);
+                drone.update(dt);
+                hits += env.collidesWithWall(drone.getPosition(), drone.getRadius()) +
+                        env.isOutOfBounds(drone.getPosition());
+            }
+            sink = (float)hits;
+        }));
+
+        // Same step on SoA state, simdLanes drones at a time
+        std::vector<float> state[6], control[3];
+        for (auto& column : state) {
+            column.resize(batch);
+        }
+        for (auto& column : control) {
+            column.resize(batch);
+        }
+        std::vector<Drone> fresh = makeDrones(batch, config);
+        for (int i = 0; i < batch; i++) {
+            Vec3 p = fresh[i].getPosition();
+            state[0][i] = p.x;
+            state[1][i] = p.y;
+            state[2][i] = p.z;
+            for (int c = 0; c < 3; c++) {
+                control[c][i] = controls[(size_t)i * Drone::controlCount + c];
+            }
+        }
+        WallN wall;
+        for (int l = 0; l < simdLanes; l++) {
+            wall.setLane(l, env);
+        }
+        const MaskN all = maskFirst(simdLanes);
+        const FloatN radius = splat(fresh[0].getRadius());
+        results.push_back(measure(options, "Drone physics Vec3xN", batch, [&] {
+            MaskN hits = splatMask(0);
+            for (int i = 0; i < batch; i += simdLanes) {
+                Vec3xN position = Vec3xN::load(&state[0][i], &state[1][i], &state[2][i]);
+                Vec3xN velocity = Vec3xN::load(&state[3][i], &state[4][i], &state[5][i]);
+                applyControlN(velocity, Vec3xN::load(&control[0][i], &control[1][i], &control[2][i]), all,
+                              config.controlStrength, config.maxSpeed);
+                updateN(position, velocity, all, dt);
+                hits -= collidesWithWallN(wall, position, radius) | isOutOfBoundsN(wall, position);
+                position.store(&state[0][i], &state[1][i], &state[2][i]);
+                velocity.store(&state[3][i], &state[4][i], &state[5][i]);
+            }
+            sink = (float)hits[0];
+        }));
+    }
+
+    if (selected(options, "RLTrainer::trainStep")) {
+        for (int batch : {10, 100, 1000}) {
+            RLTrainer trainer(config);
+            std::vector<std::shared_ptr<NeuralNetwork>> networks;
+            std::vector<float> fitness(batch);
+            std::mt19937 rng(11);
+            std::uniform_real_distribution<float> score(-20.0f, 200.0f);
+            for (int i = 0; i < batch; i++) {
+                networks.push_back(std::make_shared<NeuralNetwork>(config.layerSizes, 2000 + i));
+                fitness[i] = score(rng);
+            }
+            // One selection + mutation pass over the whole population
+            results.push_back(measure(options, "RLTrainer::trainStep", batch, [&] {
+                trainer.trainStep(networks, fitness);
+            }));
+        }
+    }
+
+    if (selected(options, "PackedPopulation")) {
+        // One member per item; 10000 members' parameters don't fit in cache
+        const int members = 10000;
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        std::vector<float> observations((size_t)members * config.layerSizes.front());
+        std::vector<float> actions((size_t)members * config.layerSizes.back());
+        for (float& v : observations) {
+            v = value(rng);
+        }
+        std::vector<NeuralNetwork> networks;
+        for (int i = 0; i < members; i++) {
+            networks.emplace_back(config.layerSizes, 1000 + i);
+        }
+
+        for (ParameterPrecision precision :
+             {ParameterPrecision::Float32, ParameterPrecision::Float16, ParameterPrecision::BFloat16}) {
+            PackedPopulation population(config.layerSizes, members, precision);
+            for (int i = 0; i < members; i++) {
+                population.setNetwork(i, networks[i]);
+            }
+            std::string suffix = std::string(" ") + precisionName(precision);
+            double bytes = (double)population.getMemberBytes();
+            BenchResult result = measure(options, "PackedPopulation::forward" + suffix, members, [&] {
+                population.forward(observations.data(), actions.data());
+                sink = actions[0];
+            });
+            result.extra = {{"bytes_per_member", bytes}};
+            results.push_back(result);
+
+            // RLTrainer::trainStep's elite copy into every other slot
+            result = measure(options, "PackedPopulation elite copy" + suffix, members - 1, [&] {
+                for (int i = 1; i < members; i++) {
+                    population.copyMember(i, 0);
+                }
+            });
+            result.extra = {{"bytes_per_member", bytes}, {"gb_per_s", bytes / result.nsPerItem}};
+            results.push_back(result);
+        }
+
+        // The same copy between NeuralNetworks, as the swarm does it
+        BenchResult result = measure(options, "NeuralNetwork elite copy", members - 1, [&] {
+            for (int i = 1; i < members; i++) {
+                networks[i] = networks[0].clone();
+            }
+        });
+        double bytes = (double)networks[0].getParameterCount() * sizeof(float);
+        result.extra = {{"bytes_per_member", bytes}, {"gb_per_s", bytes / result.nsPerItem}};
+        results.push_back(result);
+    }
+
+    if (selected(options, "SparseNetwork::forward")) {
+        // Magnitude-pruned copies of one network; per-item time at each sparsity
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+        std::vector<std::vector<float>> inputs(1000, std::vector<float>(config.layerSizes.front()));
+        for (auto& input : inputs) {
+            for (float& v : input) {
+                v = value(rng);
+            }
+        }
+        std::vector<float> output(config.layerSizes.back());
+        for (int percent : {0, 50, 80, 90}) {
+            NeuralNetwork network(config.layerSizes, 1000);
+            pruneWeights(network, pruningThreshold(network, percent / 100.0f));
+            SparseNetwork sparse(network);
+            if (sparse.getLayerSizes().empty()) {
+                break;
+            }
+            std::string name = "SparseNetwork::forward " + std::to_string(percent) + "%";
+            BenchResult result = measure(options, name, (int)inputs.size(), [&] {
+                for (const auto& input : inputs) {
+                    sparse.forward(input.data(), output.data());
+                }
+                sink = output[0];
+            });
+            result.extra = {{"bytes", (double)sparse.getStorageBytes()}};
+            results.push_back(result);
+        }
+    }
+
+    if (selected(options, "VecEnv::step")) {
+        for (int batch : {1000, 100000}) {
+            SimConfig envConfig;
+            envConfig.seed = options.seed;
+            VecEnv vecEnv(batch, envConfig);
+            std::vector<float> observations((size_t)batch * VecEnv::observationSize);
+            std::vector<float> actions((size_t)batch * VecEnv::actionSize);
+            std::vector<float> rewards(batch);
+            std::vector<uint8_t> dones(batch);
+            std::mt19937 rng(13);
+            std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+            for (float& a : actions) {
+                a = value(rng);
+            }
+            vecEnv.reset(nullptr, observations.data());
+            // All threads together: ns per env-step of the whole machine
+            BenchResult result = measure(options, "VecEnv::step", batch, [&] {
+                vecEnv.step(actions.data(), observations.data(), rewards.data(), dones.data());
+            });
+            result.extra = {{"threads", (double)vecEnv.getNumThreads()},
+                            {"env_steps_per_s", result.nsPerItem > 0.0 ? 1e9 / result.nsPerItem : 0.0}};
+            results.push_back(result);
+        }
+    }
+}
+
+// Inputs for the exported policies: mostly sensor-like values, some large
+// enough to saturate tanh
+static std::vector<std::vector<float>> makePolicyInputs(int count) {
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<std::vector<float>> inputs(count, std::vector<float>(bench_policy_exact::inputSize));
+    for (int i = 0; i < count; i++) {
+        float scale = i % 10 == 9 ? 20.0f : 1.0f;
+        for (float& v : inputs[i]) {
+            v = value(rng) * scale;
+        }
+    }
+    return inputs;
+}
+
+// Largest |policy(x) - NeuralNetwork::forward(x)| over the inputs; the
+// headers were exported from NeuralNetwork(layerSizes, BENCH_POLICY_SEED)
+static double policyMaxError(void (*policy)(const float*, float*), const std::vector<std::vector<float>>& inputs) {
+    NeuralNetwork network(SimConfig().layerSizes, BENCH_POLICY_SEED);
+    double maxError = 0.0;
+    float output[bench_policy_exact::outputSize];
+    for (const auto& input : inputs) {
+        std::vector<float> expected = network.forward(input);
+        policy(input.data(), output);
+        for (int o = 0; o < bench_policy_exact::outputSize; o++) {
+            maxError = std::max(maxError, (double)std::fabs(output[o] - expected[o]));
+        }
+    }
+    return maxError;
+}
+
+static void runExportedPolicy(const BenchOptions& options, std::vector<BenchResult>& results) {
+    if (!selected(options, "policy()")) {
+        return;
+    }
+    const int batch = 1000;
+    std::vector<std::vector<float>> inputs = makePolicyInputs(batch);
+    struct Variant {
+        const char* name;
+        void (*policy)(const float*, float*);
+    };
+    const Variant variants[] = {{"policy() exact tanh", bench_policy_exact::policy},
+                                {"policy() fast tanh", bench_policy_fast::policy}};
+    for (const Variant& variant : variants) {
+        float output[bench_policy_exact::outputSize];
+        BenchResult result = measure(options, variant.name, batch, [&] {
+            for (const auto& input : inputs) {
+                variant.policy(input.data(), output);
+            }
+            sink = output[0];
+        });
+        result.extra = {{"max_abs_error", policyMaxError(variant.policy, inputs)}};
+        results.push_back(result);
+    }
+}
+
+// Both exported headers must match NeuralNetwork::forward within 1e-6
+static int runExportCheck() {
+    const double tolerance = 1e-6;
+    std::vector<std::vector<float>> inputs = makePolicyInputs(100000);
+    double exactError = policyMaxError(bench_policy_exact::policy, inputs);
+    double fastError = policyMaxError(bench_policy_fast::policy, inputs);
+    std::cout << "Макс. отклонение от NeuralNetwork::forward: std::tanh " << exactError
+              << ", быстрый tanh " << fastError << std::endl;
+    bool ok = exactError <= tolerance && fastError <= tolerance;
+    std::cout << (ok ? "Экспорт: OK" : "Экспорт: ОШИБКА") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Same bits, or both NaN (the scalar and the packed instructions may pick
+// different NaN payloads)
+static bool sameFloat(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0 || (std::isnan(a) && std::isnan(b));
+}
+
+static bool sameVec3(const Vec3& a, const Vec3& b) {
+    return sameFloat(a.x, b.x) && sameFloat(a.y, b.y) && sameFloat(a.z, b.z);
+}
+
+// Vec3xN, the batched physics and the wall tests against Vec3, Drone and
+// Environment: bit-identical on every triple of edge-case components (zero,
+// signed zero, the 0.0001 normalize cutoff, the speed limit, the wall, hole
+// and bounds boundaries and their float neighbours, inf, NaN) and on random
+// vectors, with random active masks; normalizedFast within its error bound.
+static int runSimdCheck() {
+    SimConfig config;
+    const float dt = 1.0f / 60.0f;
+    const float inf = std::numeric_limits<float>::infinity();
+
+    std::vector<float> edges = {0.0f, -0.0f, 1e-30f, 0.0001f, 0.5f, -0.5f, 0.6f, 1.0f, -1.0f,
+                                config.maxSpeed / std::sqrt(3.0f), config.maxSpeed, 10.0f, -12.0f, 12.0f,
+                                -40.0f, 1e30f, inf, -inf, std::nanf("")};
+    for (size_t i = 0, count = edges.size(); i < count; i++) {
+        if (std::isfinite(edges[i]) && edges[i] != 0.0f) {
+            edges.push_back(std::nextafter(edges[i], inf));
+            edges.push_back(std::nextafter(edges[i], -inf));
+        }
+    }
+    std::vector<Vec3> points;
+    for (float x : edges) {
+        for (float y : edges) {
+            for (float z : edges) {
+                points.emplace_back(x, y, z);
+            }
+        }
+    }
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> uniform(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> exponent(-40.0f, 40.0f);
+    for (int i = 0; i < 8000000; i++) {
+        if (i % 2) {
+            points.emplace_back(uniform(rng), uniform(rng), uniform(rng));
+        } else {
+            auto scaled = [&] { return std::exp2(exponent(rng)) * (rng() % 2 ? -1.0f : 1.0f); };
+            points.emplace_back(scaled(), scaled(), scaled());
+        }
+    }
+    points.resize(points.size() / simdLanes * simdLanes);
+
+    // Holes all over the wall
+    std::vector<Environment> environments;
+    for (int i = 0; i < 97; i++) {
+        SimConfig seeded = config;
+        seeded.seed = i + 1;
+        environments.emplace_back(seeded);
+    }
+
+    const Vec3 lo(-1.0f, -0.5f, 0.0f), hi(1.0f, 0.5f, 12.0f);
+    const size_t n = points.size();
+    long long mismatches = 0;
+    double fastError = 0.0;
+    Drone drone(Vec3(), config);
+    for (size_t base = 0; base < n; base += simdLanes) {
+        Vec3xN a, b, near;
+        WallN wall;
+        MaskN active = splatMask(0);
+        FloatN radius = splat(0.0f);
+        for (int l = 0; l < simdLanes; l++) {
+            size_t i = base + l;
+            const Environment& environment = environments[i % environments.size()];
+            a.setLane(l, points[i]);
+            b.setLane(l, points[(i * 7919 + 13) % n]);
+            // Around this lane's hole, so the edge cases land on its rim
+            Vec3 hole = environment.getHoleCenter();
+            near.setLane(l, Vec3(hole.x + points[i].x, hole.y + points[i].y, points[i].z));
+            wall.setLane(l, environment);
+            active[l] = rng() % 4 ? -1 : 0;
+            radius[l] = i % 3 ? drone.getRadius() : 0.25f;
+        }
+
+        Vec3xN sum = a + b, difference = a - b, scaled = a * 0.37f, multiplied = a * b.x;
+        Vec3xN accumulated = a;
+        accumulated += b;
+        FloatN dot = a.dot(b), lengthSq = a.lengthSquared(), length = a.length();
+        Vec3xN normalized = a.normalized(), fast = a.normalizedFast();
+        Vec3xN limited = a.clampLength(config.maxSpeed), boxed = a.clamp(lo, hi);
+        Vec3xN picked = select(active, a, b);
+
+        Vec3xN position = a, velocity = b;
+        applyControlN(velocity, near, active, config.controlStrength, config.maxSpeed);
+        updateN(position, velocity, active, dt);
+
+        MaskN inHole = isInHoleN(wall, near);
+        MaskN collides = collidesWithWallN(wall, near, radius);
+        MaskN outOfBounds = isOutOfBoundsN(wall, near);
+
+        for (int l = 0; l < simdLanes; l++) {
+            size_t i = base + l;
+            const Environment& environment = environments[i % environments.size()];
+            Vec3 pa = a.lane(l), pb = b.lane(l), pn = near.lane(l);
+            Vec3 pAccumulated = pa;
+            pAccumulated += pb;
+            Vec3 pLimited = pa.lengthSquared() > config.maxSpeed * config.maxSpeed ? pa.normalized() * config.maxSpeed
+                                                                                     : pa;
+            Vec3 pBoxed(std::min(std::max(pa.x, lo.x), hi.x), std::min(std::max(pa.y, lo.y), hi.y),
+                        std::min(std::max(pa.z, lo.z), hi.z));
+            bool ok = sameVec3(sum.lane(l), pa + pb) && sameVec3(difference.lane(l), pa - pb) &&
+                      sameVec3(scaled.lane(l), pa * 0.37f) && sameVec3(multiplied.lane(l), pa * pb.x) &&
+                      sameVec3(accumulated.lane(l), pAccumulated) && sameFloat(dot[l], pa.dot(pb)) &&
+                      sameFloat(lengthSq[l], pa.lengthSquared()) && sameFloat(length[l], pa.length()) &&
+                      sameVec3(normalized.lane(l), pa.normalized()) && sameVec3(limited.lane(l), pLimited) &&
+                      sameVec3(boxed.lane(l), pBoxed) && sameVec3(picked.lane(l), active[l] ? pa : pb);
+
+            // Drone: inactive lanes untouched
+            Vec3 expectedPosition = pa, expectedVelocity = pb;
+            if (active[l]) {
+                const float control[Drone::controlCount] = {pn.x, pn.y, pn.z, 0.0f};
+                drone.setState(pa, pb);
+                drone.applyControl(control);
+                drone.update(dt);
+                expectedPosition = drone.getPosition();
+                expectedVelocity = drone.getVelocity();
+            }
+            ok = ok && sameVec3(position.lane(l), expectedPosition) && sameVec3(velocity.lane(l), expectedVelocity);
+
+            ok = ok && (inHole[l] != 0) == environment.isInHole(pn) &&
+                 (collides[l] != 0) == environment.collidesWithWall(pn, radius[l]) &&
+                 (outOfBounds[l] != 0) == environment.isOutOfBounds(pn);
+
+            if (!ok && mismatches++ < 5) {
+                std::cout << "расхождение: (" << pa.x << ", " << pa.y << ", " << pa.z << "), (" << pb.x << ", "
+                          << pb.y << ", " << pb.z << ")" << std::endl;
+            }
+
+            float lengthSquared = pa.lengthSquared();
+            if (lengthSquared > 1e-30f && lengthSquared < 1e30f) {
+                Vec3 exact = pa.normalized(), approximate = fast.lane(l);
+                fastError = std::max({fastError, (double)std::fabs(approximate.x - exact.x),
+                                      (double)std::fabs(approximate.y - exact.y),
+                                      (double)std::fabs(approximate.z - exact.z)});
+            }
+        }
+    }
+
+    const double fastTolerance = 1e-6;
+    std::cout << "Vec3xN, " << simdLanes << " полос: " << n << " векторов, расхождений со скалярным кодом "
+              << mismatches << "; normalizedFast макс. отклонение " << fastError << std::endl;
+    bool ok = mismatches == 0 && fastError <= fastTolerance;
+    std::cout << (ok ? "SIMD: OK" : "SIMD: ОШИБКА") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Evolution over a packed population on VecEnv: every member flies one
+// episode per generation on that generation's hole, fitness is the return
+struct PackedRun {
+    std::vector<float> bestFitness;  // Per generation
+    PolicyEvaluation elite;          // Final elite on fixed holes
+    double seconds;
+};
+
+static PackedRun runPackedEvolution(ParameterPrecision precision, uint64_t seed, int members, int generations) {
+    SimConfig config;
+    config.seed = seed;
+    PackedPopulation population(config.layerSizes, members, precision);
+    for (int i = 0; i < members; i++) {
+        // Initial population as in Swarm
+        NeuralNetwork network(config.layerSizes, deriveSeed32(seed, SeedStream::NetworkInit, i));
+        if (i > 0) {
+            network.mutate(0.3f, 0.5f, deriveSeed32(seed, SeedStream::InitialMutation, i));
+        }
+        population.setNetwork(i, network);
+    }
+
+    RLTrainer trainer(config);
+    VecEnv env(members, config);
+    std::vector<float> observations((size_t)members * VecEnv::observationSize);
+    std::vector<float> actions((size_t)members * VecEnv::actionSize);
+    std::vector<float> rewards(members), fitness(members);
+    std::vector<uint8_t> dones(members), active(members);
+    std::vector<uint64_t> seeds(members);
+
+    PackedRun run;
+    auto start = Clock::now();
+    for (int generation = 0; generation < generations; generation++) {
+        std::fill(seeds.begin(), seeds.end(), deriveSeed(seed, SeedStream::Environment, generation));
+        env.reset(seeds.data(), observations.data());
+        std::fill(fitness.begin(), fitness.end(), 0.0f);
+        std::fill(active.begin(), active.end(), 1);
+        int remaining = members;
+        while (remaining > 0) {
+            population.forward(observations.data(), actions.data(), active.data());
+            env.step(actions.data(), observations.data(), rewards.data(), dones.data());
+            for (int i = 0; i < members; i++) {
+                if (active[i]) {
+                    fitness[i] += rewards[i];
+                    if (dones[i] != VecEnv::Running) {
+                        active[i] = 0;
+                        remaining--;
+                    }
+                }
+            }
+        }
+        run.bestFitness.push_back(*std::max_element(fitness.begin(), fitness.end()));
+        if (generation + 1 < generations) {
+            trainer.trainStep(population, fitness);
+        }
+    }
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    NeuralNetwork elite(config.layerSizes, 0u);
+    population.getNetwork(trainer.getBestNetworkIndex(fitness), elite);
+    run.elite = evaluatePolicy(
+        [&](const Eigen::MatrixXf& obs, Eigen::MatrixXf& out) {
+            std::vector<float> input(obs.rows());
+            for (int c = 0; c < obs.cols(); c++) {
+                input.assign(obs.col(c).data(), obs.col(c).data() + obs.rows());
+                std::vector<float> output = elite.forward(input);
+                out.col(c) = Eigen::Map<Eigen::VectorXf>(output.data(), output.size());
+            }
+        },
+        config, 200);
+    return run;
+}
+
+// Conversions exact where they must be, fp32 packed storage bit-identical to
+// NeuralNetwork, and evolution with fp16/bf16 storage as good as with fp32
+static int runPrecisionCheck(const BenchOptions& options, int members, int generations, int trials) {
+    bool ok = true;
+    SimConfig config;
+
+    // Every finite half survives fp32 and back; each fp32 rounds to a nearest half
+    int conversionErrors = 0;
+    for (uint32_t h = 0; h < 0x10000; h++) {
+        bool nan = (h & 0x7C00) == 0x7C00 && (h & 0x3FF);
+        conversionErrors += !nan && floatToHalf(halfToFloat((uint16_t)h)) != h;
+        conversionErrors += !nan && floatToBFloat16(bfloat16ToFloat((uint16_t)h)) != h;
+    }
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> exponent(-26.0f, 17.0f);
+    for (int i = 0; i < 1000000; i++) {
+        float x = std::exp2(exponent(rng)) * (i % 2 ? -1.0f : 1.0f);
+        uint16_t h = floatToHalf(x);
+        float rounded = halfToFloat(h);
+        if (!std::isfinite(rounded)) {
+            conversionErrors += std::fabs(x) < 65520.0f;  // Only beyond the largest half
+            continue;
+        }
+        for (int step : {-1, 1}) {
+            float neighbour = halfToFloat((uint16_t)(h + step));
+            conversionErrors += std::isfinite(neighbour) && std::fabs(neighbour - x) < std::fabs(rounded - x);
+        }
+    }
+    std::cout << "Преобразования fp16/bf16: " << (conversionErrors ? "ОШИБКА" : "OK") << std::endl;
+    ok = ok && conversionErrors == 0;
+
+    // fp32 slots: forward, mutation and trainStep exactly as with NeuralNetwork
+    const int small = 50;
+    std::vector<std::shared_ptr<NeuralNetwork>> networks;
+    PackedPopulation packed(config.layerSizes, small, ParameterPrecision::Float32);
+    std::vector<float> fitness(small), observations((size_t)small * VecEnv::observationSize);
+    std::vector<float> actions((size_t)small * VecEnv::actionSize);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (int i = 0; i < small; i++) {
+        networks.push_back(std::make_shared<NeuralNetwork>(config.layerSizes, 3000 + i));
+        packed.setNetwork(i, *networks[i]);
+        fitness[i] = value(rng);
+    }
+    for (float& v : observations) {
+        v = value(rng);
+    }
+    config.seed = options.seed;
+    RLTrainer networkTrainer(config), packedTrainer(config);
+    networkTrainer.trainStep(networks, fitness);
+    packedTrainer.trainStep(packed, fitness);
+    packed.forward(observations.data(), actions.data());
+    int mismatches = 0;
+    std::vector<float> expected, stored(packed.getParameterCount());
+    for (int i = 0; i < small; i++) {
+        networks[i]->getParameters(expected);
+        packed.getParameters(i, stored.data());
+        mismatches += expected != stored;
+        std::vector<float> input(observations.begin() + i * VecEnv::observationSize,
+                                 observations.begin() + (i + 1) * VecEnv::observationSize);
+        std::vector<float> output = networks[i]->forward(input);
+        mismatches += !std::equal(output.begin(), output.end(), actions.begin() + i * VecEnv::actionSize);
+    }
+    std::cout << "fp32 PackedPopulation = NeuralNetwork: " << (mismatches ? "ОШИБКА" : "OK") << std::endl;
+    ok = ok && mismatches == 0;
+
+    // Evolution: same seeds with each storage. Rounding makes each run take
+    // its own path, so narrow formats are compared with fp32 over the trials:
+    // worse only if the paired mean difference of the best fitness is below
+    // two standard errors
+    const ParameterPrecision precisions[] = {ParameterPrecision::Float32, ParameterPrecision::Float16,
+                                             ParameterPrecision::BFloat16};
+    std::vector<double> best[3];
+    double meanReturn[3] = {}, meanSuccess[3] = {}, seconds[3] = {};
+    for (int trial = 0; trial < trials; trial++) {
+        uint64_t seed = deriveSeed(options.seed, SeedStream::Trial, trial);
+        for (int p = 0; p < 3; p++) {
+            PackedRun run = runPackedEvolution(precisions[p], seed, members, generations);
+            double mean = 0.0;
+            for (float f : run.bestFitness) {
+                mean += f / run.bestFitness.size();
+            }
+            best[p].push_back(mean);
+            meanReturn[p] += run.elite.meanReturn / trials;
+            meanSuccess[p] += run.elite.successRate / trials;
+            seconds[p] += run.seconds;
+            std::cout << "запуск " << trial << " " << precisionName(precisions[p]) << ": лучший fitness (среднее по "
+                      << generations << " поколениям) " << std::fixed << std::setprecision(1) << mean
+                      << ", элита на 200 эпизодах: успех " << run.elite.successRate * 100.0f << "%, награда "
+                      << run.elite.meanReturn << std::endl;
+        }
+    }
+
+    std::cout << "Байт на особь: NeuralNetwork " << packed.getParameterCount() * sizeof(float);
+    for (int p = 0; p < 3; p++) {
+        PackedPopulation sized(config.layerSizes, 1, precisions[p]);
+        std::cout << ", " << precisionName(precisions[p]) << " " << sized.getMemberBytes();
+    }
+    std::cout << std::endl;
+
+    for (int p = 1; p < 3; p++) {
+        double mean = 0.0, variance = 0.0;
+        for (int t = 0; t < trials; t++) {
+            mean += (best[p][t] - best[0][t]) / trials;
+        }
+        for (int t = 0; t < trials; t++) {
+            double d = best[p][t] - best[0][t] - mean;
+            variance += d * d / std::max(1, trials - 1);
+        }
+        double standardError = std::sqrt(variance / trials);
+        bool worse = trials >= 2 && mean < -2.0 * standardError;
+        std::cout << precisionName(precisions[p]) << " - fp32: лучший fitness " << std::showpos << mean
+                  << std::noshowpos << " +- " << standardError << ", успех элиты " << meanSuccess[p] * 100.0
+                  << "% / " << meanSuccess[0] * 100.0 << "%, награда " << meanReturn[p] << " / " << meanReturn[0]
+                  << ", время " << seconds[p] << " / " << seconds[0] << " с" << (worse ? " - ХУЖЕ" : "") << std::endl;
+        ok = ok && !worse;
+    }
+
+    std::cout << (ok ? "Точность: OK" : "Точность: ОШИБКА") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// Wall time of whole generations (no success possible: zero-size hole)
+static void runGenerations(const BenchOptions& options, std::vector<BenchResult>& results) {
+    for (int drones : {100, 1000, 10000}) {
+        std::string name = "generation";
+        if (!selected(options, name)) {
+            continue;
+        }
+
+        SimConfig config;
+        config.holeRadius = 0.0f;
+        config.seed = options.seed;
+        Swarm swarm(drones, config);
+        swarm.setVerbose(false);
+
+        const int generations = drones >= 10000 ? 1 : 3;
+        const float dt = 1.0f / 60.0f;
+        auto start = Clock::now();
+        long long steps = swarm.getSimulatedSteps();
+        long long mallocs = mallocCalls.load();
+        while (swarm.getGeneration() < generations) {
+            swarm.update(dt);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        steps = swarm.getSimulatedSteps() - steps;
+        mallocs = mallocCalls.load() - mallocs;
+
+        BenchResult result;
+        result.name = name;
+        result.batch = drones;
+        result.nsPerItem = steps > 0 ? seconds * 1e9 / steps : 0.0;  // Per drone-step
+        result.nsPerItemMin = result.nsPerItem;
+        result.samples = generations;
+        result.extra = {{"ms_per_generation", seconds * 1000.0 / generations},
+                        {"drone_steps_per_s", steps / seconds},
+                        {"mallocs_per_generation", (double)mallocs / generations},
+                        {"arena_high_water_bytes", (double)swarm.getArena().getHighWaterMark()}};
+        results.push_back(result);
+
+        std::cerr << std::left << std::setw(28) << name << " drones " << std::setw(5) << drones
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(11)
+                  << seconds * 1000.0 / generations << " мс/поколение, " << std::setprecision(0)
+                  << (double)mallocs / generations << " malloc" << std::endl;
+    }
+}
+
+// Generations with the episode log on (raw and byte-shuffled LZ) against the
+// same seeded run without it. Rounds interleave the variants, each round
+// starting with the next one; each keeps its fastest round. writer_pct is
+// the writer thread's CPU time: on a single core it is part of the
+// overhead, with a spare core only the rest stays in the simulation loop.
+// The file goes to the temp directory.
+static void runEpisodeLog(const BenchOptions& options, std::vector<BenchResult>& results) {
+    const std::string name = "episode_log";
+    if (!selected(options, name)) {
+        return;
+    }
+
+    const int drones = 1000;
+    const int generations = 3;
+    const int rounds = 5;
+    const float dt = 1.0f / 60.0f;
+    const std::string path = (std::filesystem::temp_directory_path() / "nndrons_bench_episodes.bin").string();
+
+    struct Variant {
+        const char* name;
+        bool log;
+        bool compress;
+        double seconds;
+        double stallSeconds;
+        double writerSeconds;
+        uint64_t rows;
+        uint64_t rawBytes;
+        uint64_t fileBytes;
+    };
+    Variant variants[] = {{"none", false, false, 0.0, 0.0, 0.0, 0, 0, 0},
+                          {"raw", true, false, 0.0, 0.0, 0.0, 0, 0, 0},
+                          {"lz", true, true, 0.0, 0.0, 0.0, 0, 0, 0}};
+    const int variantCount = sizeof(variants) / sizeof(variants[0]);
+
+    for (int round = 0; round < rounds; round++) {
+        for (int v = 0; v < variantCount; v++) {
+            Variant& variant = variants[(v + round) % variantCount];
+            SimConfig config;
+            config.holeRadius = 0.0f;
+            config.seed = options.seed;
+            Swarm swarm(drones, config);
+            swarm.setVerbose(false);
+
+            EpisodeRecorder::Options recorderOptions;
+            recorderOptions.compress = variant.compress;
+            std::unique_ptr<EpisodeRecorder> recorder;
+            if (variant.log) {
+                recorder.reset(new EpisodeRecorder(path, recorderOptions, options.seed));
+                if (!recorder->isOpen()) {
+                    return;
+                }
+                swarm.setEpisodeRecorder(recorder.get());
+            }
+
+            // Until the index is written: the log's cost includes draining it
+            auto start = Clock::now();
+            while (swarm.getGeneration() < generations) {
+                swarm.update(dt);
+            }
+            swarm.setEpisodeRecorder(nullptr);
+            double stall = recorder ? recorder->getStallSeconds() : 0.0;
+            uint64_t rows = recorder ? recorder->getRowsRecorded() : 0;
+            if (recorder) {
+                recorder->flush();
+            }
+            double writer = recorder ? recorder->getWriterSeconds() : 0.0;
+            recorder.reset();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (round == 0 || seconds < variant.seconds) {
+                variant.seconds = seconds;
+                variant.stallSeconds = stall;
+                variant.writerSeconds = writer;
+            }
+            if (variant.log) {
+                EpisodeReader reader(path);
+                variant.rows = rows;
+                variant.fileBytes = reader.getFileBytes();
+                variant.rawBytes = 0;
+                for (const EpisodeChunkInfo& chunk : reader.getChunks()) {
+                    for (int c = 0; c < EpisodeColumns::ColumnCount; c++) {
+                        uint64_t length = c == EpisodeColumns::StepStart ? chunk.lastStep - chunk.firstStep + 1
+                                                                         : chunk.rows;
+                        variant.rawBytes += length * EpisodeColumns::elementSize(c);
+                    }
+                }
+            }
+        }
+    }
+    std::remove(path.c_str());
+
+    const double baseSeconds = variants[0].seconds;
+    for (const Variant& variant : variants) {
+        if (!variant.log) {
+            continue;
+        }
+        double overhead = (variant.seconds / baseSeconds - 1.0) * 100.0;
+        double writer = variant.writerSeconds / baseSeconds * 100.0;
+        double ratio = variant.fileBytes > 0 ? (double)variant.rawBytes / variant.fileBytes : 0.0;
+
+        BenchResult result;
+        result.name = name + " " + variant.name;
+        result.batch = drones;
+        result.nsPerItem = variant.rows > 0 ? (variant.seconds - baseSeconds) * 1e9 / variant.rows : 0.0;  // Per row
+        result.nsPerItemMin = result.nsPerItem;
+        result.samples = rounds;
+        result.extra = {{"overhead_pct", overhead},
+                        {"writer_pct", writer},
+                        {"rows", (double)variant.rows},
+                        {"file_bytes", (double)variant.fileBytes},
+                        {"compression_ratio", ratio},
+                        {"stall_seconds", variant.stallSeconds}};
+        results.push_back(result);
+
+        std::cerr << std::left << std::setw(28) << result.name << " drones " << std::setw(5) << drones
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(11) << overhead
+                  << " % к поколению (запись в фоне " << writer << " %), " << result.nsPerItem << " нс/строка, "
+                  << std::setprecision(2) << variant.fileBytes / 1e6 << " МБ, сжатие " << ratio << "x" << std::endl;
+    }
+}
+
+// Generations and seconds until the first drone finds the hole
+static void runTimeToSuccess(const BenchOptions& options, std::vector<BenchResult>& results) {
+    if (!selected(options, "time_to_success")) {
+        return;
+    }
+
+    const float dt = 1.0f / 60.0f;
+    int solved = 0;
+    double totalGenerations = 0.0;
+    double totalSeconds = 0.0;
+    long long totalSteps = 0;
+
+    for (int trial = 0; trial < options.trials; trial++) {
+        SimConfig config;
+        config.seed = deriveSeed(options.seed, SeedStream::Trial, trial);
+        Swarm swarm(100, config);
+        swarm.setVerbose(false);
+        auto start = Clock::now();
+        while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < options.maxGenerations) {
+            swarm.update(dt);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (swarm.hasAnyDroneSucceeded()) {
+            solved++;
+            totalGenerations += swarm.getGeneration();
+            totalSeconds += seconds;
+        }
+        totalSteps += swarm.getSimulatedSteps();
+        std::cerr << "time_to_success запуск " << trial << ": "
+                  << (swarm.hasAnyDroneSucceeded() ? std::to_string(swarm.getGeneration()) : "-")
+                  << " поколений, " << std::fixed << std::setprecision(2) << seconds << " с" << std::endl;
+    }
+
+    BenchResult result;
+    result.name = "time_to_success";
+    result.batch = 100;
+    result.nsPerItem = solved ? totalSeconds * 1e9 / solved : 0.0;
+    result.nsPerItemMin = result.nsPerItem;
+    result.samples = options.trials;
+    result.extra = {{"solved", (double)solved},
+                    {"mean_generations", solved ? totalGenerations / solved : 0.0},
+                    {"mean_seconds", solved ? totalSeconds / solved : 0.0},
+                    {"drone_steps", (double)totalSteps}};
+    results.push_back(result);
+}
+
+// FNV-1a over raw bytes: floats are compared bit for bit
+static void hashBytes(uint64_t& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+}
+
+// Fingerprint of a seeded run: every generation's fitness scores, then the
+// final parameters of every network
+static uint64_t runFingerprint(uint64_t seed, int drones, int generations, int swarmThreads = 1) {
+    SimConfig config;
+    config.seed = seed;
+    Swarm swarm(drones, config);
+    swarm.setVerbose(false);
+    swarm.setNumThreads(swarmThreads);
+
+    uint64_t hash = 0xCBF29CE484222325ull;
+    swarm.setGenerationCallback([&hash](Swarm& s) {
+        const std::vector<float>& scores = s.getFitnessScores();
+        hashBytes(hash, scores.data(), scores.size() * sizeof(float));
+    });
+
+    const float dt = 1.0f / 60.0f;
+    while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < generations) {
+        swarm.update(dt);
+    }
+
+    int generation = swarm.getGeneration();
+    hashBytes(hash, &generation, sizeof(generation));
+    std::vector<float> params;
+    for (const auto& network : swarm.getNetworks()) {
+        network->getParameters(params);
+        hashBytes(hash, params.data(), params.size() * sizeof(float));
+    }
+    return hash;
+}
+
+// Recorded fingerprint of seed 1, 20 generations: --determinism with those
+// defaults fails when a change alters the simulation. Valid for builds
+// without FMA (the default flags); -march with FMA contracts a*b+c
+// differently, so there only the in-process comparisons run.
+static const uint64_t goldenSeed = 1;
+static const int goldenGenerations = 20;
+#if defined(__FMA__)
+static const uint64_t goldenHash = 0;
+#else
+static const uint64_t goldenHash = 0x7d8fd7079e5b2f2aull;
+#endif
+
+// Same seed twice in a row, concurrently on several threads and with the
+// swarm moving its drones on worker threads must give the same fingerprint;
+// with expected != 0 it must also match a recorded one
+static int runDeterminism(const BenchOptions& options, int generations, uint64_t expected) {
+    const int drones = 100;
+    const int threads = 4;
+
+    uint64_t reference = runFingerprint(options.seed, drones, generations);
+    std::cout << "seed " << options.seed << ", " << generations << " поколений: "
+              << std::hex << std::setw(16) << std::setfill('0') << reference
+              << std::dec << std::setfill(' ') << std::endl;
+
+    bool ok = runFingerprint(options.seed, drones, generations) == reference;
+    if (!ok) {
+        std::cerr << "Повторный запуск дал другой результат" << std::endl;
+    }
+
+    std::vector<uint64_t> concurrent(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] { concurrent[t] = runFingerprint(options.seed, drones, generations); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (int t = 0; t < threads; t++) {
+        if (concurrent[t] != reference) {
+            std::cerr << "Запуск в потоке " << t << " дал другой результат" << std::endl;
+            ok = false;
+        }
+    }
+
+    // The swarm's own worker threads must not change the evolution either
+    for (int swarmThreads : {2, 3, 7}) {
+        if (runFingerprint(options.seed, drones, generations, swarmThreads) != reference) {
+            std::cerr << "Рой на " << swarmThreads << " потоках дал другой результат" << std::endl;
+            ok = false;
+        }
+    }
+
+    if (!expected && options.seed == goldenSeed && generations == goldenGenerations) {
+        expected = goldenHash;
+    }
+    if (expected && reference != expected) {
+        std::cerr << "Ожидалось " << std::hex << std::setw(16) << std::setfill('0') << expected << std::dec
+                  << std::setfill(' ') << " (симуляция изменилась)" << std::endl;
+        ok = false;
+    }
+
+    std::cout << (ok ? "Детерминизм: OK" : "Детерминизм: ОШИБКА") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// LZ round trip on data of every kind (and no crash on damaged input), then
+// a seeded run recorded raw and compressed: recording must not change the
+// run, both files must decode to the same rows, one per simulated drone-step,
+// ending where the drones are; a file cut short must still be readable.
+static int runEpisodeCheck(const BenchOptions& options) {
+    bool ok = true;
+
+    std::mt19937 rng((uint32_t)options.seed);
+    std::vector<std::vector<uint8_t>> inputs = {{}, {7}, std::vector<uint8_t>(13, 1), std::vector<uint8_t>(100000, 0)};
+    std::vector<uint8_t> noise(100000), pattern(100000), floats(4 * 50000);
+    for (size_t i = 0; i < noise.size(); i++) {
+        noise[i] = (uint8_t)rng();
+        pattern[i] = (uint8_t)(i % 3 == 0 ? rng() % 4 : i % 7);
+    }
+    for (size_t i = 0; i < 50000; i++) {
+        float value = 10.0f * std::sin(i * 0.001f);
+        std::memcpy(&floats[4 * i], &value, sizeof(value));
+    }
+    std::vector<uint8_t> shuffledFloats(floats.size());
+    shuffleBytes(floats.data(), 50000, 4, shuffledFloats.data());
+    inputs.insert(inputs.end(), {noise, pattern, floats, shuffledFloats});
+
+    for (const std::vector<uint8_t>& input : inputs) {
+        std::vector<uint8_t> packed(lzCompressBound(input.size()));
+        packed.resize(lzCompress(input.data(), input.size(), packed.data()));
+        std::vector<uint8_t> output(input.size());
+        bool roundTrip = lzDecompress(packed.data(), packed.size(), output.data(), output.size()) && output == input;
+        bool truncated = packed.size() < 2 || !lzDecompress(packed.data(), packed.size() - 1, output.data(), output.size());
+        for (int i = 0; i < 100 && !packed.empty(); i++) {
+            std::vector<uint8_t> damaged = packed;
+            damaged[rng() % damaged.size()] ^= (uint8_t)(1 + rng() % 255);
+            lzDecompress(damaged.data(), damaged.size(), output.data(), output.size());  // Must not crash
+        }
+        std::vector<uint8_t> back(input.size());
+        std::vector<uint8_t> planes(input.size());
+        shuffleBytes(input.data(), input.size() / 4, 4, planes.data());
+        unshuffleBytes(planes.data(), input.size() / 4, 4, back.data());
+        bool shuffle = std::equal(back.begin(), back.begin() + input.size() / 4 * 4, input.begin());
+        if (!roundTrip || !truncated || !shuffle) {
+            std::cout << "LZ: ошибка на " << input.size() << " байтах" << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "LZ: " << inputs.size() << " входов, " << (ok ? "туда и обратно без потерь" : "ОШИБКИ") << std::endl;
+
+    // A run with the default (large) hole: generations end in successes too
+    const int drones = 100;
+    const int generations = 3;
+    const float dt = 1.0f / 60.0f;
+    const std::string path = (std::filesystem::temp_directory_path() / "nndrons_episode_check.bin").string();
+    uint64_t hashes[3] = {};
+    long long steps = 0;
+    std::vector<Vec3> positions, velocities;
+    int lastGeneration = 0;
+
+    for (int variant = 0; variant < 3; variant++) {
+        SimConfig config;
+        config.seed = options.seed;
+        Swarm swarm(drones, config);
+        swarm.setVerbose(false);
+        uint64_t& hash = hashes[variant];
+        hash = 0xCBF29CE484222325ull;
+        swarm.setGenerationCallback([&hash](Swarm& s) {
+            const std::vector<float>& scores = s.getFitnessScores();
+            hashBytes(hash, scores.data(), scores.size() * sizeof(float));
+        });
+
+        // Small chunks and queue: several chunks per generation, back-pressure
+        EpisodeRecorder::Options recorderOptions;
+        recorderOptions.chunkRows = 1000;
+        recorderOptions.maxQueuedChunks = 1;
+        recorderOptions.compress = variant == 2;
+        std::unique_ptr<EpisodeRecorder> recorder;
+        if (variant > 0) {
+            recorder.reset(new EpisodeRecorder(path + (variant == 2 ? ".lz" : ".raw"), recorderOptions, options.seed));
+            if (!recorder->isOpen()) {
+                return 1;
+            }
+            swarm.setEpisodeRecorder(recorder.get());
+        }
+
+        // Stop mid-generation: the last rows must match the drones' state
+        int updates = 0;
+        while (!swarm.hasAnyDroneSucceeded() && (swarm.getGeneration() < generations || updates % 97 != 0)) {
+            swarm.update(dt);
+            updates++;
+        }
+        steps = swarm.getSimulatedSteps();
+        lastGeneration = swarm.getGeneration();
+        positions.clear();
+        velocities.clear();
+        for (const auto& drone : swarm.getDrones()) {
+            positions.push_back(drone->getPosition());
+            velocities.push_back(drone->getVelocity());
+        }
+    }
+    ok = ok && hashes[1] == hashes[0] && hashes[2] == hashes[0];
+    std::cout << "Запись журнала " << (hashes[1] == hashes[0] && hashes[2] == hashes[0] ? "не меняет" : "МЕНЯЕТ")
+              << " запуск" << std::endl;
+
+    EpisodeReader raw(path + ".raw"), lz(path + ".lz");
+    if (!raw.isOpen() || !lz.isOpen()) {
+        return 1;
+    }
+    bool same = raw.hasIndex() && lz.hasIndex() && raw.getSeed() == options.seed &&
+                raw.getRowCount() == (uint64_t)steps && lz.getRowCount() == (uint64_t)steps &&
+                raw.getGenerations() == lz.getGenerations() && (int)raw.getGenerations().back() == lastGeneration;
+    for (int32_t generation : raw.getGenerations()) {
+        std::vector<EpisodeRow> a = raw.query(generation), b = lz.query(generation);
+        same = same && a.size() == b.size();
+        for (size_t i = 0; same && i < a.size(); i++) {
+            same = a[i].step == b[i].step && a[i].drone == b[i].drone && a[i].status == b[i].status &&
+                   sameVec3(a[i].position, b[i].position) && sameVec3(a[i].velocity, b[i].velocity) &&
+                   sameFloat(a[i].reward, b[i].reward) &&
+                   std::memcmp(a[i].control, b[i].control, sizeof(a[i].control)) == 0;
+        }
+    }
+    // Steps are stored per chunk, not per row: per-step queries must partition the generation
+    size_t stepRows = 0;
+    for (int64_t step = 0; same; step++) {
+        std::vector<EpisodeRow> rows = lz.query(lastGeneration, -1, step);
+        if (rows.empty()) {
+            break;
+        }
+        for (const EpisodeRow& row : rows) {
+            same = same && row.step == step;
+        }
+        stepRows += rows.size();
+    }
+    same = same && stepRows == lz.query(lastGeneration).size();
+    for (int d = 0; same && d < drones; d++) {
+        std::vector<EpisodeRow> rows = lz.query(lastGeneration, d);
+        same = rows.empty() || (sameVec3(rows.back().position, positions[d]) &&
+                                sameVec3(rows.back().velocity, velocities[d]));
+    }
+    std::cout << "Журнал: " << raw.getChunks().size() << " чанков, " << raw.getRowCount() << " строк, "
+              << raw.getFileBytes() << " -> " << lz.getFileBytes() << " байт со сжатием, "
+              << (same ? "совпадает с запуском" : "РАСХОДИТСЯ с запуском") << std::endl;
+    ok = ok && same;
+
+    // Cut mid-chunk (as after a crash): no index, the complete chunks remain
+    {
+        std::ifstream in(path + ".lz", std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const EpisodeChunkInfo& last = lz.getChunks().back();
+        std::ofstream out(path + ".cut", std::ios::binary);
+        out.write(bytes.data(), (std::streamsize)(last.offset + 20));
+    }
+    EpisodeReader cut(path + ".cut");
+    bool recovered = cut.isOpen() && !cut.hasIndex() && cut.getChunks().size() + 1 == lz.getChunks().size() &&
+                     cut.getRowCount() == lz.getRowCount() - lz.getChunks().back().rows;
+    std::cout << "Оборванный файл: " << cut.getChunks().size() << " чанков найдено сканированием" << std::endl;
+    ok = ok && recovered;
+
+    // An index entry claiming more rows than its chunk holds: the index is
+    // dropped and the chunks are scanned instead of over-reading
+    {
+        std::ifstream in(path + ".raw", std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        const size_t lastEntry = bytes.size() - 16 - sizeof(EpisodeChunkInfo);
+        uint32_t rows = raw.getChunks().back().rows * 4;
+        std::memcpy(bytes.data() + lastEntry + offsetof(EpisodeChunkInfo, rows), &rows, sizeof(rows));
+        std::ofstream out(path + ".bad", std::ios::binary);
+        out.write(bytes.data(), (std::streamsize)bytes.size());
+    }
+    EpisodeReader bad(path + ".bad");
+    bool rejected = bad.isOpen() && !bad.hasIndex() && bad.getRowCount() == raw.getRowCount();
+    std::cout << "Неверный индекс: " << (rejected ? "отброшен, чанки найдены сканированием" : "ПРИНЯТ") << std::endl;
+    ok = ok && rejected;
+
+    for (const char* suffix : {".raw", ".lz", ".cut", ".bad"}) {
+        std::remove((path + suffix).c_str());
+    }
+    std::cout << (ok ? "Журнал эпизодов: OK" : "Журнал эпизодов: ОШИБКА") << std::endl;
+    return ok ? 0 : 1;
+}
+
+static void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n  \"date\": \"" << date << "\",\n";
+#ifdef __VERSION__
+    out << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+#endif
+#ifdef NDEBUG
+    out << "  \"optimized\": true,\n";
+#else
+    out << "  \"optimized\": false,\n";
+#endif
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"batch\": " << r.batch
+            << std::setprecision(6) << std::defaultfloat
+            << ", \"ns_per_item\": " << r.nsPerItem << ", \"ns_per_item_min\": " << r.nsPerItemMin
+            << ", \"samples\": " << r.samples;
+        for (const auto& metric : r.extra) {
+            out << ", \"" << metric.first << "\": " << metric.second;
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    std::string outFile;
+    bool determinism = false;
+    bool exportCheck = false;
+    bool precisionCheck = false;
+    bool simdCheck = false;
+    bool episodeCheck = false;
+    int precisionMembers = 1000;
+    int determinismGenerations = 20;
+    uint64_t expectedHash = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--micro") {
+            options.macro = false;
+        } else if (arg == "--macro") {
+            options.micro = false;
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minSampleSeconds = std::stod(argv[++i]);
+        } else if (arg == "--trials" && i + 1 < argc) {
+            options.trials = std::stoi(argv[++i]);
+        } else if (arg == "--max-generations" && i + 1 < argc) {
+            options.maxGenerations = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--determinism") {
+            determinism = true;
+        } else if (arg == "--export-check") {
+            exportCheck = true;
+        } else if (arg == "--precision-check") {
+            precisionCheck = true;
+        } else if (arg == "--simd-check") {
+            simdCheck = true;
+        } else if (arg == "--episode-check") {
+            episodeCheck = true;
+        } else if (arg == "--population" && i + 1 < argc) {
+            precisionMembers = std::max(4, std::stoi(argv[++i]));
+        } else if (arg == "--generations" && i + 1 < argc) {
+            determinismGenerations = std::stoi(argv[++i]);
+        } else if (arg == "--expect" && i + 1 < argc) {
+            expectedHash = std::stoull(argv[++i], nullptr, 16);
+        } else {
+            std::cerr << "Использование: nndrons_bench [--out FILE.json] [--filter NAME] [--micro|--macro]\n"
+                      << "  [--samples N] [--min-time SEC] [--trials N] [--max-generations G] [--seed S]\n"
+                      << "       nndrons_bench --determinism [--seed S] [--generations G] [--expect HASH]\n"
+                      << "       nndrons_bench --export-check\n"
+                      << "       nndrons_bench --precision-check [--seed S] [--population N] [--generations G] [--trials N]\n"
+                      << "       nndrons_bench --simd-check\n"
+                      << "       nndrons_bench --episode-check [--seed S]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (determinism) {
+        return runDeterminism(options, determinismGenerations, expectedHash);
+    }
+    if (exportCheck) {
+        return runExportCheck();
+    }
+    if (precisionCheck) {
+        return runPrecisionCheck(options, precisionMembers, determinismGenerations, options.trials);
+    }
+    if (simdCheck) {
+        return runSimdCheck();
+    }
+    if (episodeCheck) {
+        return runEpisodeCheck(options);
+    }
+
+#ifndef NDEBUG
+    std::cerr << "Внимание: сборка без оптимизации (cmake -DCMAKE_BUILD_TYPE=Release)" << std::endl;
+#endif
+
+    std::vector<BenchResult> results;
+    if (options.micro) {
+        runMicro(options, results);
+        runExportedPolicy(options, results);
+    }
+    if (options.macro) {
+        runGenerations(options, results);
+        runEpisodeLog(options, results);
+        runTimeToSuccess(options, results);
+    }
+
+    if (outFile.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream file(outFile);
+        if (!file) {
+            std::cerr << "Ошибка открытия файла: " << outFile << std::endl;
+            return 1;
+        }
+        writeJson(file, results);
+        std::cerr << "Результаты записаны в " << outFile << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include "distillation.h"
+#include "batch_mlp.h"
+#include "policy_eval.h"
+#include "random_streams.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Policy distillation: record a trained teacher's (observation, action) pairs
+// on seeded episodes, fit smaller students to them with minibatch backprop and
+// compare success rate and inference speed of teacher and students on a fixed
+// seeded set of holes.
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the measured calls' results observable
+static volatile float sink;
+
+struct Options {
+    std::string inFile = "best_network.bin";
+    std::vector<std::vector<int>> students = {{22, 16, 4}, {22, 8, 4}, {22, 4}};
+    int recordEpisodes = 1000;  // Teacher-driven episodes for the dataset
+    float actionNoise = 0.1f;   // On the driven controls, never on the labels
+    int daggerRounds = 2;       // Extra student-driven recordings, teacher-labelled
+    int daggerEpisodes = 500;
+    int evalEpisodes = 200;
+    DistillTraining training;
+    std::string savePrefix;
+    std::string csvFile;
+};
+
+struct NetworkResult {
+    std::string name;
+    int parameters;
+    float loss;
+    PolicyEvaluation evaluation;
+    double forwardNs;        // NeuralNetwork::forward, one observation
+    double batchPerSecond;   // BatchMlp::predict, observations per second
+};
+
+static std::string layerName(const std::vector<int>& sizes) {
+    std::string name;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        name += (i > 0 ? "-" : "") + std::to_string(sizes[i]);
+    }
+    return name;
+}
+
+static bool parseStudents(const std::string& text, std::vector<std::vector<int>>& students) {
+    students.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        SimConfig parsed;
+        if (!parsed.set("layerSizes", item)) {
+            return false;
+        }
+        students.push_back(parsed.layerSizes);
+    }
+    return !students.empty();
+}
+
+static BatchPolicy batchPolicy(const BatchMlp& network) {
+    return [&network](const Eigen::MatrixXf& observations, Eigen::MatrixXf& actions) {
+        actions = network.predict(observations);
+    };
+}
+
+// Success rate on the fixed holes plus both throughput measurements
+static void measure(const BatchMlp& network, const SimConfig& config, int evalEpisodes, NetworkResult& result) {
+    result.evaluation = evaluatePolicy(batchPolicy(network), config, evalEpisodes);
+    NeuralNetwork single(network.getLayerSizes(), 0u);
+    network.copyTo(single);
+    result.parameters = single.getParameterCount();
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    const int inputCount = 1024;
+    Eigen::MatrixXf inputs(network.getLayerSizes().front(), inputCount);
+    for (int i = 0; i < inputs.size(); i++) {
+        inputs.data()[i] = value(rng);
+    }
+    std::vector<std::vector<float>> columns(inputCount);
+    for (int i = 0; i < inputCount; i++) {
+        columns[i].assign(inputs.col(i).data(), inputs.col(i).data() + inputs.rows());
+    }
+
+    long long calls = 0;
+    auto start = Clock::now();
+    double seconds = 0.0;
+    while (seconds < 0.2) {
+        for (const auto& column : columns) {
+            sink = single.forward(column)[0];
+        }
+        calls += inputCount;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    result.forwardNs = seconds * 1e9 / calls;
+
+    calls = 0;
+    start = Clock::now();
+    seconds = 0.0;
+    while (seconds < 0.2) {
+        sink = network.predict(inputs)(0, 0);
+        calls += inputCount;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    result.batchPerSecond = calls / seconds;
+}
+
+static void printResult(const NetworkResult& r) {
+    std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(10) << r.name << std::right
+              << " | параметров " << std::setw(5) << r.parameters << " | ошибка " << std::setprecision(4)
+              << std::setw(7) << r.loss << std::setprecision(1) << " | успех " << std::setw(5)
+              << r.evaluation.successRate * 100.0f << "% | награда " << std::setw(7) << r.evaluation.meanReturn
+              << " | forward " << std::setw(6) << r.forwardNs << " нс | пакет " << std::setprecision(2)
+              << std::setw(6) << r.batchPerSecond / 1e6 << " млн/с" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    config.seed = 1;
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--in" && i + 1 < argc) {
+            options.inFile = argv[++i];
+        } else if (arg == "--students" && i + 1 < argc) {
+            if (!parseStudents(argv[++i], options.students)) {
+                std::cerr << "Неверный список студентов (пример: 22-8-4,22-4): " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--episodes" && i + 1 < argc) {
+            options.recordEpisodes = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--noise" && i + 1 < argc) {
+            options.actionNoise = std::max(0.0f, std::stof(argv[++i]));
+        } else if (arg == "--dagger" && i + 1 < argc) {
+            options.daggerRounds = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--dagger-episodes" && i + 1 < argc) {
+            options.daggerEpisodes = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--epochs" && i + 1 < argc) {
+            options.training.epochs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.training.batchSize = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--lr" && i + 1 < argc) {
+            options.training.learningRate = std::stof(argv[++i]);
+        } else if (arg == "--eval-episodes" && i + 1 < argc) {
+            options.evalEpisodes = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--save" && i + 1 < argc) {
+            options.savePrefix = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csvFile = argv[++i];
+        } else {
+            std::cout << "Использование: nndrons_distill [--in best_network.bin] [--students 22-16-4,22-8-4,22-4]\n"
+                      << "  [--episodes N] [--noise S] [--dagger ROUNDS] [--dagger-episodes N]\n"
+                      << "  [--epochs N] [--batch B] [--lr LR] [--eval-episodes N] [--seed S]\n"
+                      << "  [--save PREFIX] [--csv FILE]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    options.training.seed = config.seed;
+
+    NeuralNetwork teacherNetwork(config.layerSizes, 0u);
+    if (!teacherNetwork.load(options.inFile)) {
+        return 1;
+    }
+    BatchMlp teacher(teacherNetwork.getLayerSizes(), false, 0);
+    std::vector<float> params;
+    teacherNetwork.getParameters(params);
+    teacher.setParameters(params);
+
+    // Recording holes never overlap the evaluation ones (config.seed, Trial)
+    auto start = Clock::now();
+    SimConfig recordConfig = config;
+    recordConfig.seed = deriveSeed(config.seed, SeedStream::Repeat, 0);
+    DistillDataset teacherData;
+    recordTeacher(batchPolicy(teacher), BatchPolicy(), recordConfig, options.recordEpisodes, options.actionNoise,
+                  teacherData);
+    std::cout << "Датасет учителя: " << teacherData.size() << " пар за " << options.recordEpisodes
+              << " эпизодов (" << std::fixed << std::setprecision(1)
+              << std::chrono::duration<float>(Clock::now() - start).count() << " с); проверка: seed "
+              << config.seed << ", " << options.evalEpisodes << " эпизодов" << std::endl;
+
+    std::vector<NetworkResult> results(1);
+    results[0].name = layerName(teacherNetwork.getLayerSizes());
+    results[0].loss = 0.0f;
+    measure(teacher, config, options.evalEpisodes, results[0]);
+    printResult(results[0]);
+
+    for (size_t s = 0; s < options.students.size(); s++) {
+        start = Clock::now();
+        BatchMlp student(options.students[s], false, deriveSeed32(config.seed, SeedStream::NetworkInit, s));
+        DistillDataset data = teacherData;
+        NetworkResult result;
+        result.name = layerName(options.students[s]);
+        result.loss = trainStudent(student, data, options.training);
+
+        // DAgger: the student flies, the teacher labels what it sees
+        for (int round = 1; round <= options.daggerRounds; round++) {
+            recordConfig.seed = deriveSeed(config.seed, SeedStream::Repeat, round);
+            recordTeacher(batchPolicy(teacher), batchPolicy(student), recordConfig, options.daggerEpisodes,
+                          options.actionNoise, data);
+            result.loss = trainStudent(student, data, options.training);
+        }
+
+        measure(student, config, options.evalEpisodes, result);
+        printResult(result);
+        std::cout << "           " << data.size() << " пар, "
+                  << std::chrono::duration<float>(Clock::now() - start).count() << " с" << std::endl;
+        results.push_back(result);
+
+        if (!options.savePrefix.empty()) {
+            NeuralNetwork network(options.students[s], 0u);
+            student.copyTo(network);
+            network.save(options.savePrefix + "_" + result.name + ".bin");
+        }
+    }
+
+    if (!options.csvFile.empty()) {
+        std::ofstream file(options.csvFile);
+        if (!file.is_open()) {
+            std::cerr << "Ошибка открытия файла для сохранения: " << options.csvFile << std::endl;
+            return 1;
+        }
+        file << "network,parameters,loss,success,mean_return,forward_ns,batch_per_second\n";
+        for (const auto& r : results) {
+            file << r.name << "," << r.parameters << "," << r.loss << "," << r.evaluation.successRate << ","
+                 << r.evaluation.meanReturn << "," << r.forwardNs << "," << r.batchPerSecond << "\n";
+        }
+    }
+    return 0;
+}
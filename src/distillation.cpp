@@ -0,0 +1,104 @@
+#include "distillation.h"
+#include "vec_env.h"
+#include "random_streams.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+int DistillDataset::size() const {
+    return (int)(observations.size() / VecEnv::observationSize);
+}
+
+void DistillDataset::clear() {
+    observations.clear();
+    actions.clear();
+}
+
+void recordTeacher(const BatchPolicy& teacher, const BatchPolicy& driver, const SimConfig& config, int episodes,
+                   float actionNoise, DistillDataset& dataset) {
+    VecEnv env(episodes, config);
+    std::vector<uint64_t> seeds(episodes);
+    for (int i = 0; i < episodes; i++) {
+        seeds[i] = deriveSeed(config.seed, SeedStream::Trial, i);
+    }
+
+    Eigen::MatrixXf observations(VecEnv::observationSize, episodes);  // Column i = env i
+    Eigen::MatrixXf labels(VecEnv::actionSize, episodes);
+    Eigen::MatrixXf actions(VecEnv::actionSize, episodes);
+    std::vector<float> rewards(episodes);
+    std::vector<uint8_t> dones(episodes), finished(episodes, 0);
+    std::mt19937 rng(deriveSeed32(config.seed, SeedStream::Exploration, 0));
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    env.reset(seeds.data(), observations.data());
+
+    int remaining = episodes;
+    while (remaining > 0) {
+        teacher(observations, labels);
+        for (int i = 0; i < episodes; i++) {
+            if (!finished[i]) {
+                const float* o = observations.col(i).data();
+                const float* a = labels.col(i).data();
+                dataset.observations.insert(dataset.observations.end(), o, o + VecEnv::observationSize);
+                dataset.actions.insert(dataset.actions.end(), a, a + VecEnv::actionSize);
+            }
+        }
+
+        if (driver) {
+            driver(observations, actions);
+        } else {
+            actions = labels;
+        }
+        if (actionNoise > 0.0f) {
+            for (int i = 0; i < actions.size(); i++) {
+                actions.data()[i] = std::min(1.0f, std::max(-1.0f, actions.data()[i] + actionNoise * noise(rng)));
+            }
+        }
+
+        env.step(actions.data(), observations.data(), rewards.data(), dones.data());
+        for (int i = 0; i < episodes; i++) {
+            if (!finished[i] && dones[i] != VecEnv::Running) {
+                finished[i] = 1;
+                remaining--;
+            }
+        }
+    }
+}
+
+float trainStudent(BatchMlp& student, const DistillDataset& dataset, const DistillTraining& training) {
+    const int samples = dataset.size();
+    const int batchSize = std::min(training.batchSize, samples);
+    if (batchSize < 1) {
+        return 0.0f;
+    }
+    Eigen::Map<const Eigen::MatrixXf> observations(dataset.observations.data(), VecEnv::observationSize, samples);
+    Eigen::Map<const Eigen::MatrixXf> actions(dataset.actions.data(), VecEnv::actionSize, samples);
+
+    std::vector<int> order(samples);
+    std::iota(order.begin(), order.end(), 0);
+    Eigen::MatrixXf input(VecEnv::observationSize, batchSize);
+    Eigen::MatrixXf target(VecEnv::actionSize, batchSize);
+    Eigen::MatrixXf gradient(VecEnv::actionSize, batchSize);
+
+    float epochLoss = 0.0f;
+    for (int epoch = 0; epoch < training.epochs; epoch++) {
+        std::mt19937 rng(deriveSeed32(training.seed, SeedStream::ReplaySample, epoch));
+        std::shuffle(order.begin(), order.end(), rng);
+
+        // Full batches only; the tail joins the next epoch's shuffle
+        double lossSum = 0.0;
+        int batches = samples / batchSize;
+        for (int b = 0; b < batches; b++) {
+            for (int j = 0; j < batchSize; j++) {
+                input.col(j) = observations.col(order[b * batchSize + j]);
+                target.col(j) = actions.col(order[b * batchSize + j]);
+            }
+            gradient = student.forward(input) - target;
+            lossSum += gradient.squaredNorm() / batchSize;
+            gradient *= 2.0f / batchSize;
+            student.backward(gradient);
+            student.adamStep(training.learningRate);
+        }
+        epochLoss = (float)(lossSum / batches);
+    }
+    return epochLoss;
+}
@@ -2,9 +2,10 @@
 #include "neural_network.h"
 #include <cmath>
 
-Drone::Drone(const Vec3& startPos)
+Drone::Drone(const Vec3& startPos, const SimConfig& config)
     : position(startPos), velocity(0, 0, 0), radius(0.5f),
-      active(true), successful(false) {
+      active(true), successful(false),
+      maxSpeed(config.maxSpeed), controlStrength(config.controlStrength) {
 }
 
 void Drone::reset(const Vec3& startPos) {
@@ -21,16 +22,20 @@ void Drone::update(float dt) {
     position += velocity * dt;
 
     // Apply LESS damping - let drones maintain momentum better (prevents early stopping)
-    velocity = velocity * 0.995f;  // Changed from 0.98 to 0.995 - less friction
+    velocity = velocity * damping;  // Changed from 0.98 to 0.995 - less friction
 }
 
 void Drone::applyControl(const std::vector<float>& control) {
-    if (!active || control.size() < 4) return;
+    if (control.size() < static_cast<size_t>(controlCount)) return;
+    applyControl(control.data());
+}
+
+void Drone::applyControl(const float* control) {
+    if (!active) return;
 
     // Control is 4 values: force in X, Y, Z directions, and forward thrust
     // Simple model: directly adjust velocity (no mass/acceleration for simplicity)
-    float maxSpeed = 10.0f;       // Max speed
-    float controlStrength = 1.5f; // INCREASED from 1.0 to 1.5 - more responsive control!
+    // maxSpeed and controlStrength come from SimConfig (defaults 10.0 and 1.5)
 
     Vec3 controlVec(control[0], control[1], control[2]);
 
@@ -38,7 +43,7 @@ void Drone::applyControl(const std::vector<float>& control) {
     velocity += controlVec * controlStrength;
 
     // Forward bias - помощь дронам двигаться к стене (положительное направление Z)
-    velocity.z += 0.06f;  // Оптимальный баланс - не слишком сильно, но помогает
+    velocity.z += forwardBias;  // Оптимальный баланс - не слишком сильно, но помогает
 
     // Clamp velocity
     if (velocity.lengthSquared() > maxSpeed * maxSpeed) {
@@ -47,17 +52,21 @@ void Drone::applyControl(const std::vector<float>& control) {
 }
 
 std::vector<float> Drone::getSensorReadings(const Environment& env) const {
-    std::vector<float> sensors;
+    std::vector<float> sensors(sensorCount);
+    writeSensorReadings(env, sensors.data());
+    return sensors;
+}
 
+void Drone::writeSensorReadings(const Environment& env, float* sensors) const {
     // 1. Drone's own position (3 values)
-    sensors.push_back(position.x / 10.0f);  // Normalize to roughly [-1, 1]
-    sensors.push_back(position.y / 10.0f);
-    sensors.push_back(position.z / 10.0f);
+    *sensors++ = position.x / 10.0f;  // Normalize to roughly [-1, 1]
+    *sensors++ = position.y / 10.0f;
+    *sensors++ = position.z / 10.0f;
 
     // 2. Drone's velocity (3 values)
-    sensors.push_back(velocity.x / 5.0f);
-    sensors.push_back(velocity.y / 5.0f);
-    sensors.push_back(velocity.z / 5.0f);
+    *sensors++ = velocity.x / 5.0f;
+    *sensors++ = velocity.y / 5.0f;
+    *sensors++ = velocity.z / 5.0f;
 
     // 3. Direction to hole center (3 values)
     Vec3 toHole = env.getHoleCenter() - position;
@@ -65,21 +74,21 @@ std::vector<float> Drone::getSensorReadings(const Environment& env) const {
     Vec3 dirToHole(0, 0, 0);
     if (distToHole > 0.001f) {
         dirToHole = toHole.normalized();
-        sensors.push_back(dirToHole.x);
-        sensors.push_back(dirToHole.y);
-        sensors.push_back(dirToHole.z);
+        *sensors++ = dirToHole.x;
+        *sensors++ = dirToHole.y;
+        *sensors++ = dirToHole.z;
     } else {
-        sensors.push_back(0);
-        sensors.push_back(0);
-        sensors.push_back(0);
+        *sensors++ = 0;
+        *sensors++ = 0;
+        *sensors++ = 0;
     }
 
     // 4. Distance to hole (1 value)
-    sensors.push_back(distToHole / 20.0f);
+    *sensors++ = distToHole / 20.0f;
 
     // 5. Distance to wall (1 value) - НОВОЕ! Важно для избежания столкновений
     float distToWall = std::abs(position.z - env.getWallZ());
-    sensors.push_back(distToWall / 15.0f); // Normalize
+    *sensors++ = distToWall / 15.0f; // Normalize
 
     // 6. Alignment with hole (1 value) - как хорошо мы нацелены на дыру
     // Dot product между направлением движения и направлением к дыре
@@ -88,16 +97,16 @@ std::vector<float> Drone::getSensorReadings(const Environment& env) const {
         Vec3 velDir = velocity.normalized();
         alignment = velDir.dot(dirToHole);
     }
-    sensors.push_back(alignment);
+    *sensors++ = alignment;
 
     // 7. Offset from hole in XY plane (2 values) - насколько мы смещены от дыры
     Vec3 holePos = env.getHoleCenter();
-    sensors.push_back((position.x - holePos.x) / 10.0f);
-    sensors.push_back((position.y - holePos.y) / 10.0f);
+    *sensors++ = (position.x - holePos.x) / 10.0f;
+    *sensors++ = (position.y - holePos.y) / 10.0f;
 
     // 8. Ray cast sensors in 8 directions (8 values)
     // Front, back, left, right, up, down, and 2 diagonals
-    std::vector<Vec3> rayDirections = {
+    static const Vec3 rayDirections[] = {
         Vec3(1, 0, 0),   // Right
         Vec3(-1, 0, 0),  // Left
         Vec3(0, 1, 0),   // Up
@@ -109,11 +118,10 @@ std::vector<float> Drone::getSensorReadings(const Environment& env) const {
     };
 
     for (const auto& dir : rayDirections) {
-        sensors.push_back(castRay(dir, env));
+        *sensors++ = castRay(dir, env);
     }
 
     // Total: 3 + 3 + 3 + 1 + 1 + 1 + 2 + 8 = 22 input values
-    return sensors;
 }
 
 float Drone::castRay(const Vec3& direction, const Environment& env) const {
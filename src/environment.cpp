@@ -1,10 +1,11 @@
 #include "environment.h"
+#include "random_streams.h"
 #include <random>
 
-Environment::Environment()
-    : wallZ(0.0f), holeRadius(1.0f),
+Environment::Environment(const SimConfig& config)
+    : holeRadius(config.holeRadius), wallZ(0.0f),
       boundsMin(-12, -12, -40), boundsMax(12, 12, 10),  // ИСПРАВЛЕНО: было -20, теперь -40 (дроны стартуют на -35!)
-      rng(std::random_device{}()) {
+      seed(config.seed ? config.seed : randomMasterSeed()), resets(0) {
     reset();
 }
 
@@ -16,12 +17,11 @@ void Environment::reset() {
     // МАКСИМАЛЬНО УВЕЛИЧЕННЫЙ РАЗБРОС - дыра может быть где угодно на стене!
     std::uniform_real_distribution<float> distX(-10.0f, 10.0f);  // Was -6 to 6, now HUGE range!
     std::uniform_real_distribution<float> distY(-10.0f, 10.0f);  // Was -6 to 6, now HUGE range!
+    std::mt19937 rng(deriveSeed32(seed, SeedStream::Environment, resets++));
 
     holeCenter = Vec3(distX(rng), distY(rng), wallZ);
 
-    // ОЧЕНЬ МАЛЕНЬКАЯ ДЫРА - всего 1.2x размера дрона!
-    // Дроны имеют радиус 0.5, дыра теперь только 1.2x = очень точное прохождение!
-    holeRadius = 0.6f;  // Was 1.0f (2x), now 0.6f (1.2x) - ОЧЕНЬ СЛОЖНО!
+    // Hole radius comes from SimConfig (default 0.6 = 1.2x drone radius - ОЧЕНЬ СЛОЖНО!)
 }
 
 bool Environment::isInHole(const Vec3& position) const {
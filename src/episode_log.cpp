@@ -0,0 +1,607 @@
+#include "episode_log.h"
+#include "lz_codec.h"
+#include "trace.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+static const char fileMagic[8] = {'N', 'N', 'D', 'E', 'P', 'L', 'O', 'G'};
+static const uint32_t fileVersion = 2;
+static const uint32_t chunkMagic = 0x4B4E4843;  // "CHNK"
+static const uint32_t indexMagic = 0x58444E49;  // "INDX"
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t columnCount;
+    uint64_t seed;
+};
+
+struct ChunkHeader {
+    uint32_t magic;
+    int32_t generation;
+    uint32_t rows;
+    uint32_t firstStep;
+    uint32_t lastStep;
+    uint32_t columnCount;
+    uint64_t bytes;  // Whole chunk: this header, column headers, payloads
+};
+
+enum ColumnEncoding : uint8_t { RawColumn, ShuffledLzColumn };
+
+// Payload follows in column order, each padded to 8 bytes
+struct ColumnHeader {
+    uint8_t encoding;
+    uint8_t elementSize;
+    uint16_t reserved;
+    uint32_t storedBytes;
+};
+
+struct Trailer {
+    uint64_t indexOffset;
+    uint32_t chunkCount;
+    uint32_t magic;
+};
+
+static_assert(sizeof(FileHeader) == 24 && sizeof(ChunkHeader) == 32 && sizeof(ColumnHeader) == 8 &&
+              sizeof(Trailer) == 16, "episode log layout");
+
+static size_t padded(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+const char* episodeStatusName(EpisodeStatus status) {
+    switch (status) {
+        case EpisodeStatus::Flying: return "flying";
+        case EpisodeStatus::Success: return "success";
+        case EpisodeStatus::Collided: return "collided";
+        case EpisodeStatus::OutOfBounds: return "out_of_bounds";
+    }
+    return "unknown";
+}
+
+void EpisodeColumns::resize(size_t rows) {
+    this->rows = rows;
+    if (drone.size() >= rows) {
+        return;
+    }
+    drone.resize(rows);
+    for (auto& column : values) {
+        column.resize(rows);
+    }
+    status.resize(rows);
+}
+
+uint32_t EpisodeColumns::stepOf(size_t i) const {
+    auto next = std::upper_bound(stepStart.begin(), stepStart.end(), static_cast<uint32_t>(i));
+    return firstStep + static_cast<uint32_t>(next - stepStart.begin()) - 1;
+}
+
+EpisodeRow EpisodeColumns::row(size_t i) const {
+    EpisodeRow row;
+    row.generation = generation;
+    row.step = stepOf(i);
+    row.drone = drone[i];
+    row.position = Vec3(values[PositionX - PositionX][i], values[PositionY - PositionX][i],
+                        values[PositionZ - PositionX][i]);
+    row.velocity = Vec3(values[VelocityX - PositionX][i], values[VelocityY - PositionX][i],
+                        values[VelocityZ - PositionX][i]);
+    for (int c = 0; c < Drone::controlCount; c++) {
+        row.control[c] = values[Control0 - PositionX + c][i];
+    }
+    row.reward = values[Reward - PositionX][i];
+    row.status = static_cast<EpisodeStatus>(status[i]);
+    return row;
+}
+
+const uint8_t* EpisodeColumns::columnData(int column) const {
+    return const_cast<EpisodeColumns*>(this)->columnData(column);
+}
+
+uint8_t* EpisodeColumns::columnData(int column) {
+    switch (column) {
+        case StepStart: return reinterpret_cast<uint8_t*>(stepStart.data());
+        case DroneIndex: return reinterpret_cast<uint8_t*>(drone.data());
+        case Status: return status.data();
+        default: return reinterpret_cast<uint8_t*>(values[column - PositionX].data());
+    }
+}
+
+size_t EpisodeColumns::elementSize(int column) {
+    return column == Status ? sizeof(uint8_t) : sizeof(uint32_t);
+}
+
+// ---------------------------------------------------------------------------
+
+EpisodeRecorder::EpisodeRecorder(const std::string& path, const Options& options, uint64_t seed)
+    : options(options), open(false), file(nullptr), rowsRecorded(0), stallSeconds(0.0), fileOffset(0),
+      chunksSubmitted(0), chunksWritten(0), rawBytes(0), storedBytes(0), writerSeconds(0.0), stopping(false) {
+    this->options.chunkRows = std::max<size_t>(1, options.chunkRows);
+    this->options.maxQueuedChunks = std::max<size_t>(1, options.maxQueuedChunks);
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Ошибка открытия журнала эпизодов: " << path << std::endl;
+        return;
+    }
+    FileHeader header;
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.columnCount = EpisodeColumns::ColumnCount;
+    header.seed = seed;
+    if (!writeBytes(&header, sizeof(header))) {
+        std::cerr << "Ошибка записи журнала эпизодов: " << path << std::endl;
+        std::fclose(file);
+        file = nullptr;
+        return;
+    }
+    fileOffset = sizeof(header);
+
+    current.reset(new EpisodeColumns());
+    current->resize(this->options.chunkRows);
+    current->clear();
+    open = true;
+    thread = std::thread(&EpisodeRecorder::run, this);
+}
+
+EpisodeRecorder::~EpisodeRecorder() {
+    if (!open) {
+        return;
+    }
+
+    submitCurrent();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    thread.join();
+
+    // Index last: its presence says the file is complete
+    Trailer trailer;
+    trailer.indexOffset = fileOffset;
+    trailer.chunkCount = static_cast<uint32_t>(index.size());
+    trailer.magic = indexMagic;
+    if (!writeBytes(index.data(), index.size() * sizeof(EpisodeChunkInfo)) ||
+        !writeBytes(&trailer, sizeof(trailer))) {
+        std::cerr << "Ошибка записи журнала эпизодов" << std::endl;
+    }
+    std::fclose(file);
+}
+
+void EpisodeRecorder::record(int generation, uint32_t step, uint32_t droneIndex, const Drone& drone,
+                             const float* control, float reward, EpisodeStatus status) {
+    if (!open) {
+        return;
+    }
+    // A chunk covers consecutive steps of one generation
+    if (current->rows > 0 &&
+        (current->generation != generation || step < current->lastStep() || step > current->lastStep() + 1)) {
+        submitCurrent();
+    }
+    EpisodeColumns& chunk = *current;
+    if (chunk.rows == 0) {
+        chunk.generation = generation;
+        chunk.firstStep = step;
+    }
+    const size_t i = chunk.rows;
+    if (chunk.stepStart.empty() || step != chunk.lastStep()) {
+        chunk.stepStart.push_back(static_cast<uint32_t>(i));
+    }
+
+    // Stored by index into columns sized at chunkRows: no per-column capacity checks
+    Vec3 position = drone.getPosition();
+    Vec3 velocity = drone.getVelocity();
+    const float values[EpisodeColumns::floatColumns] = {position.x, position.y, position.z,
+                                                        velocity.x, velocity.y, velocity.z,
+                                                        control[0], control[1], control[2], control[3], reward};
+    for (int c = 0; c < EpisodeColumns::floatColumns; c++) {
+        chunk.values[c][i] = values[c];
+    }
+    chunk.drone[i] = droneIndex;
+    chunk.status[i] = static_cast<uint8_t>(status);
+    chunk.rows = i + 1;
+    rowsRecorded++;
+
+    if (chunk.rows >= options.chunkRows) {
+        submitCurrent();
+    }
+}
+
+void EpisodeRecorder::endGeneration() {
+    if (open) {
+        submitCurrent();
+    }
+}
+
+void EpisodeRecorder::flush() {
+    if (!open) {
+        return;
+    }
+    submitCurrent();
+    std::unique_lock<std::mutex> lock(mutex);
+    queueChanged.wait(lock, [this] { return chunksWritten == chunksSubmitted; });
+}
+
+void EpisodeRecorder::submitCurrent() {
+    if (current->size() == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (queue.size() >= options.maxQueuedChunks) {
+        // Back-pressure instead of unbounded memory or lost rows
+        auto start = std::chrono::steady_clock::now();
+        queueChanged.wait(lock, [this] { return queue.size() < options.maxQueuedChunks; });
+        stallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    queue.push_back(std::move(current));
+    chunksSubmitted++;
+
+    // Reuse a chunk the writer has finished with
+    if (!freeChunks.empty()) {
+        current = std::move(freeChunks.back());
+        freeChunks.pop_back();
+    } else {
+        current.reset(new EpisodeColumns());
+        current->resize(options.chunkRows);
+        current->clear();
+    }
+    queueChanged.notify_all();
+}
+
+uint64_t EpisodeRecorder::getChunksWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunksWritten;
+}
+
+uint64_t EpisodeRecorder::getRawBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return rawBytes;
+}
+
+uint64_t EpisodeRecorder::getStoredBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return storedBytes;
+}
+
+double EpisodeRecorder::getWriterSeconds() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return writerSeconds;
+}
+
+// CPU time, not wall time: on a busy core the writer waits for the simulation
+static double threadCpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void EpisodeRecorder::run() {
+    Trace::setThreadName("episode log");
+    bool failed = false;
+    while (true) {
+        std::unique_ptr<EpisodeColumns> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;  // Stopping and fully drained
+            }
+            chunk = std::move(queue.front());
+            queue.pop_front();
+        }
+        queueChanged.notify_all();
+
+        double cpuStart = threadCpuSeconds();
+        if (!failed && !writeChunk(*chunk)) {
+            std::cerr << "Ошибка записи журнала эпизодов" << std::endl;
+            failed = true;
+        }
+
+        chunk->clear();
+        double cpuSeconds = threadCpuSeconds() - cpuStart;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunksWritten++;
+            writerSeconds += cpuSeconds;
+            freeChunks.push_back(std::move(chunk));
+        }
+        queueChanged.notify_all();
+    }
+}
+
+// LZ costs about 1 ns per input byte. Most float columns (positions,
+// velocities, controls) shrink by under a fifth: trial-compress the first
+// elements and keep the column raw unless it saves at least that much.
+static bool worthCompressing(const uint8_t* data, size_t length, size_t elementSize, std::vector<uint8_t>& scratch) {
+    const size_t sampleElements = 1024;
+    size_t count = std::min(length, sampleElements);
+    size_t bytes = count * elementSize;
+    scratch.resize(bytes + lzCompressBound(bytes));
+    shuffleBytes(data, count, elementSize, scratch.data());
+    size_t compressed = lzCompress(scratch.data(), bytes, scratch.data() + bytes);
+    return compressed * 5 <= bytes * 4;
+}
+
+bool EpisodeRecorder::writeChunk(const EpisodeColumns& chunk) {
+    TRACE_SCOPE("EpisodeRecorder::writeChunk");
+    static const uint8_t zeros[8] = {};
+    const size_t rows = chunk.size();
+    ColumnHeader columns[EpisodeColumns::ColumnCount];
+    size_t packedStart[EpisodeColumns::ColumnCount];
+    uint64_t chunkRaw = 0;
+    uint64_t payloadBytes = 0;
+
+    // Compressed columns go to `packed`; raw ones are written straight from the chunk
+    packed.clear();
+    for (int c = 0; c < EpisodeColumns::ColumnCount; c++) {
+        size_t elementSize = EpisodeColumns::elementSize(c);
+        size_t length = chunk.columnLength(c);
+        size_t bytes = length * elementSize;
+        columns[c].encoding = RawColumn;
+        columns[c].elementSize = static_cast<uint8_t>(elementSize);
+        columns[c].reserved = 0;
+        columns[c].storedBytes = static_cast<uint32_t>(bytes);
+        packedStart[c] = packed.size();
+        chunkRaw += bytes;
+
+        if (options.compress && worthCompressing(chunk.columnData(c), length, elementSize, shuffled)) {
+            // Byte planes first: the sign/exponent bytes of floats repeat a lot
+            shuffled.resize(bytes);
+            shuffleBytes(chunk.columnData(c), length, elementSize, shuffled.data());
+            packed.resize(packedStart[c] + lzCompressBound(bytes));
+            size_t compressed = lzCompress(shuffled.data(), bytes, &packed[packedStart[c]]);
+            if (compressed < bytes) {
+                columns[c].encoding = ShuffledLzColumn;
+                columns[c].storedBytes = static_cast<uint32_t>(compressed);
+            }
+            packed.resize(packedStart[c] + (columns[c].encoding == RawColumn ? 0 : compressed));
+        }
+        payloadBytes += padded(columns[c].storedBytes);
+    }
+
+    ChunkHeader header;
+    header.magic = chunkMagic;
+    header.generation = chunk.generation;
+    header.rows = static_cast<uint32_t>(rows);
+    header.firstStep = chunk.firstStep;
+    header.lastStep = chunk.lastStep();
+    header.columnCount = EpisodeColumns::ColumnCount;
+    header.bytes = sizeof(header) + sizeof(columns) + payloadBytes;
+
+    bool ok = writeBytes(&header, sizeof(header)) && writeBytes(columns, sizeof(columns));
+    for (int c = 0; ok && c < EpisodeColumns::ColumnCount; c++) {
+        size_t stored = columns[c].storedBytes;
+        const uint8_t* data = columns[c].encoding == RawColumn ? chunk.columnData(c) : &packed[packedStart[c]];
+        ok = writeBytes(data, stored) && writeBytes(zeros, padded(stored) - stored);
+    }
+    if (ok) {
+        index.push_back({fileOffset, header.generation, header.rows, header.firstStep, header.lastStep});
+        fileOffset += header.bytes;
+        std::lock_guard<std::mutex> lock(mutex);
+        rawBytes += chunkRaw;
+        storedBytes += payloadBytes;
+    }
+    return ok;
+}
+
+bool EpisodeRecorder::writeBytes(const void* data, size_t size) {
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+// ---------------------------------------------------------------------------
+
+EpisodeReader::EpisodeReader(const std::string& path)
+    : base(nullptr), mappedBytes(0), seed(0), indexed(false) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Ошибка открытия журнала эпизодов: " << path << std::endl;
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) {
+        close(fd);
+        std::cerr << "Неверный формат журнала эпизодов: " << path << std::endl;
+        return;
+    }
+    void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Ошибка отображения журнала эпизодов в память: " << path << std::endl;
+        return;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, mapped, sizeof(header));
+    if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0 || header.version != fileVersion ||
+        header.columnCount != EpisodeColumns::ColumnCount) {
+        munmap(mapped, st.st_size);
+        std::cerr << "Неверный формат журнала эпизодов: " << path << std::endl;
+        return;
+    }
+
+    base = static_cast<const uint8_t*>(mapped);
+    mappedBytes = st.st_size;
+    seed = header.seed;
+    if (!loadIndex()) {
+        scanChunks();
+    }
+}
+
+EpisodeReader::~EpisodeReader() {
+    if (base) {
+        munmap(const_cast<uint8_t*>(base), mappedBytes);
+    }
+}
+
+bool EpisodeReader::loadIndex() {
+    if (mappedBytes < sizeof(FileHeader) + sizeof(Trailer)) {
+        return false;
+    }
+    Trailer trailer;
+    std::memcpy(&trailer, base + mappedBytes - sizeof(trailer), sizeof(trailer));
+    uint64_t indexBytes = (uint64_t)trailer.chunkCount * sizeof(EpisodeChunkInfo);
+    if (trailer.magic != indexMagic || trailer.indexOffset < sizeof(FileHeader) ||
+        trailer.indexOffset + indexBytes + sizeof(trailer) != mappedBytes) {
+        return false;
+    }
+
+    // Index entries must agree with the chunk headers they point at; readers
+    // trust info.rows, so a stale or damaged index falls back to scanning
+    std::vector<EpisodeChunkInfo> entries(trailer.chunkCount);
+    std::memcpy(entries.data(), base + trailer.indexOffset, indexBytes);
+    for (EpisodeChunkInfo& entry : entries) {
+        EpisodeChunkInfo parsed;
+        uint64_t next;
+        if (!parseChunk(entry.offset, parsed, next) || next > trailer.indexOffset ||
+            parsed.generation != entry.generation || parsed.rows != entry.rows ||
+            parsed.firstStep != entry.firstStep || parsed.lastStep != entry.lastStep) {
+            return false;
+        }
+        entry = parsed;
+    }
+    chunks = std::move(entries);
+    indexed = true;
+    return true;
+}
+
+void EpisodeReader::scanChunks() {
+    chunks.clear();
+    uint64_t offset = sizeof(FileHeader);
+    EpisodeChunkInfo info;
+    uint64_t next;
+    while (parseChunk(offset, info, next)) {
+        chunks.push_back(info);
+        offset = next;
+    }
+    indexed = false;
+}
+
+bool EpisodeReader::parseChunk(uint64_t offset, EpisodeChunkInfo& info, uint64_t& next) const {
+    const uint64_t headersBytes = sizeof(ChunkHeader) + EpisodeColumns::ColumnCount * sizeof(ColumnHeader);
+    if (offset + headersBytes > mappedBytes) {
+        return false;
+    }
+    ChunkHeader header;
+    std::memcpy(&header, base + offset, sizeof(header));
+    // Every step of the chunk has at least one row
+    if (header.magic != chunkMagic || header.columnCount != EpisodeColumns::ColumnCount ||
+        header.bytes < headersBytes || header.bytes > mappedBytes - offset ||
+        header.lastStep < header.firstStep || header.lastStep - header.firstStep >= header.rows) {
+        return false;
+    }
+
+    // Payloads must add up to the chunk
+    const uint64_t steps = (uint64_t)header.lastStep - header.firstStep + 1;
+    uint64_t payload = 0;
+    for (int c = 0; c < EpisodeColumns::ColumnCount; c++) {
+        ColumnHeader column;
+        std::memcpy(&column, base + offset + sizeof(header) + c * sizeof(column), sizeof(column));
+        uint64_t length = c == EpisodeColumns::StepStart ? steps : header.rows;
+        if (column.elementSize != EpisodeColumns::elementSize(c) || column.encoding > ShuffledLzColumn ||
+            (column.encoding == RawColumn && column.storedBytes != length * column.elementSize)) {
+            return false;
+        }
+        payload += padded(column.storedBytes);
+    }
+    if (headersBytes + payload != header.bytes) {
+        return false;
+    }
+
+    info = {offset, header.generation, header.rows, header.firstStep, header.lastStep};
+    next = offset + header.bytes;
+    return true;
+}
+
+std::vector<int32_t> EpisodeReader::getGenerations() const {
+    std::vector<int32_t> generations;
+    for (const EpisodeChunkInfo& chunk : chunks) {
+        generations.push_back(chunk.generation);
+    }
+    std::sort(generations.begin(), generations.end());
+    generations.erase(std::unique(generations.begin(), generations.end()), generations.end());
+    return generations;
+}
+
+uint64_t EpisodeReader::getRowCount() const {
+    uint64_t rows = 0;
+    for (const EpisodeChunkInfo& chunk : chunks) {
+        rows += chunk.rows;
+    }
+    return rows;
+}
+
+bool EpisodeReader::readChunk(size_t chunk, EpisodeColumns& out) const {
+    if (chunk >= chunks.size()) {
+        return false;
+    }
+    const EpisodeChunkInfo& info = chunks[chunk];
+    out.generation = info.generation;
+    out.firstStep = info.firstStep;
+    out.stepStart.resize(info.lastStep - info.firstStep + 1);
+    out.resize(info.rows);
+
+    const uint8_t* columnHeaders = base + info.offset + sizeof(ChunkHeader);
+    const uint8_t* payload = columnHeaders + EpisodeColumns::ColumnCount * sizeof(ColumnHeader);
+    for (int c = 0; c < EpisodeColumns::ColumnCount; c++) {
+        ColumnHeader column;
+        std::memcpy(&column, columnHeaders + c * sizeof(column), sizeof(column));
+        size_t length = out.columnLength(c);
+        size_t bytes = length * column.elementSize;
+        if (column.encoding == RawColumn) {
+            std::memcpy(out.columnData(c), payload, bytes);
+        } else {
+            scratch.resize(bytes);
+            if (!lzDecompress(payload, column.storedBytes, scratch.data(), bytes)) {
+                return false;
+            }
+            unshuffleBytes(scratch.data(), length, column.elementSize, out.columnData(c));
+        }
+        payload += padded(column.storedBytes);
+    }
+
+    // Step starts: from row 0, strictly ascending, inside the chunk
+    for (size_t s = 0; s < out.stepStart.size(); s++) {
+        uint32_t start = out.stepStart[s];
+        if (s == 0 ? start != 0 : start <= out.stepStart[s - 1] || start >= info.rows) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<EpisodeRow> EpisodeReader::query(int32_t generation, int64_t drone, int64_t step) const {
+    std::vector<EpisodeRow> rows;
+    EpisodeColumns columns;
+    for (size_t c = 0; c < chunks.size(); c++) {
+        const EpisodeChunkInfo& info = chunks[c];
+        if (info.generation != generation ||
+            (step >= 0 && (step < (int64_t)info.firstStep || step > (int64_t)info.lastStep))) {
+            continue;
+        }
+        if (!readChunk(c, columns)) {
+            std::cerr << "Повреждённый блок журнала эпизодов: " << c << std::endl;
+            continue;
+        }
+        // Only the rows of the requested step
+        size_t begin = 0, end = columns.size();
+        if (step >= 0) {
+            size_t s = step - info.firstStep;
+            begin = columns.stepStart[s];
+            end = s + 1 < columns.stepStart.size() ? columns.stepStart[s + 1] : columns.size();
+        }
+        for (size_t i = begin; i < end; i++) {
+            if (drone < 0 || columns.drone[i] == drone) {
+                rows.push_back(columns.row(i));
+            }
+        }
+    }
+    return rows;
+}
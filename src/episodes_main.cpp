@@ -0,0 +1,118 @@
+#include "episode_log.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+
+// Summary of an episode log (--episode-log) and row queries by generation,
+// drone and step, optionally as CSV.
+static void printSummary(const EpisodeReader& reader) {
+    std::cout << "Чанков: " << reader.getChunks().size()
+              << ", строк: " << reader.getRowCount()
+              << ", файл: " << reader.getFileBytes() << " байт"
+              << ", seed: " << reader.getSeed()
+              << (reader.hasIndex() ? "" : " (индекса нет: файл оборван, чанки найдены сканированием)")
+              << std::endl;
+
+    EpisodeColumns columns;
+    for (int32_t generation : reader.getGenerations()) {
+        uint32_t steps = 0;
+        size_t counts[4] = {};
+        Vec3 deathSum;
+        size_t deaths = 0;
+        for (size_t c = 0; c < reader.getChunks().size(); c++) {
+            const EpisodeChunkInfo& info = reader.getChunks()[c];
+            if (info.generation != generation || !reader.readChunk(c, columns)) {
+                continue;
+            }
+            steps = std::max(steps, info.lastStep + 1);
+            for (size_t i = 0; i < columns.size(); i++) {
+                EpisodeStatus status = (EpisodeStatus)columns.status[i];
+                counts[(int)status]++;
+                if (status == EpisodeStatus::Collided || status == EpisodeStatus::OutOfBounds) {
+                    deathSum += columns.row(i).position;
+                    deaths++;
+                }
+            }
+        }
+        std::cout << "поколение " << std::setw(5) << generation << " | шагов " << std::setw(5) << steps
+                  << " | успех " << std::setw(5) << counts[(int)EpisodeStatus::Success]
+                  << " | столкновений " << std::setw(5) << counts[(int)EpisodeStatus::Collided]
+                  << " | вылетов " << std::setw(5) << counts[(int)EpisodeStatus::OutOfBounds];
+        if (deaths > 0) {
+            Vec3 mean = deathSum * (1.0f / deaths);
+            std::cout << std::fixed << std::setprecision(2) << " | средняя точка гибели (" << mean.x << ", "
+                      << mean.y << ", " << mean.z << ")" << std::defaultfloat;
+        }
+        std::cout << std::endl;
+    }
+}
+
+static void writeRows(std::ostream& out, const std::vector<EpisodeRow>& rows) {
+    out << "generation,step,drone,px,py,pz,vx,vy,vz,c0,c1,c2,c3,reward,status\n";
+    out << std::setprecision(9);
+    for (const EpisodeRow& row : rows) {
+        out << row.generation << ',' << row.step << ',' << row.drone << ','
+            << row.position.x << ',' << row.position.y << ',' << row.position.z << ','
+            << row.velocity.x << ',' << row.velocity.y << ',' << row.velocity.z;
+        for (float c : row.control) {
+            out << ',' << c;
+        }
+        out << ',' << row.reward << ',' << episodeStatusName(row.status) << '\n';
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string inFile;
+    std::string csvFile;
+    long long generation = -1;
+    long long drone = -1;
+    long long step = -1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--generation" && i + 1 < argc) {
+            generation = std::stoll(argv[++i]);
+        } else if (arg == "--drone" && i + 1 < argc) {
+            drone = std::stoll(argv[++i]);
+        } else if (arg == "--step" && i + 1 < argc) {
+            step = std::stoll(argv[++i]);
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csvFile = argv[++i];
+        } else if (inFile.empty() && !arg.empty() && arg[0] != '-') {
+            inFile = arg;
+        } else {
+            inFile.clear();
+            break;
+        }
+    }
+    if (inFile.empty() || (generation < 0 && (drone >= 0 || step >= 0 || !csvFile.empty()))) {
+        std::cout << "Использование: nndrons_episodes FILE [--generation G [--drone D] [--step S] [--csv OUT.csv]]\n"
+                  << "  без --generation: сводка по поколениям" << std::endl;
+        return 1;
+    }
+
+    EpisodeReader reader(inFile);
+    if (!reader.isOpen()) {
+        return 1;
+    }
+    if (generation < 0) {
+        printSummary(reader);
+        return 0;
+    }
+
+    std::vector<EpisodeRow> rows = reader.query((int32_t)generation, drone, step);
+    if (csvFile.empty()) {
+        writeRows(std::cout, rows);
+        return 0;
+    }
+    std::ofstream out(csvFile);
+    if (!out) {
+        std::cerr << "Ошибка открытия файла для записи: " << csvFile << std::endl;
+        return 1;
+    }
+    writeRows(out, rows);
+    std::cout << "Строк: " << rows.size() << " -> " << csvFile << std::endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "policy_export.h"
+#include "sim_config.h"
+#include <iostream>
+#include <string>
+
+// Turn a trained network (NeuralNetwork::save format) into a standalone C++
+// header for embedding, e.g. in flight-control firmware.
+int main(int argc, char** argv) {
+    std::string inFile = "best_network.bin";
+    std::string outFile = "policy.h";
+    PolicyExportOptions options;
+    long long randomSeed = -1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--in" && i + 1 < argc) {
+            inFile = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--namespace" && i + 1 < argc) {
+            options.nameSpace = argv[++i];
+        } else if (arg == "--fast-tanh") {
+            options.fastTanh = true;
+        } else if (arg == "--random" && i + 1 < argc) {
+            // Untrained network with the default layer sizes (for tests/benchmarks)
+            randomSeed = std::stoll(argv[++i]);
+        } else {
+            std::cout << "Использование: nndrons_export [--in best_network.bin] [--out policy.h]\n"
+                      << "  [--namespace NAME] [--fast-tanh] [--random SEED]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    NeuralNetwork network(SimConfig().layerSizes, randomSeed >= 0 ? (uint32_t)randomSeed : 0u);
+    if (randomSeed >= 0) {
+        options.source = "random seed " + std::to_string(randomSeed);
+    } else {
+        if (!network.load(inFile)) {
+            return 1;
+        }
+        options.source = inFile;
+    }
+
+    if (!exportPolicyHeader(network, outFile, options)) {
+        return 1;
+    }
+    std::cout << "Политика записана в " << outFile << " (" << network.getParameterCount() << " параметров)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "fitness_cache.h"
+
+FitnessCache::FitnessCache(size_t capacity)
+    : evaluationKey(0), capacity(capacity), hits(0), misses(0) {
+}
+
+void FitnessCache::setEvaluationKey(uint64_t key) {
+    if (key != evaluationKey) {
+        entries.clear();
+        evaluationKey = key;
+    }
+}
+
+const FitnessCache::Entry* FitnessCache::lookup(uint64_t genomeHash) {
+    auto it = entries.find(genomeHash);
+    if (it == entries.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    return &it->second;
+}
+
+void FitnessCache::store(uint64_t genomeHash, float fitness, const std::vector<float>& descriptor) {
+    // Simple bound: most entries are mutants that never come back
+    if (entries.size() >= capacity) {
+        entries.clear();
+    }
+    entries[genomeHash] = {fitness, descriptor};
+}
+
+void FitnessCache::clear() {
+    entries.clear();
+    hits = 0;
+    misses = 0;
+}
@@ -0,0 +1,227 @@
+#include "frame_writer.h"
+#include "trace.h"
+#include <filesystem>
+#include <iostream>
+#include <array>
+#include <algorithm>
+
+bool parseFrameFormat(const std::string& name, FrameFormat& format) {
+    if (name == "ppm") {
+        format = FrameFormat::PPM;
+    } else if (name == "png") {
+        format = FrameFormat::PNG;
+    } else if (name == "raw") {
+        format = FrameFormat::Raw;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value >> 24);
+    out.push_back(value >> 16);
+    out.push_back(value >> 8);
+    out.push_back(value);
+}
+
+static void appendChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size) {
+    putBigEndian(out, size);
+    size_t typeStart = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    putBigEndian(out, crc32(&out[typeStart], size + 4));
+}
+
+// PNG with stored (uncompressed) deflate blocks: trivially fast to produce and
+// readable by every decoder; ffmpeg or optipng can compress afterwards
+static void encodePng(const Framebuffer& frame, std::vector<uint8_t>& out) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.assign(signature, signature + 8);
+
+    std::vector<uint8_t> header;
+    putBigEndian(header, frame.width);
+    putBigEndian(header, frame.height);
+    header.insert(header.end(), {8, 2, 0, 0, 0});  // 8-bit RGB, no interlace
+    appendChunk(out, "IHDR", header.data(), header.size());
+
+    // Scanlines with filter type 0
+    size_t rowBytes = (size_t)frame.width * 3;
+    std::vector<uint8_t> raw;
+    raw.reserve((rowBytes + 1) * frame.height);
+    for (int y = 0; y < frame.height; y++) {
+        raw.push_back(0);
+        const uint8_t* row = &frame.pixels[y * rowBytes];
+        raw.insert(raw.end(), row, row + rowBytes);
+    }
+
+    // zlib stream: header, stored blocks of up to 65535 bytes, Adler-32
+    std::vector<uint8_t> zlib = {0x78, 0x01};
+    uint32_t a = 1, b = 0;
+    size_t offset = 0;
+    while (true) {
+        size_t blockSize = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + blockSize == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(blockSize & 0xFF);
+        zlib.push_back(blockSize >> 8);
+        zlib.push_back(~blockSize & 0xFF);
+        zlib.push_back((~blockSize >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        for (size_t i = offset; i < offset + blockSize; i++) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        offset += blockSize;
+        if (last) {
+            break;
+        }
+    }
+    putBigEndian(zlib, (b << 16) | a);
+
+    appendChunk(out, "IDAT", zlib.data(), zlib.size());
+    appendChunk(out, "IEND", nullptr, 0);
+}
+
+FrameWriter::FrameWriter(FrameFormat format, const std::string& path, size_t maxQueuedFrames)
+    : format(format), path(path), maxQueuedFrames(std::max<size_t>(1, maxQueuedFrames)),
+      open(false), rawOut(nullptr), framesWritten(0), stopping(false) {
+    if (format == FrameFormat::Raw) {
+        rawOut = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+        if (!rawOut) {
+            std::cerr << "Ошибка открытия файла для записи: " << path << std::endl;
+            return;
+        }
+    } else {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (!std::filesystem::is_directory(path)) {
+            std::cerr << "Ошибка создания каталога кадров: " << path << std::endl;
+            return;
+        }
+    }
+
+    open = true;
+    thread = std::thread(&FrameWriter::run, this);
+}
+
+FrameWriter::~FrameWriter() {
+    if (!open) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    thread.join();
+
+    if (rawOut == stdout) {
+        std::fflush(stdout);
+    } else if (rawOut) {
+        std::fclose(rawOut);
+    }
+}
+
+void FrameWriter::submit(const Framebuffer& frame) {
+    if (!open) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    queueChanged.wait(lock, [this] { return queue.size() < maxQueuedFrames; });
+
+    // Reuse a buffer the writer thread has finished with
+    Framebuffer copy;
+    if (!freeFrames.empty()) {
+        copy = std::move(freeFrames.back());
+        freeFrames.pop_back();
+    }
+    copy.width = frame.width;
+    copy.height = frame.height;
+    copy.pixels.assign(frame.pixels.begin(), frame.pixels.end());
+
+    queue.push_back(std::move(copy));
+    queueChanged.notify_all();
+}
+
+size_t FrameWriter::getFramesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return framesWritten;
+}
+
+void FrameWriter::run() {
+    Trace::setThreadName("frame writer");
+    size_t index = 0;
+    while (true) {
+        Framebuffer frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueChanged.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;  // Stopping and fully drained
+            }
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        queueChanged.notify_all();
+
+        bool ok = writeFrame(frame, index++);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ok) {
+            framesWritten++;
+        }
+        freeFrames.push_back(std::move(frame));
+    }
+}
+
+bool FrameWriter::writeFrame(const Framebuffer& frame, size_t index) {
+    TRACE_SCOPE("FrameWriter::writeFrame");
+
+    if (format == FrameFormat::Raw) {
+        return std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), rawOut) == frame.pixels.size();
+    }
+
+    if (format == FrameFormat::PNG) {
+        encodePng(frame, encoded);
+    } else {
+        std::string header = "P6\n" + std::to_string(frame.width) + " " + std::to_string(frame.height) + "\n255\n";
+        encoded.assign(header.begin(), header.end());
+        encoded.insert(encoded.end(), frame.pixels.begin(), frame.pixels.end());
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%06zu.%s", index, format == FrameFormat::PNG ? "png" : "ppm");
+    std::string filename = (std::filesystem::path(path) / name).string();
+
+    FILE* file = std::fopen(filename.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Ошибка записи кадра: " << filename << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    std::fclose(file);
+    return ok;
+}
@@ -0,0 +1,283 @@
+#include "genome.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+// Mixes a value into a 64-bit key (splitmix64 finalizer)
+static uint64_t mixKey(uint64_t key, uint64_t value) {
+    uint64_t z = key ^ (value + 0x9E3779B97F4A7C15ULL + (key << 6) + (key >> 2));
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint32_t floatBits(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+Genome Genome::root(uint32_t initSeed) {
+    auto node = std::make_shared<Node>();
+    node->seed = initSeed;
+    node->rate = 0.0f;
+    node->strength = 0.0f;
+    node->depth = 0;
+    node->key = mixKey(0, initSeed);
+    return Genome(node);
+}
+
+Genome Genome::mutated(uint32_t seed, float rate, float strength) const {
+    if (!node) {
+        return Genome();
+    }
+
+    auto child = std::make_shared<Node>();
+    child->parent = node;
+    child->seed = seed;
+    child->rate = rate;
+    child->strength = strength;
+    child->depth = node->depth + 1;
+    child->key = mixKey(mixKey(mixKey(node->key, seed), floatBits(rate)), floatBits(strength));
+    return Genome(child);
+}
+
+size_t Genome::getNodeBytes() {
+    // make_shared puts the node and its two reference counts in one allocation
+    return sizeof(Node) + 2 * sizeof(long);
+}
+
+GenomeMaterializer::GenomeMaterializer(const std::vector<int>& layerSizes, size_t cacheCapacity)
+    : layerSizes(layerSizes), buffer(layerSizes, 0), capacity(cacheCapacity),
+      hits(0), misses(0) {
+}
+
+const NeuralNetwork& GenomeMaterializer::materialize(const Genome& genome) {
+    materialize(genome, buffer);
+    return buffer;
+}
+
+void GenomeMaterializer::materialize(const Genome& genome, NeuralNetwork& network) {
+    if (!genome.isValid()) {
+        return;
+    }
+
+    // Walk up the chain until a cached ancestor (or the root) is found
+    std::vector<const Genome::Node*> path;
+    const Genome::Node* node = genome.node.get();
+    const std::vector<float>* cached = nullptr;
+    while (node) {
+        cached = findCached(node->key);
+        if (cached) {
+            break;
+        }
+        path.push_back(node);
+        node = node->parent.get();
+    }
+
+    if (cached) {
+        hits++;
+        network.setParameters(*cached);
+    } else {
+        misses++;
+        network.randomize(path.back()->seed);
+        path.pop_back();
+    }
+
+    // Replay the remaining mutations, oldest first
+    for (size_t i = path.size(); i-- > 0;) {
+        if (i == 0) {
+            // Siblings share this parent - keep it hot
+            storeCached(path[0]->parent->key, network);
+        }
+        network.mutate(path[i]->rate, path[i]->strength, path[i]->seed);
+    }
+
+    storeCached(genome.getKey(), network);
+}
+
+const std::vector<float>* GenomeMaterializer::findCached(uint64_t key) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return nullptr;
+    }
+    // Move to front (most recently used)
+    lru.splice(lru.begin(), lru, it->second);
+    return &it->second->second;
+}
+
+void GenomeMaterializer::storeCached(uint64_t key, const NeuralNetwork& network) {
+    if (capacity == 0) {
+        return;
+    }
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+
+    if (lru.size() >= capacity) {
+        // Evict the least recently used entry and reuse its storage
+        index.erase(lru.back().first);
+        lru.splice(lru.begin(), lru, std::prev(lru.end()));
+        lru.front().first = key;
+    } else {
+        lru.emplace_front(key, std::vector<float>());
+    }
+
+    network.getParameters(lru.front().second);
+    index[key] = lru.begin();
+}
+
+static const uint32_t genomeFileMagic = 0x47444E4E;  // "NNDG"
+static const uint32_t genomeFileVersion = 2;  // 2: master seed after the version
+
+bool saveGenomes(const std::string& filename, const std::vector<int>& layerSizes,
+                 const std::vector<Genome>& genomes, uint64_t masterSeed) {
+    // Assign indices to unique nodes, parents before children
+    std::unordered_map<const Genome::Node*, int32_t> nodeIndex;
+    std::vector<const Genome::Node*> nodes;
+    std::vector<const Genome::Node*> pending;
+
+    for (const auto& genome : genomes) {
+        const Genome::Node* node = genome.node.get();
+        while (node && nodeIndex.find(node) == nodeIndex.end()) {
+            pending.push_back(node);
+            node = node->parent.get();
+        }
+        while (!pending.empty()) {
+            nodeIndex[pending.back()] = static_cast<int32_t>(nodes.size());
+            nodes.push_back(pending.back());
+            pending.pop_back();
+        }
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка открытия файла для сохранения: " << filename << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&genomeFileMagic), sizeof(genomeFileMagic));
+    file.write(reinterpret_cast<const char*>(&genomeFileVersion), sizeof(genomeFileVersion));
+    file.write(reinterpret_cast<const char*>(&masterSeed), sizeof(masterSeed));
+
+    int32_t numLayers = static_cast<int32_t>(layerSizes.size());
+    file.write(reinterpret_cast<const char*>(&numLayers), sizeof(numLayers));
+    file.write(reinterpret_cast<const char*>(layerSizes.data()), numLayers * sizeof(int));
+
+    // Lineage nodes: parent index (-1 for roots), seed, rate, strength
+    uint32_t nodeCount = static_cast<uint32_t>(nodes.size());
+    file.write(reinterpret_cast<const char*>(&nodeCount), sizeof(nodeCount));
+    for (const auto* node : nodes) {
+        int32_t parent = node->parent ? nodeIndex[node->parent.get()] : -1;
+        file.write(reinterpret_cast<const char*>(&parent), sizeof(parent));
+        file.write(reinterpret_cast<const char*>(&node->seed), sizeof(node->seed));
+        file.write(reinterpret_cast<const char*>(&node->rate), sizeof(node->rate));
+        file.write(reinterpret_cast<const char*>(&node->strength), sizeof(node->strength));
+    }
+
+    // Population: one node index per genome
+    uint32_t genomeCount = static_cast<uint32_t>(genomes.size());
+    file.write(reinterpret_cast<const char*>(&genomeCount), sizeof(genomeCount));
+    for (const auto& genome : genomes) {
+        int32_t idx = genome.isValid() ? nodeIndex[genome.node.get()] : -1;
+        file.write(reinterpret_cast<const char*>(&idx), sizeof(idx));
+    }
+
+    return file.good();
+}
+
+bool loadGenomes(const std::string& filename, std::vector<int>& layerSizes,
+                 std::vector<Genome>& genomes, uint64_t* masterSeed) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка открытия файла для загрузки: " << filename << std::endl;
+        return false;
+    }
+
+    // Counts are checked against the bytes left before anything is sized by
+    // them; the outputs change only if the whole file is valid
+    size_t remaining = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    auto read = [&](void* out, size_t bytes) {
+        if (bytes > remaining || !file.read(reinterpret_cast<char*>(out), bytes)) {
+            return false;
+        }
+        remaining -= bytes;
+        return true;
+    };
+
+    uint32_t magic = 0, version = 0;
+    if (!read(&magic, sizeof(magic)) || !read(&version, sizeof(version)) ||
+        magic != genomeFileMagic || version < 1 || version > genomeFileVersion) {
+        std::cerr << "Неверный формат файла геномов: " << filename << std::endl;
+        return false;
+    }
+
+    uint64_t seed = 0;
+    int32_t numLayers = 0;
+    if ((version >= 2 && !read(&seed, sizeof(seed))) || !read(&numLayers, sizeof(numLayers)) ||
+        numLayers < 2 || numLayers > 64) {
+        std::cerr << "Неверный формат файла геномов: " << filename << std::endl;
+        return false;
+    }
+    std::vector<int> sizes(numLayers);
+    if (!read(sizes.data(), numLayers * sizeof(int))) {
+        std::cerr << "Неверный формат файла геномов: " << filename << std::endl;
+        return false;
+    }
+    for (int size : sizes) {
+        if (size < 1 || size > (1 << 16)) {
+            std::cerr << "Неверный размер слоя " << size << ": " << filename << std::endl;
+            return false;
+        }
+    }
+
+    // Lineage nodes: parent index (-1 for roots), seed, rate, strength
+    const size_t nodeBytes = sizeof(int32_t) + sizeof(uint32_t) + 2 * sizeof(float);
+    uint32_t nodeCount = 0;
+    if (!read(&nodeCount, sizeof(nodeCount)) || (size_t)nodeCount * nodeBytes > remaining) {
+        std::cerr << "Повреждённый файл геномов: " << filename << std::endl;
+        return false;
+    }
+    std::vector<Genome> nodes;
+    nodes.reserve(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        int32_t parent;
+        uint32_t nodeSeed;
+        float rate, strength;
+        if (!read(&parent, sizeof(parent)) || !read(&nodeSeed, sizeof(nodeSeed)) ||
+            !read(&rate, sizeof(rate)) || !read(&strength, sizeof(strength)) ||
+            (parent >= 0 && static_cast<uint32_t>(parent) >= i)) {
+            std::cerr << "Повреждённый файл геномов: " << filename << std::endl;
+            return false;
+        }
+        nodes.push_back(parent < 0 ? Genome::root(nodeSeed) : nodes[parent].mutated(nodeSeed, rate, strength));
+    }
+
+    // Population: one node index per genome, -1 for an empty genome
+    uint32_t genomeCount = 0;
+    if (!read(&genomeCount, sizeof(genomeCount)) || (size_t)genomeCount * sizeof(int32_t) != remaining) {
+        std::cerr << "Повреждённый файл геномов: " << filename << std::endl;
+        return false;
+    }
+    std::vector<Genome> population;
+    population.reserve(genomeCount);
+    for (uint32_t i = 0; i < genomeCount; i++) {
+        int32_t idx;
+        if (!read(&idx, sizeof(idx)) || idx < -1 || (idx >= 0 && static_cast<uint32_t>(idx) >= nodes.size())) {
+            std::cerr << "Повреждённый файл геномов: " << filename << std::endl;
+            return false;
+        }
+        population.push_back(idx >= 0 ? nodes[idx] : Genome());
+    }
+
+    layerSizes.swap(sizes);
+    genomes.swap(population);
+    if (masterSeed) {
+        *masterSeed = seed;
+    }
+    return true;
+}
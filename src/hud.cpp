@@ -0,0 +1,309 @@
+#include "hud.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+// 5x7 bitmap font: uppercase, digits and a few symbols (bit 4 = leftmost column)
+struct Glyph {
+    char ch;
+    uint8_t rows[7];
+};
+
+static const Glyph font[] = {
+    {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+    {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},
+    {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+    {'+', {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}},
+    {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+    {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+    {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+    {'=', {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}},
+    {'A', {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+    {'D', {0x1E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1E}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+    {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+    {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+    {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+    {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    {'Y', {0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04}},
+    {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {'|', {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+};
+
+static const Glyph* findGlyph(char ch) {
+    if (ch >= 'a' && ch <= 'z') {
+        ch = ch - 'a' + 'A';
+    }
+    for (const Glyph& glyph : font) {
+        if (glyph.ch == ch) {
+            return &glyph;
+        }
+    }
+    return nullptr;  // Space and anything unknown
+}
+
+static const size_t historyLength = 120;
+static const float refreshSeconds = 0.5f;
+
+Hud::Hud()
+    : visible(false), windowStart(std::chrono::steady_clock::now()), windowFrames(0),
+      windowAllocations(0), windowSteps(-1), fps(0.0f), stepsPerSecond(0.0),
+      allocationsPerFrame(0.0), activeDrones(0), totalDrones(0), generation(0),
+      historyGeneration(-1) {
+    std::fill(windowTimes, windowTimes + Metrics::zoneCount, 0);
+    std::fill(zoneMs, zoneMs + Metrics::zoneCount, 0.0f);
+}
+
+void Hud::setVisible(bool enabled) {
+    visible = enabled;
+    Metrics::setEnabled(enabled);
+
+    // Start a clean window - counters from before were not running
+    uint64_t discardTimes[Metrics::zoneCount];
+    uint64_t discardAllocations;
+    Metrics::collect(discardTimes, discardAllocations);
+    std::fill(windowTimes, windowTimes + Metrics::zoneCount, 0);
+    windowAllocations = 0;
+    windowFrames = 0;
+    windowSteps = -1;
+    windowStart = std::chrono::steady_clock::now();
+}
+
+void Hud::update(const SwarmSnapshot& snapshot) {
+    // Fitness history is cheap and kept even while hidden
+    if (snapshot.generation != historyGeneration) {
+        if (historyGeneration >= 0) {
+            history.emplace_back(snapshot.lastGenerationBest, snapshot.lastGenerationMean);
+            if (history.size() > historyLength) {
+                history.pop_front();
+            }
+        }
+        historyGeneration = snapshot.generation;
+    }
+
+    if (!visible) {
+        return;
+    }
+
+    uint64_t times[Metrics::zoneCount];
+    uint64_t allocations;
+    Metrics::collect(times, allocations);
+    for (int i = 0; i < Metrics::zoneCount; i++) {
+        windowTimes[i] += times[i];
+    }
+    windowAllocations += allocations;
+    windowFrames++;
+    if (windowSteps < 0) {
+        windowSteps = snapshot.simulatedSteps;
+    }
+
+    generation = snapshot.generation;
+    totalDrones = static_cast<int>(snapshot.drones.size());
+    activeDrones = 0;
+    for (const auto& drone : snapshot.drones) {
+        activeDrones += drone.status == DroneSnapshot::Active;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    float seconds = std::chrono::duration<float>(now - windowStart).count();
+    if (seconds < refreshSeconds) {
+        return;
+    }
+
+    // Simulation zones run on their own thread: report their time per rendered frame
+    for (int i = 0; i < Metrics::zoneCount; i++) {
+        zoneMs[i] = windowTimes[i] / 1e6f / windowFrames;
+        windowTimes[i] = 0;
+    }
+    fps = windowFrames / seconds;
+    stepsPerSecond = (snapshot.simulatedSteps - windowSteps) / seconds;
+    allocationsPerFrame = (double)windowAllocations / windowFrames;
+
+    windowAllocations = 0;
+    windowFrames = 0;
+    windowSteps = snapshot.simulatedSteps;
+    windowStart = now;
+}
+
+void Hud::drawText(float x, float y, const std::string& text, float scale) const {
+    glBegin(GL_QUADS);
+    for (char ch : text) {
+        const Glyph* glyph = findGlyph(ch);
+        if (glyph) {
+            for (int row = 0; row < 7; row++) {
+                for (int col = 0; col < 5; col++) {
+                    if (glyph->rows[row] & (0x10 >> col)) {
+                        float px = x + col * scale;
+                        float py = y + row * scale;
+                        glVertex2f(px, py);
+                        glVertex2f(px + scale, py);
+                        glVertex2f(px + scale, py + scale);
+                        glVertex2f(px, py + scale);
+                    }
+                }
+            }
+        }
+        x += 6 * scale;
+    }
+    glEnd();
+}
+
+void Hud::drawChart(float x, float y, float w, float h) const {
+    glColor4f(1.0f, 1.0f, 1.0f, 0.15f);
+    glBegin(GL_LINE_LOOP);
+    glVertex2f(x, y);
+    glVertex2f(x + w, y);
+    glVertex2f(x + w, y + h);
+    glVertex2f(x, y + h);
+    glEnd();
+
+    if (history.size() < 2) {
+        return;
+    }
+
+    float lo = history.front().second, hi = history.front().first;
+    for (const auto& entry : history) {
+        lo = std::min(lo, std::min(entry.first, entry.second));
+        hi = std::max(hi, std::max(entry.first, entry.second));
+    }
+    float range = std::max(hi - lo, 1e-3f);
+    float step = w / (historyLength - 1);
+
+    for (int series = 0; series < 2; series++) {
+        if (series == 0) {
+            glColor3f(0.2f, 1.0f, 0.2f);  // Best
+        } else {
+            glColor3f(1.0f, 0.8f, 0.2f);  // Mean
+        }
+        glBegin(GL_LINE_STRIP);
+        for (size_t i = 0; i < history.size(); i++) {
+            float value = series == 0 ? history[i].first : history[i].second;
+            glVertex2f(x + i * step, y + h - (value - lo) / range * h);
+        }
+        glEnd();
+    }
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "%.0f", hi);
+    glColor3f(0.8f, 0.8f, 0.8f);
+    drawText(x + w + 4, y, label, 1.0f);
+    std::snprintf(label, sizeof(label), "%.0f", lo);
+    drawText(x + w + 4, y + h - 7, label, 1.0f);
+}
+
+void Hud::draw(int width, int height) const {
+    if (!visible) {
+        return;
+    }
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, width, height, 0, -1, 1);  // Pixels, origin top-left
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    const float scale = 2.0f;
+    const float line = 9 * scale;
+    const float x = 10.0f;
+    float y = 10.0f;
+
+    // Panel
+    glColor4f(0.0f, 0.0f, 0.0f, 0.55f);
+    glBegin(GL_QUADS);
+    glVertex2f(0, 0);
+    glVertex2f(330, 0);
+    glVertex2f(330, 330);
+    glVertex2f(0, 330);
+    glEnd();
+
+    char text[96];
+    float frameMs = fps > 0.0f ? 1000.0f / fps : 0.0f;
+    glColor3f(1.0f, 1.0f, 1.0f);
+    std::snprintf(text, sizeof(text), "FPS %.0f  FRAME %.1f MS", fps, frameMs);
+    drawText(x, y, text, scale);
+    y += line * 1.5f;
+
+    // Per-zone time with a bar relative to a 60 Hz frame
+    for (int i = 0; i < Metrics::zoneCount; i++) {
+        std::snprintf(text, sizeof(text), "%-9s %6.2f MS", Metrics::zoneName(static_cast<MetricZone>(i)), zoneMs[i]);
+        glColor3f(0.85f, 0.85f, 0.85f);
+        drawText(x, y, text, scale);
+
+        float bar = std::min(zoneMs[i] / 16.7f, 1.0f) * 80.0f;
+        glColor3f(0.3f, 0.6f, 1.0f);
+        glBegin(GL_QUADS);
+        glVertex2f(x + 232, y);
+        glVertex2f(x + 232 + bar, y);
+        glVertex2f(x + 232 + bar, y + 7 * scale);
+        glVertex2f(x + 232, y + 7 * scale);
+        glEnd();
+        y += line;
+    }
+    y += line * 0.5f;
+
+    glColor3f(1.0f, 1.0f, 1.0f);
+    std::snprintf(text, sizeof(text), "STEPS/S %.0f", stepsPerSecond);
+    drawText(x, y, text, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "ACTIVE %d/%d  GEN %d", activeDrones, totalDrones, generation);
+    drawText(x, y, text, scale);
+    y += line;
+    std::snprintf(text, sizeof(text), "ALLOC/FRAME %.0f", allocationsPerFrame);
+    drawText(x, y, text, scale);
+    y += line * 1.5f;
+
+    glColor3f(0.2f, 1.0f, 0.2f);
+    drawText(x, y, "BEST", 1.0f);
+    glColor3f(1.0f, 0.8f, 0.2f);
+    drawText(x + 36, y, "MEAN", 1.0f);
+    drawChart(x, y + 12, 240, 60);
+
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
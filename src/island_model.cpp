@@ -0,0 +1,205 @@
+#include "island_model.h"
+#include "swarm.h"
+#include "random_streams.h"
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <iostream>
+
+bool parseTopology(const std::string& name, MigrationTopology& topology) {
+    if (name == "none") {
+        topology = MigrationTopology::None;
+    } else if (name == "ring") {
+        topology = MigrationTopology::Ring;
+    } else if (name == "full") {
+        topology = MigrationTopology::Full;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* topologyName(MigrationTopology topology) {
+    switch (topology) {
+        case MigrationTopology::None: return "none";
+        case MigrationTopology::Ring: return "ring";
+        case MigrationTopology::Full: return "full";
+    }
+    return "?";
+}
+
+// Islands this island receives migrants from
+static std::vector<int> migrationSources(int island, const IslandConfig& config) {
+    std::vector<int> sources;
+    int n = config.numIslands;
+    if (n < 2) {
+        return sources;
+    }
+
+    if (config.topology == MigrationTopology::Ring) {
+        sources.push_back((island + n - 1) % n);
+    } else if (config.topology == MigrationTopology::Full) {
+        for (int i = 0; i < n; i++) {
+            if (i != island) {
+                sources.push_back(i);
+            }
+        }
+    }
+    return sources;
+}
+
+void runIsland(int island, const IslandConfig& config, const Vec3& holeCenter, MigrationRing& ring) {
+    // Forked workers would otherwise all start from the same master seed
+    SimConfig sim = config.sim;
+    if (sim.seed) {
+        sim.seed = deriveSeed(sim.seed, SeedStream::Island, island);
+    }
+    Swarm swarm(config.populationPerIsland, sim);
+    swarm.setVerbose(false);
+    swarm.setHoleCenter(holeCenter);
+
+    std::vector<int> sources = migrationSources(island, config);
+    std::vector<uint64_t> cursors(config.numIslands, 0);
+    std::vector<MigrationRing::Migrant> migrants;
+    std::vector<float> params;
+
+    // Runs at the end of every failed generation, before selection
+    swarm.setGenerationCallback([&](Swarm& s) {
+        if (config.topology == MigrationTopology::None ||
+            (s.getGeneration() + 1) % config.migrationInterval != 0) {
+            return;
+        }
+
+        const auto& scores = s.getFitnessScores();
+        std::vector<int> order(scores.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return scores[a] > scores[b]; });
+
+        int k = std::min<int>(config.migrantsPerInterval, order.size());
+
+        // Emigrate: publish our top-k
+        for (int i = 0; i < k; i++) {
+            s.getNetworks()[order[i]]->getParameters(params);
+            ring.publish(island, s.getGeneration(), scores[order[i]], params);
+        }
+
+        // Immigrate: best k arrivals replace our worst, if they're better
+        migrants.clear();
+        for (int source : sources) {
+            ring.collect(source, cursors[source], migrants);
+        }
+        std::sort(migrants.begin(), migrants.end(),
+                  [](const MigrationRing::Migrant& a, const MigrationRing::Migrant& b) {
+                      return a.fitness > b.fitness;
+                  });
+
+        int accepted = std::min<int>(k, migrants.size());
+        for (int i = 0; i < accepted; i++) {
+            int worst = order[order.size() - 1 - i];
+            if (migrants[i].fitness > scores[worst]) {
+                s.importGenome(worst, migrants[i].params, migrants[i].fitness);
+            }
+        }
+    });
+
+    const float targetDt = 1.0f / 60.0f;
+    while (ring.getSolvedIsland() < 0 && !swarm.hasAnyDroneSucceeded() &&
+           swarm.getGeneration() < config.maxGenerations) {
+        swarm.update(targetDt);
+    }
+
+    if (swarm.hasAnyDroneSucceeded()) {
+        ring.markSolved(island, swarm.getGeneration());
+    }
+}
+
+IslandResult runIslands(const IslandConfig& config, const Vec3& holeCenter) {
+    IslandResult result = {false, -1, -1, 0.0f};
+
+    int paramCount;
+    {
+        Swarm probe(1, config.sim);
+        paramCount = probe.getNetworks()[0]->getParameterCount();
+    }
+
+    std::string name = "/nndrons_islands_" + std::to_string(getpid());
+    std::unique_ptr<MigrationRing> ring(
+        MigrationRing::create(name, config.numIslands, config.slotsPerIsland, paramCount));
+    if (!ring) {
+        return result;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<pid_t> workers;
+    for (int island = 0; island < config.numIslands; island++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // Child shares the mapping; _exit so it doesn't unlink the segment
+            runIsland(island, config, holeCenter, *ring);
+            _exit(0);
+        }
+        if (pid < 0) {
+            std::cerr << "Ошибка fork() для острова " << island << std::endl;
+            break;
+        }
+        workers.push_back(pid);
+    }
+
+    // Wait for the workers, timing the first success
+    size_t running = workers.size();
+    while (running > 0) {
+        if (!result.solved && ring->getSolvedIsland() >= 0) {
+            result.solved = true;
+            result.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        int status;
+        pid_t done = waitpid(-1, &status, WNOHANG);
+        if (done > 0) {
+            running--;
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+
+    if (ring->getSolvedIsland() >= 0) {
+        if (!result.solved) {
+            result.solved = true;
+            result.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        }
+        result.island = ring->getSolvedIsland();
+        result.generation = ring->getSolvedGeneration();
+    } else {
+        result.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    return result;
+}
+
+IslandResult runSinglePopulation(int populationSize, int maxGenerations, const Vec3& holeCenter,
+                                 const SimConfig& config, int threads) {
+    auto start = std::chrono::steady_clock::now();
+
+    Swarm swarm(populationSize, config);
+    swarm.setVerbose(false);
+    swarm.setNumThreads(threads);
+    swarm.setHoleCenter(holeCenter);
+
+    const float targetDt = 1.0f / 60.0f;
+    while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < maxGenerations) {
+        swarm.update(targetDt);
+    }
+
+    IslandResult result;
+    result.solved = swarm.hasAnyDroneSucceeded();
+    result.island = -1;
+    result.generation = result.solved ? swarm.getGeneration() : -1;
+    result.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
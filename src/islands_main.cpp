@@ -0,0 +1,118 @@
+#include "island_model.h"
+#include "random_streams.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+
+// Island-model evolution: N worker processes exchanging genomes through
+// shared memory, compared with one population of the same total size, run
+// on one thread and on as many threads as there are islands.
+int main(int argc, char** argv) {
+    IslandConfig config;
+    int trials = 3;
+    bool baseline = true;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--islands" && i + 1 < argc) {
+            config.numIslands = std::stoi(argv[++i]);
+        } else if (arg == "--population" && i + 1 < argc) {
+            config.populationPerIsland = std::stoi(argv[++i]);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            config.migrationInterval = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--migrants" && i + 1 < argc) {
+            config.migrantsPerInterval = std::stoi(argv[++i]);
+        } else if (arg == "--topology" && i + 1 < argc) {
+            if (!parseTopology(argv[++i], config.topology)) {
+                std::cerr << "Неизвестная топология: " << argv[i] << " (none/ring/full)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--max-generations" && i + 1 < argc) {
+            config.maxGenerations = std::stoi(argv[++i]);
+        } else if (arg == "--trials" && i + 1 < argc) {
+            trials = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.sim.seed = std::stoull(argv[++i]);
+        } else if (arg == "--no-baseline") {
+            baseline = false;
+        } else if (arg == "--set" && i + 1 < argc) {
+            std::string assignment = argv[++i];
+            size_t eq = assignment.find('=');
+            if (eq == std::string::npos ||
+                !config.sim.set(assignment.substr(0, eq), assignment.substr(eq + 1))) {
+                std::cerr << "Неверный параметр: " << assignment << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "Использование: nndrons_islands [--islands N] [--population P] [--interval G]\n"
+                      << "  [--migrants K] [--topology none|ring|full] [--max-generations G]\n"
+                      << "  [--trials T] [--no-baseline] [--seed S] [--set name=value]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::cout << "Острова: " << config.numIslands << " x " << config.populationPerIsland
+              << " дронов, топология " << topologyName(config.topology)
+              << ", миграция каждые " << config.migrationInterval << " поколений, top-"
+              << config.migrantsPerInterval << std::endl;
+
+    uint64_t masterSeed = config.sim.seed ? config.sim.seed : randomMasterSeed();
+    std::cout << "Seed: " << masterSeed << std::endl;
+    std::mt19937 rng(deriveSeed32(masterSeed, SeedStream::Environment, 0));
+    std::uniform_real_distribution<float> holeDist(-10.0f, 10.0f);
+
+    float islandTime = 0.0f, baselineTime = 0.0f, threadedTime = 0.0f;
+    int islandSolved = 0, baselineSolved = 0, threadedSolved = 0;
+
+    for (int t = 0; t < trials; t++) {
+        // Both runs chase the same hole
+        Vec3 hole(holeDist(rng), holeDist(rng), 0.0f);
+        IslandConfig trialConfig = config;
+        trialConfig.sim.seed = deriveSeed(masterSeed, SeedStream::Trial, t);
+
+        IslandResult islands = runIslands(trialConfig, hole);
+        islandTime += islands.seconds;
+        islandSolved += islands.solved;
+
+        std::cout << "Запуск " << t << " | дыра (" << std::fixed << std::setprecision(1)
+                  << hole.x << ", " << hole.y << ") | острова: "
+                  << (islands.solved ? "решено" : "не решено") << " за " << std::setprecision(2)
+                  << islands.seconds << "с (остров " << islands.island
+                  << ", поколение " << islands.generation << ")";
+
+        if (baseline) {
+            IslandResult single = runSinglePopulation(
+                config.numIslands * config.populationPerIsland, config.maxGenerations, hole, trialConfig.sim);
+            baselineTime += single.seconds;
+            baselineSolved += single.solved;
+            std::cout << " | одна популяция: " << (single.solved ? "решено" : "не решено")
+                      << " за " << single.seconds << "с (поколение " << single.generation << ")";
+
+            // Same cores as the islands: one thread per island
+            IslandResult threaded = runSinglePopulation(config.numIslands * config.populationPerIsland,
+                                                        config.maxGenerations, hole, trialConfig.sim,
+                                                        config.numIslands);
+            threadedTime += threaded.seconds;
+            threadedSolved += threaded.solved;
+            std::cout << " | " << config.numIslands << " потоков: " << (threaded.solved ? "решено" : "не решено")
+                      << " за " << threaded.seconds << "с (поколение " << threaded.generation << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "Острова: решено " << islandSolved << "/" << trials
+              << ", среднее время " << std::setprecision(2) << islandTime / trials << "с" << std::endl;
+    if (baseline) {
+        std::cout << "Одна популяция, 1 поток: решено " << baselineSolved << "/" << trials
+                  << ", среднее время " << baselineTime / trials << "с" << std::endl;
+        std::cout << "Одна популяция, " << config.numIslands << " потоков: решено " << threadedSolved << "/"
+                  << trials << ", среднее время " << threadedTime / trials << "с" << std::endl;
+        if (threadedTime > 0.0f) {
+            std::cout << "Острова против одной популяции на тех же ядрах: " << threadedTime / islandTime
+                      << "x по времени" << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "lz_codec.h"
+#include <cstring>
+
+static const size_t minMatch = 4;
+static const size_t lastLiterals = 5;   // The block always ends with literals
+static const size_t matchLimit = 12;    // No match starts in the last 12 bytes
+static const size_t maxOffset = 65535;
+static const int hashBits = 12;
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - hashBits);
+}
+
+// 15 in the token, then 255s and the remainder
+static uint8_t* writeLength(uint8_t* op, size_t length) {
+    for (length -= 15; length >= 255; length -= 255) {
+        *op++ = 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+size_t lzCompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t lzCompress(const uint8_t* in, size_t size, uint8_t* out) {
+    uint8_t* op = out;
+    size_t anchor = 0;
+
+    if (size > matchLimit) {
+        uint32_t table[1 << hashBits] = {};
+        const size_t limit = size - matchLimit;
+        size_t pos = 0;
+        while (pos < limit) {
+            uint32_t sequence = read32(in + pos);
+            uint32_t hash = hashSequence(sequence);
+            size_t candidate = table[hash];
+            table[hash] = (uint32_t)pos;
+            if (candidate >= pos || pos - candidate > maxOffset || read32(in + candidate) != sequence) {
+                // Skip faster through data that doesn't compress
+                pos += 1 + ((pos - anchor) >> 6);
+                continue;
+            }
+
+            size_t end = pos + minMatch;
+            const size_t maxEnd = size - lastLiterals;
+            while (end < maxEnd && in[end] == in[candidate + end - pos]) {
+                end++;
+            }
+
+            size_t literals = pos - anchor;
+            size_t matchLength = end - pos - minMatch;
+            uint8_t* token = op++;
+            *token = (uint8_t)(((literals < 15 ? literals : 15) << 4) | (matchLength < 15 ? matchLength : 15));
+            if (literals >= 15) {
+                op = writeLength(op, literals);
+            }
+            std::memcpy(op, in + anchor, literals);
+            op += literals;
+            size_t offset = pos - candidate;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            if (matchLength >= 15) {
+                op = writeLength(op, matchLength);
+            }
+            pos = end;
+            anchor = pos;
+        }
+    }
+
+    // Last literals: token without a match
+    size_t literals = size - anchor;
+    *op++ = (uint8_t)((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) {
+        op = writeLength(op, literals);
+    }
+    std::memcpy(op, in + anchor, literals);
+    op += literals;
+    return op - out;
+}
+
+// Adds the 255-run extension of a length; false past the end of the input
+static bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+bool lzDecompress(const uint8_t* in, size_t size, uint8_t* out, size_t outSize) {
+    const uint8_t* ip = in;
+    const uint8_t* const end = in + size;
+    uint8_t* op = out;
+    uint8_t* const outEnd = out + outSize;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(ip, end, literals)) {
+            return false;
+        }
+        if (literals > (size_t)(end - ip) || literals > (size_t)(outEnd - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == end) {
+            break;  // Last literals
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(ip, end, length)) {
+            return false;
+        }
+        length += minMatch;
+        if (offset == 0 || offset > (size_t)(op - out) || length > (size_t)(outEnd - op)) {
+            return false;
+        }
+        const uint8_t* match = op - offset;
+        if (offset >= length) {
+            std::memcpy(op, match, length);
+            op += length;
+        } else {
+            for (size_t i = 0; i < length; i++) {  // Overlapping: repeats the last offset bytes
+                *op++ = match[i];
+            }
+        }
+    }
+    return op == outEnd;
+}
+
+void shuffleBytes(const uint8_t* in, size_t count, size_t elementSize, uint8_t* out) {
+    for (size_t b = 0; b < elementSize; b++) {
+        for (size_t i = 0; i < count; i++) {
+            out[b * count + i] = in[i * elementSize + b];
+        }
+    }
+}
+
+void unshuffleBytes(const uint8_t* in, size_t count, size_t elementSize, uint8_t* out) {
+    for (size_t b = 0; b < elementSize; b++) {
+        for (size_t i = 0; i < count; i++) {
+            out[i * elementSize + b] = in[b * count + i];
+        }
+    }
+}
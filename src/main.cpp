@@ -1,105 +1,428 @@
 #include "renderer.h"
 #include "swarm.h"
+#include "swarm_snapshot.h"
+#include "trace.h"
+#include "metrics_log.h"
+#include "episode_log.h"
+#include "random_streams.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <filesystem>
+
+// Run a swarm without a window until a drone finds the hole.
+// Returns the generation of the first success, or -1 if maxGenerations ran out.
+static int runHeadless(Swarm& swarm, int maxGenerations) {
+    const float targetDt = 1.0f / 60.0f;
+    while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < maxGenerations) {
+        swarm.update(targetDt);
+    }
+    return swarm.hasAnyDroneSucceeded() ? swarm.getGeneration() : -1;
+}
+
+// Generations-to-success: novelty search vs the fitness-only baseline
+static void compareNovelty(int numDrones, const SimConfig& config, int trials, int maxGenerations) {
+    std::cout << "Сравнение: только fitness vs fitness + novelty ("
+              << trials << " запусков, максимум " << maxGenerations << " поколений)" << std::endl;
+
+    int solved[2] = {0, 0};
+    long totalGenerations[2] = {0, 0};
+
+    // Both modes of a trial start from the same seed
+    uint64_t masterSeed = config.seed ? config.seed : randomMasterSeed();
+    std::cout << "Seed: " << masterSeed << std::endl;
+
+    for (int t = 0; t < trials; t++) {
+        SimConfig trialConfig = config;
+        trialConfig.seed = deriveSeed(masterSeed, SeedStream::Trial, t);
+
+        int result[2];
+        for (int mode = 0; mode < 2; mode++) {
+            Swarm swarm(numDrones, trialConfig);
+            swarm.setVerbose(false);
+            swarm.enableNoveltySearch(mode == 1);
+            result[mode] = runHeadless(swarm, maxGenerations);
+            if (result[mode] >= 0) {
+                solved[mode]++;
+                totalGenerations[mode] += result[mode];
+            }
+        }
+        std::cout << "  Запуск " << std::setw(3) << t
+                  << " | fitness: " << std::setw(5) << result[0]
+                  << " | novelty: " << std::setw(5) << result[1] << std::endl;
+    }
+
+    const char* names[2] = {"fitness", "novelty"};
+    for (int mode = 0; mode < 2; mode++) {
+        std::cout << names[mode] << ": решено " << solved[mode] << "/" << trials;
+        if (solved[mode] > 0) {
+            std::cout << ", среднее поколений до успеха: " << std::fixed << std::setprecision(1)
+                      << (float)totalGenerations[mode] / solved[mode];
+        }
+        std::cout << std::endl;
+    }
+}
+
+// Simulation thread for the viewer: steps the swarm at `speed` x real time
+// (flat-out when speed <= 0) and publishes snapshots for the render thread.
+// Training never waits for a frame to be drawn.
+static void runSimulation(Swarm& swarm, SnapshotBuffer& snapshots, std::atomic<bool>& stop,
+                          float speed, const std::string& networkFile) {
+    using Clock = std::chrono::steady_clock;
+    const float targetDt = 1.0f / 60.0f;
+    Trace::setThreadName("simulation");
+    // No point publishing faster than the display can show
+    const auto publishInterval = std::chrono::milliseconds(8);
+
+    auto stepDuration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(speed > 0.0f ? targetDt / speed : 0.0f));
+    auto nextStep = Clock::now();
+    auto lastPublish = Clock::time_point();
+    int lastGeneration = swarm.getGeneration();
+
+    while (!stop) {
+        swarm.update(targetDt);
+        bool succeeded = swarm.hasAnyDroneSucceeded();
+
+        // Auto-save every 10 generations
+        if (swarm.getGeneration() != lastGeneration) {
+            lastGeneration = swarm.getGeneration();
+            if (lastGeneration % 10 == 0) {
+                swarm.saveBestNetwork(networkFile);
+                std::cout << "  [Автосохранение лучшей нейросети]" << std::endl;
+            }
+        }
+
+        auto now = Clock::now();
+        if (succeeded || now - lastPublish >= publishInterval) {
+            snapshots.beginWrite().capture(swarm);
+            snapshots.publish();
+            lastPublish = now;
+        }
+
+        if (succeeded) {
+            break; // Exit immediately when one drone finds the hole!
+        }
+
+        if (speed > 0.0f) {
+            nextStep += stepDuration;
+            if (nextStep < now) {
+                nextStep = now; // Fell behind - don't try to catch up in a burst
+            }
+            std::this_thread::sleep_until(nextStep);
+        }
+    }
+}
+
+// Memory per genome and checkpoint size: seed-chain genomes vs full parameters
+static void genomeReport(Swarm& swarm, int maxGenerations) {
+    // Snapshot the population at the start of every generation: a success applies a
+    // gradient step that can't be expressed as a seed chain, so report the last
+    // generation before it
+    const float targetDt = 1.0f / 60.0f;
+    std::vector<Genome> genomes;
+    std::vector<uint64_t> networkHashes;
+    int snapshotGeneration = -1;
+
+    while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < maxGenerations) {
+        if (swarm.getGeneration() != snapshotGeneration) {
+            snapshotGeneration = swarm.getGeneration();
+            genomes = swarm.getGenomes();
+            networkHashes.clear();
+            for (const auto& network : swarm.getNetworks()) {
+                networkHashes.push_back(network->hashParameters());
+            }
+        }
+        swarm.update(targetDt);
+    }
+
+    const auto& networks = swarm.getNetworks();
+    if (genomes.empty()) {
+        std::cout << "Геномы недоступны (сеть была загружена)" << std::endl;
+        return;
+    }
+
+    // Unique lineage nodes reachable from the population
+    std::unordered_set<const void*> nodes;
+    size_t maxDepth = 0;
+    for (const auto& genome : genomes) {
+        maxDepth = std::max<size_t>(maxDepth, genome.getDepth());
+        for (Genome g = genome; g.isValid() && nodes.insert(g.getNodeId()).second; g = g.getParent()) {
+        }
+    }
+
+    size_t n = genomes.size();
+    const auto& layerSizes = swarm.getLayerSizes();
+    size_t numLayers = layerSizes.size();
+    size_t params = networks[0]->getParameterCount();
+
+    // In-memory: NeuralNetwork object + its vectors of Eigen matrices + shared_ptr control block
+    size_t fullBytes = sizeof(NeuralNetwork) + numLayers * sizeof(int)
+                       + (numLayers - 1) * (sizeof(Eigen::MatrixXf) + sizeof(Eigen::VectorXf))
+                       + params * sizeof(float) + 2 * sizeof(long);
+    double compactBytes = sizeof(Genome) + (double)nodes.size() * Genome::getNodeBytes() / n;
+
+    // Checkpoints: NeuralNetwork::save format per genome vs compact lineage file
+    size_t fullFileBytes = n * (sizeof(size_t) + numLayers * sizeof(int)
+                                + (numLayers - 1) * 3 * sizeof(int) + params * sizeof(float));
+    std::string checkpointFile = "genomes.ckpt";
+    saveGenomes(checkpointFile, layerSizes, genomes, swarm.getConfig().seed);
+    size_t compactFileBytes = std::filesystem::file_size(checkpointFile);
+
+    // Every genome must materialize to exactly the live network
+    GenomeMaterializer materializer(layerSizes);
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t matches = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (materializer.materialize(genomes[i]).hashParameters() == networkHashes[i]) {
+            matches++;
+        }
+    }
+    float materializeUs = std::chrono::duration<float, std::micro>(
+        std::chrono::high_resolution_clock::now() - start).count() / n;
+
+    std::cout << "Поколение " << snapshotGeneration << ", геномов " << n
+              << ", параметров в сети " << params << std::endl;
+    std::cout << "Узлов родословной: " << nodes.size() << " (макс. глубина " << maxDepth << ")" << std::endl;
+    std::cout << "Память на геном: полные параметры " << fullBytes << " Б, seed-цепочка "
+              << std::fixed << std::setprecision(1) << compactBytes << " Б" << std::endl;
+    std::cout << "Чекпоинт: полные параметры " << fullFileBytes << " Б, seed-цепочка "
+              << compactFileBytes << " Б (" << checkpointFile << ")" << std::endl;
+    std::cout << "Материализация: " << matches << "/" << n << " совпадают, "
+              << std::setprecision(2) << materializeUs << " мкс/геном, кэш попаданий "
+              << materializer.getCacheHits() << "/" << n << std::endl;
+}
 
 int main(int argc, char** argv) {
     std::cout << "=== Дроны с Нейросетями - Симуляция Поиска Дыры ===" << std::endl;
     std::cout << "Управление:" << std::endl;
     std::cout << "  Стрелки: Вращение камеры" << std::endl;
     std::cout << "  W/S: Приближение/отдаление" << std::endl;
+    std::cout << "  T: Следы траекторий" << std::endl;
+    std::cout << "  H: Панель производительности" << std::endl;
+    std::cout << "  P: Сохранить трассировку (с --trace)" << std::endl;
     std::cout << "  ESC: Выход" << std::endl;
     std::cout << "========================================================" << std::endl;
 
-    // Create swarm with 100 drones for better learning
+    // Swarm of 100 drones for better learning
     int numDrones = 100;
-    Swarm swarm(numDrones);
+    SimConfig config;
 
     // Check if we should load a saved network
     bool loadNetwork = false;
+    bool novelty = false;
+    bool fitnessCache = true;
+    bool headless = false;
+    int compareTrials = 0;
+    bool genomeReportMode = false;
+    int maxGenerations = 500;
+    float speed = 1.0f;
+    int trailLength = 60;
     std::string networkFile = "best_network.bin";
+    std::string traceFile;
+    std::string metricsFile;
+    std::string episodeFile;
+    EpisodeRecorder::Options episodeOptions;
 
-    if (argc > 1) {
-        std::string arg = argv[1];
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
         if (arg == "--load" || arg == "-l") {
             loadNetwork = true;
-            std::cout << "Загрузка сохранённой нейросети из " << networkFile << std::endl;
-            swarm.loadNetwork(networkFile);
+        } else if (arg == "--novelty") {
+            novelty = true;
+        } else if (arg == "--no-fitness-cache") {
+            fitnessCache = false;
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--compare-novelty" && i + 1 < argc) {
+            compareTrials = std::stoi(argv[++i]);
+        } else if (arg == "--genome-report") {
+            genomeReportMode = true;
+        } else if (arg == "--max-generations" && i + 1 < argc) {
+            maxGenerations = std::stoi(argv[++i]);
+        } else if (arg == "--speed" && i + 1 < argc) {
+            // Simulation speed multiplier for the viewer (0 = as fast as possible)
+            speed = std::stof(argv[++i]);
+        } else if (arg == "--trail-length" && i + 1 < argc) {
+            // Samples per drone trail (one per rendered simulation update)
+            trailLength = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            // Master seed: the same seed replays the same run
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--drones" && i + 1 < argc) {
+            numDrones = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-log" && i + 1 < argc) {
+            // Per-generation records: .csv, .jsonl or .bin
+            metricsFile = argv[++i];
+        } else if (arg == "--episode-log" && i + 1 < argc) {
+            // Every step of every drone, columnar (read with nndrons_episodes)
+            episodeFile = argv[++i];
+        } else if (arg == "--episode-lz") {
+            episodeOptions.compress = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            // Chrome trace-event JSON, written at exit (and on P in the viewer)
+            traceFile = argv[++i];
+        } else if (arg == "--set" && i + 1 < argc) {
+            // Runtime parameter override: --set mutationRate=0.1
+            std::string assignment = argv[++i];
+            size_t eq = assignment.find('=');
+            if (eq == std::string::npos ||
+                !config.set(assignment.substr(0, eq), assignment.substr(eq + 1))) {
+                std::cerr << "Неверный параметр: " << assignment << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    if (!traceFile.empty()) {
+        if (Trace::compiledIn()) {
+            Trace::setEnabled(true);
+            Trace::setThreadName("main");
+        } else {
+            std::cerr << "Трассировка отключена при сборке (cmake -DNNDRONS_TRACE=ON)" << std::endl;
+            traceFile.clear();
+        }
+    }
+
+    if (compareTrials > 0) {
+        compareNovelty(numDrones, config, compareTrials, maxGenerations);
+        return 0;
+    }
+
+    // Generation reports: written and printed off the simulation thread
+    MetricsLog metricsLog(metricsFile);
+    if (!metricsLog.isOpen()) {
+        return -1;
+    }
+    metricsLog.subscribe(makeConsoleReporter(1.0f));
+
+    Swarm swarm(numDrones, config);
+    swarm.enableNoveltySearch(novelty);
+    swarm.enableFitnessCache(fitnessCache);
+    swarm.setMetricsLog(&metricsLog);
+    std::cout << "Seed: " << swarm.getConfig().seed << std::endl;
+
+    std::unique_ptr<EpisodeRecorder> episodeRecorder;
+    if (!episodeFile.empty()) {
+        episodeRecorder.reset(new EpisodeRecorder(episodeFile, episodeOptions, swarm.getConfig().seed));
+        if (!episodeRecorder->isOpen()) {
+            return -1;
+        }
+        swarm.setEpisodeRecorder(episodeRecorder.get());
+    }
+
+    if (genomeReportMode) {
+        swarm.setVerbose(false);
+        genomeReport(swarm, maxGenerations);
+        return 0;
+    }
+
+    if (loadNetwork) {
+        std::cout << "Загрузка сохранённой нейросети из " << networkFile << std::endl;
+        if (!swarm.loadNetwork(networkFile)) {
+            return -1;
         }
     }
 
+    if (headless) {
+        int result = runHeadless(swarm, maxGenerations);
+        metricsLog.flush();
+        std::cout << "Поколений до успеха: " << result << std::endl;
+        std::cout << "Кэш fitness: попаданий " << swarm.getFitnessCache().getHits()
+                  << ", промахов " << swarm.getFitnessCache().getMisses() << std::endl;
+        swarm.saveBestNetwork(networkFile);
+        if (!traceFile.empty()) {
+            Trace::writeChromeJson(traceFile);
+        }
+        return 0;
+    }
+
     // Create renderer
     Renderer renderer(800, 600);
     if (!renderer.init()) {
         std::cerr << "Ошибка инициализации рендерера" << std::endl;
         return -1;
     }
+    renderer.setTrailLength(trailLength);
 
     std::cout << "Запуск симуляции..." << std::endl;
 
-    // Main loop
+    // Simulation runs on its own thread and hands frames over through the triple buffer
+    SnapshotBuffer snapshots;
+    std::atomic<bool> stopSimulation(false);
+    std::thread simulationThread(runSimulation, std::ref(swarm), std::ref(snapshots),
+                                 std::ref(stopSimulation), speed, networkFile);
+
+    // Wait for the first frame
+    while (!snapshots.acquire()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
     auto lastTime = std::chrono::high_resolution_clock::now();
     int frameCount = 0;
     float fpsTimer = 0.0f;
+    long long lastSteps = snapshots.latest().simulatedSteps;
+    bool traceKeyDown = false;
 
-    // Fixed timestep for stable simulation
-    const float targetDt = 1.0f / 60.0f; // 60 FPS target
-
-    while (!renderer.shouldClose() && !swarm.hasAnyDroneSucceeded()) {
-        // Calculate delta time
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float dt = std::chrono::duration<float>(currentTime - lastTime).count();
-        lastTime = currentTime;
-
-        // Cap dt to prevent huge jumps
-        if (dt > 0.1f) {
-            dt = 0.1f;
-        }
+    while (!renderer.shouldClose() && !snapshots.latest().succeeded) {
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        float dt = std::chrono::duration<float>(frameStart - lastTime).count();
+        lastTime = frameStart;
 
         // Process input
         renderer.processInput();
 
-        // Update swarm with fixed timestep (full speed now!)
-        swarm.update(targetDt); // Run at normal speed - faster training!
-
-        // Check if any drone succeeded right after update (don't wait for next iteration!)
-        if (swarm.hasAnyDroneSucceeded()) {
-            break; // Exit immediately when one drone finds the hole!
+        // Dump the trace rings so far without stopping anything
+        bool traceKey = glfwGetKey(renderer.getWindow(), GLFW_KEY_P) == GLFW_PRESS;
+        if (traceKey && !traceKeyDown && !traceFile.empty()) {
+            Trace::writeChromeJson(traceFile);
         }
+        traceKeyDown = traceKey;
 
-        // Render
-        renderer.render(swarm);
+        // Render whatever the simulation published last
+        snapshots.acquire();
+        const SwarmSnapshot& snapshot = snapshots.latest();
+        renderer.render(snapshot);
 
-        // Sleep to maintain ~60 FPS and make simulation visible
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        // Frame cap in case vsync is unavailable - keep the CPU for the simulation
+        std::this_thread::sleep_until(frameStart + std::chrono::milliseconds(16));
 
         // FPS counter and status display
         frameCount++;
         fpsTimer += dt;
         if (fpsTimer >= 1.0f) {
-            float episodeTime = swarm.getEpisodeTime();
-            float maxTime = swarm.getMaxEpisodeTime();
-            int timePercent = (int)((episodeTime / maxTime) * 100.0f);
-
-            std::cout << "Поколение: " << std::setw(4) << swarm.getGeneration()
-                      << " | Время: " << std::fixed << std::setprecision(1) << std::setw(4) << episodeTime
-                      << "с/" << std::setw(4) << maxTime << "с (" << std::setw(3) << timePercent << "%)"
-                      << " | Лучший результат: " << std::setw(6) << std::setprecision(0) << swarm.getBestFitness()
+            int timePercent = (int)((snapshot.episodeTime / snapshot.maxEpisodeTime) * 100.0f);
+            long long stepsPerSecond = (long long)((snapshot.simulatedSteps - lastSteps) / fpsTimer);
+            lastSteps = snapshot.simulatedSteps;
+
+            std::cout << "Поколение: " << std::setw(4) << snapshot.generation
+                      << " | Время: " << std::fixed << std::setprecision(1) << std::setw(4) << snapshot.episodeTime
+                      << "с/" << std::setw(4) << snapshot.maxEpisodeTime << "с (" << std::setw(3) << timePercent << "%)"
+                      << " | Лучший результат: " << std::setw(6) << std::setprecision(0) << snapshot.bestFitness
                       << " | FPS: " << frameCount
+                      << " | Шагов/с: " << stepsPerSecond
                       << std::endl;
+
+            const Renderer::RenderStats& stats = renderer.getStats();
+            std::cout << "  Дроны: отсечено " << stats.culled
+                      << " | LOD полный/средний/низкий/точки: " << stats.drawn[Renderer::LodHigh]
+                      << "/" << stats.drawn[Renderer::LodMedium] << "/" << stats.drawn[Renderer::LodLow]
+                      << "/" << stats.drawn[Renderer::LodPoint] << std::endl;
             frameCount = 0;
             fpsTimer = 0.0f;
-
-            // Auto-save every 10 generations
-            if (swarm.getGeneration() % 10 == 0 && swarm.getGeneration() > 0) {
-                swarm.saveBestNetwork(networkFile);
-                std::cout << "  [Автосохранение лучшей нейросети]" << std::endl;
-            }
         }
     }
 
+    stopSimulation = true;
+    simulationThread.join();
+
+    metricsLog.flush();
+
     // If a drone succeeded, show victory screen for a few seconds
     if (swarm.hasAnyDroneSucceeded()) {
         std::cout << "\n🎉🎉🎉 УСПЕХ! ДРОН ПРОШЁЛ ЧЕРЕЗ ДЫРУ! 🎉🎉🎉" << std::endl;
@@ -108,9 +431,14 @@ int main(int argc, char** argv) {
         // Change window title to show success!
         renderer.setWindowTitle("🎉🎉🎉 УСПЕХ! ДРОН НАШЁЛ ДЫРУ! 🎉🎉🎉");
 
+        // The simulation has stopped - publish its final state for the victory screen
+        snapshots.beginWrite().capture(swarm);
+        snapshots.publish();
+        snapshots.acquire();
+
         // Keep rendering for 5 seconds to see the success
         for (int i = 0; i < 5 * 60; i++) { // 5 seconds at 60 FPS
-            renderer.render(swarm);
+            renderer.render(snapshots.latest());
             std::this_thread::sleep_for(std::chrono::milliseconds(16));
         }
     }
@@ -122,5 +450,9 @@ int main(int argc, char** argv) {
     std::cout << "Симуляция завершена. Финальное поколение: " << swarm.getGeneration() << std::endl;
     std::cout << "Лучший результат: " << swarm.getBestFitness() << std::endl;
 
+    if (!traceFile.empty()) {
+        Trace::writeChromeJson(traceFile);
+    }
+
     return 0;
 }
@@ -0,0 +1,24 @@
+#include "metrics.h"
+
+std::atomic<bool> Metrics::enabledFlag(false);
+std::atomic<uint64_t> Metrics::zoneTimes[Metrics::zoneCount];
+std::atomic<uint64_t> Metrics::allocations(0);
+
+void Metrics::collect(uint64_t times[zoneCount], uint64_t& allocationCount) {
+    for (int i = 0; i < zoneCount; i++) {
+        times[i] = zoneTimes[i].exchange(0, std::memory_order_relaxed);
+    }
+    allocationCount = allocations.exchange(0, std::memory_order_relaxed);
+}
+
+const char* Metrics::zoneName(MetricZone zone) {
+    switch (zone) {
+        case MetricZone::Sensors: return "SENSORS";
+        case MetricZone::Inference: return "INFERENCE";
+        case MetricZone::Physics: return "PHYSICS";
+        case MetricZone::Reward: return "REWARD";
+        case MetricZone::Training: return "TRAINING";
+        case MetricZone::Render: return "RENDER";
+        default: return "?";
+    }
+}
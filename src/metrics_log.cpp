@@ -0,0 +1,218 @@
+#include "metrics_log.h"
+#include "trace.h"
+#include <chrono>
+#include <iostream>
+
+static const char binaryMagic[8] = {'N', 'N', 'D', 'M', 'L', 'O', 'G', '2'};
+
+const char* GenerationRecord::outcomeName(int32_t outcome) {
+    switch (outcome) {
+        case Timeout: return "timeout";
+        case AllInactive: return "all_inactive";
+        case Success: return "success";
+    }
+    return "unknown";
+}
+
+MetricsLogFormat metricsLogFormatFromPath(const std::string& path) {
+    auto endsWith = [&](const std::string& suffix) {
+        return path.size() >= suffix.size() &&
+               path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    if (endsWith(".jsonl") || endsWith(".json")) {
+        return MetricsLogFormat::JSONL;
+    }
+    if (endsWith(".bin")) {
+        return MetricsLogFormat::Binary;
+    }
+    return MetricsLogFormat::CSV;
+}
+
+MetricsLog::MetricsLog(const std::string& path, size_t requestedCapacity)
+    : capacity(1), enqueuePos(0), handled(0), dropped(0), dequeuePos(0),
+      format(metricsLogFormatFromPath(path)), file(nullptr), open(true), stopping(false) {
+    // Power of two so positions map to slots with a mask
+    while (capacity < requestedCapacity) {
+        capacity <<= 1;
+    }
+    slots.reset(new Slot[capacity]);
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    if (!path.empty()) {
+        file = std::fopen(path.c_str(), format == MetricsLogFormat::Binary ? "wb" : "w");
+        if (!file) {
+            std::cerr << "Ошибка открытия журнала метрик: " << path << std::endl;
+            open = false;
+        } else if (format == MetricsLogFormat::Binary) {
+            uint32_t recordSize = sizeof(GenerationRecord);
+            std::fwrite(binaryMagic, 1, sizeof(binaryMagic), file);
+            std::fwrite(&recordSize, sizeof(recordSize), 1, file);
+        } else if (format == MetricsLogFormat::CSV) {
+            std::fprintf(file, "generation,outcome,drones,successes,collisions,out_of_bounds,cached,"
+                               "episode_s,wall_s,best,mean,p10,median,p90,steps_per_s,seed\n");
+        }
+    }
+
+    thread = std::thread(&MetricsLog::run, this);
+}
+
+MetricsLog::~MetricsLog() {
+    stopping.store(true);
+    thread.join();
+
+    if (file) {
+        std::fclose(file);
+    }
+    if (getDropped() > 0) {
+        std::cerr << "Журнал метрик: пропущено записей " << getDropped() << " (очередь переполнена)" << std::endl;
+    }
+}
+
+void MetricsLog::subscribe(Subscriber subscriber) {
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    subscribers.push_back(std::move(subscriber));
+}
+
+bool MetricsLog::push(const GenerationRecord& record) {
+    const size_t mask = capacity - 1;
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[pos & mask];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = (int64_t)sequence - (int64_t)pos;
+        if (diff == 0) {
+            // Slot is free for this lap - claim the position
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Writer thread is a full lap behind
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->record = record;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool MetricsLog::pop(GenerationRecord& record) {
+    Slot& slot = slots[dequeuePos & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(dequeuePos + capacity, std::memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+void MetricsLog::flush() {
+    uint64_t target = enqueuePos.load(std::memory_order_acquire);
+    while (handled.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void MetricsLog::run() {
+    Trace::setThreadName("metrics log");
+
+    GenerationRecord record;
+    while (true) {
+        bool any = false;
+        while (pop(record)) {
+            TRACE_SCOPE("MetricsLog::write");
+            write(record);
+            {
+                std::lock_guard<std::mutex> lock(subscribersMutex);
+                for (auto& subscriber : subscribers) {
+                    subscriber(record);
+                }
+            }
+            handled.fetch_add(1, std::memory_order_release);
+            any = true;
+        }
+
+        if (any && file) {
+            std::fflush(file);  // Whole records only, so the log can be tailed
+        }
+
+        // Producers are done once stopping is set; exit when nothing is in flight
+        if (stopping.load() && handled.load() == enqueuePos.load()) {
+            return;
+        }
+
+        // Generations take milliseconds at best - polling keeps push() free of syscalls
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void MetricsLog::write(const GenerationRecord& r) {
+    if (!file) {
+        return;
+    }
+
+    switch (format) {
+        case MetricsLogFormat::Binary:
+            std::fwrite(&r, sizeof(r), 1, file);
+            break;
+        case MetricsLogFormat::CSV:
+            std::fprintf(file, "%d,%s,%d,%d,%d,%d,%d,%.3f,%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%.0f,%llu\n",
+                         r.generation, GenerationRecord::outcomeName(r.outcome), r.drones,
+                         r.successes, r.collisions, r.outOfBounds, r.cached, r.episodeSeconds,
+                         r.wallSeconds, r.bestFitness, r.meanFitness, r.p10Fitness,
+                         r.medianFitness, r.p90Fitness, r.stepsPerSecond, (unsigned long long)r.seed);
+            break;
+        case MetricsLogFormat::JSONL:
+            std::fprintf(file, "{\"generation\":%d,\"outcome\":\"%s\",\"drones\":%d,\"successes\":%d,"
+                               "\"collisions\":%d,\"out_of_bounds\":%d,\"cached\":%d,\"episode_s\":%.3f,"
+                               "\"wall_s\":%.4f,\"best\":%.3f,\"mean\":%.3f,\"p10\":%.3f,\"median\":%.3f,"
+                               "\"p90\":%.3f,\"steps_per_s\":%.0f,\"seed\":%llu}\n",
+                         r.generation, GenerationRecord::outcomeName(r.outcome), r.drones,
+                         r.successes, r.collisions, r.outOfBounds, r.cached, r.episodeSeconds,
+                         r.wallSeconds, r.bestFitness, r.meanFitness, r.p10Fitness,
+                         r.medianFitness, r.p90Fitness, r.stepsPerSecond, (unsigned long long)r.seed);
+            break;
+    }
+}
+
+MetricsLog::Subscriber makeConsoleReporter(float intervalSeconds) {
+    using Clock = std::chrono::steady_clock;
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(intervalSeconds));
+    auto lastPrint = std::make_shared<Clock::time_point>();
+    auto skipped = std::make_shared<int>(0);
+
+    return [=](const GenerationRecord& r) {
+        auto now = Clock::now();
+        if (r.outcome != GenerationRecord::Success && now - *lastPrint < interval) {
+            (*skipped)++;
+            return;
+        }
+        *lastPrint = now;
+
+        char line[512];
+        if (r.outcome == GenerationRecord::Success) {
+            std::snprintf(line, sizeof(line), "Поколение %d: УСПЕХ за %.1fс (дронов у цели: %d)",
+                          r.generation, r.episodeSeconds, r.successes);
+        } else {
+            std::snprintf(line, sizeof(line),
+                          "Поколение %d: %s %.1fс | лучший %.0f, средний %.0f, p90 %.0f | "
+                          "столкновений %d, вне зоны %d, из кэша %d | шагов/с %.0f",
+                          r.generation, r.outcome == GenerationRecord::Timeout ? "время вышло" : "все неактивны",
+                          r.episodeSeconds, r.bestFitness, r.meanFitness, r.p90Fitness,
+                          r.collisions, r.outOfBounds, r.cached, r.stepsPerSecond);
+        }
+        std::cout << line;
+        if (*skipped > 0) {
+            std::cout << " (пропущено поколений: " << *skipped << ")";
+            *skipped = 0;
+        }
+        std::cout << '\n' << std::flush;
+    };
+}
@@ -0,0 +1,233 @@
+#include "migration_ring.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <new>
+#include <iostream>
+
+static const uint32_t migrationMagic = 0x4D494752;  // "MIGR"
+
+struct alignas(64) MigrationRing::Header {
+    uint32_t magic;
+    uint32_t numIslands;
+    uint32_t slotsPerIsland;
+    uint32_t paramCount;
+    std::atomic<int32_t> solvedIsland;
+    std::atomic<uint32_t> solvedGeneration;
+};
+
+// One cache line per outbox so islands don't false-share their write indices
+struct alignas(64) MigrationRing::Outbox {
+    std::atomic<uint64_t> writeIndex;
+};
+
+// Followed by paramCount floats
+struct MigrationRing::Slot {
+    // 2p+1 while position p is being written, 2p+2 once complete
+    std::atomic<uint64_t> sequence;
+    uint32_t sourceIsland;
+    uint32_t generation;
+    float fitness;
+    uint32_t reserved;
+
+    float* params() { return reinterpret_cast<float*>(this + 1); }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Shared-memory migration needs address-free 64-bit atomics");
+
+size_t MigrationRing::computeSlotBytes(int paramCount) {
+    size_t bytes = sizeof(Slot) + paramCount * sizeof(float);
+    return (bytes + 63) / 64 * 64;
+}
+
+size_t MigrationRing::computeTotalBytes(int numIslands, int slotsPerIsland, int paramCount) {
+    return sizeof(Header) + numIslands * sizeof(Outbox)
+           + (size_t)numIslands * slotsPerIsland * computeSlotBytes(paramCount);
+}
+
+MigrationRing::MigrationRing(const std::string& name, void* base, size_t mappedBytes, bool owner)
+    : name(name), base(base), mappedBytes(mappedBytes), owner(owner),
+      header(static_cast<Header*>(base)), slotBytes(computeSlotBytes(header->paramCount)) {
+}
+
+MigrationRing* MigrationRing::create(const std::string& name, int numIslands,
+                                     int slotsPerIsland, int paramCount) {
+    if (numIslands < 1 || slotsPerIsland < 1 || paramCount < 1) {
+        return nullptr;
+    }
+
+    shm_unlink(name.c_str());  // Drop a stale segment from a crashed run
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "Ошибка создания shared memory: " << name << std::endl;
+        return nullptr;
+    }
+
+    size_t bytes = computeTotalBytes(numIslands, slotsPerIsland, paramCount);
+    if (ftruncate(fd, bytes) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        std::cerr << "Ошибка выделения shared memory: " << bytes << " байт" << std::endl;
+        return nullptr;
+    }
+
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    Header* header = new (base) Header();
+    header->numIslands = numIslands;
+    header->slotsPerIsland = slotsPerIsland;
+    header->paramCount = paramCount;
+    header->solvedIsland.store(-1);
+    header->solvedGeneration.store(0);
+
+    char* outboxes = static_cast<char*>(base) + sizeof(Header);
+    for (int i = 0; i < numIslands; i++) {
+        new (outboxes + i * sizeof(Outbox)) Outbox{};
+    }
+
+    // Publish the magic last: attach() only trusts a fully initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = migrationMagic;
+
+    return new MigrationRing(name, base, bytes, true);
+}
+
+MigrationRing* MigrationRing::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "Ошибка подключения к shared memory: " << name << std::endl;
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+        close(fd);
+        return nullptr;
+    }
+
+    void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+
+    Header* header = static_cast<Header*>(base);
+    if (header->magic != migrationMagic ||
+        computeTotalBytes(header->numIslands, header->slotsPerIsland, header->paramCount) > (size_t)st.st_size) {
+        munmap(base, st.st_size);
+        std::cerr << "Неверный формат shared memory: " << name << std::endl;
+        return nullptr;
+    }
+
+    return new MigrationRing(name, base, st.st_size, false);
+}
+
+MigrationRing::~MigrationRing() {
+    munmap(base, mappedBytes);
+    if (owner) {
+        shm_unlink(name.c_str());
+    }
+}
+
+MigrationRing::Outbox* MigrationRing::outbox(int island) const {
+    char* p = static_cast<char*>(base) + sizeof(Header) + island * sizeof(Outbox);
+    return reinterpret_cast<Outbox*>(p);
+}
+
+MigrationRing::Slot* MigrationRing::slot(int island, uint64_t position) const {
+    size_t slotIdx = (size_t)island * header->slotsPerIsland + position % header->slotsPerIsland;
+    char* slots = static_cast<char*>(base) + sizeof(Header) + header->numIslands * sizeof(Outbox);
+    return reinterpret_cast<Slot*>(slots + slotIdx * slotBytes);
+}
+
+void MigrationRing::publish(int island, uint32_t generation, float fitness,
+                            const std::vector<float>& params) {
+    if (island < 0 || island >= (int)header->numIslands || params.size() != header->paramCount) {
+        return;
+    }
+
+    // Single writer per outbox: a relaxed load of our own index is enough
+    Outbox* box = outbox(island);
+    uint64_t position = box->writeIndex.load(std::memory_order_relaxed);
+    Slot* s = slot(island, position);
+
+    s->sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    s->sourceIsland = island;
+    s->generation = generation;
+    s->fitness = fitness;
+    std::memcpy(s->params(), params.data(), params.size() * sizeof(float));
+
+    s->sequence.store(2 * position + 2, std::memory_order_release);
+    box->writeIndex.store(position + 1, std::memory_order_release);
+}
+
+size_t MigrationRing::collect(int sourceIsland, uint64_t& cursor, std::vector<Migrant>& out) const {
+    if (sourceIsland < 0 || sourceIsland >= (int)header->numIslands) {
+        return 0;
+    }
+
+    uint64_t end = outbox(sourceIsland)->writeIndex.load(std::memory_order_acquire);
+    if (end - cursor > header->slotsPerIsland) {
+        cursor = end - header->slotsPerIsland;  // Older entries were overwritten
+    }
+
+    size_t collected = 0;
+    Migrant migrant;
+    migrant.params.resize(header->paramCount);
+
+    for (; cursor < end; cursor++) {
+        Slot* s = slot(sourceIsland, cursor);
+        uint64_t before = s->sequence.load(std::memory_order_acquire);
+        if (before != 2 * cursor + 2) {
+            continue;  // Being overwritten by a newer position
+        }
+
+        migrant.sourceIsland = s->sourceIsland;
+        migrant.generation = s->generation;
+        migrant.fitness = s->fitness;
+        std::memcpy(migrant.params.data(), s->params(), header->paramCount * sizeof(float));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->sequence.load(std::memory_order_relaxed) != before) {
+            continue;  // Torn read - the writer lapped us
+        }
+
+        out.push_back(migrant);
+        collected++;
+    }
+
+    return collected;
+}
+
+void MigrationRing::markSolved(int island, uint32_t generation) {
+    int32_t expected = -1;
+    if (header->solvedIsland.compare_exchange_strong(expected, island)) {
+        header->solvedGeneration.store(generation, std::memory_order_release);
+    }
+}
+
+int MigrationRing::getSolvedIsland() const {
+    return header->solvedIsland.load(std::memory_order_acquire);
+}
+
+uint32_t MigrationRing::getSolvedGeneration() const {
+    return header->solvedGeneration.load(std::memory_order_acquire);
+}
+
+int MigrationRing::getNumIslands() const {
+    return header->numIslands;
+}
+
+int MigrationRing::getParamCount() const {
+    return header->paramCount;
+}
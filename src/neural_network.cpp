@@ -1,16 +1,31 @@
 #include "neural_network.h"
+#include "arena.h"
 #include <random>
 #include <fstream>
 #include <iostream>
+#include <algorithm>
 
 NeuralNetwork::NeuralNetwork(const std::vector<int>& layerSizes)
-    : layerSizes(layerSizes) {
+    : NeuralNetwork(layerSizes, std::random_device{}()) {
+}
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+NeuralNetwork::NeuralNetwork(const std::vector<int>& layerSizes, uint32_t seed)
+    : layerSizes(layerSizes) {
 
-    // Initialize weights and biases for each layer
+    // Allocate weights and biases for each layer
     for (size_t i = 0; i < layerSizes.size() - 1; i++) {
+        // Weight matrix: outputSize x inputSize
+        weights.push_back(Eigen::MatrixXf::Zero(layerSizes[i + 1], layerSizes[i]));
+        biases.push_back(Eigen::VectorXf::Zero(layerSizes[i + 1]));
+    }
+
+    randomize(seed);
+}
+
+void NeuralNetwork::randomize(uint32_t seed) {
+    std::mt19937 gen(seed);
+
+    for (size_t i = 0; i < weights.size(); i++) {
         int inputSize = layerSizes[i];
         int outputSize = layerSizes[i + 1];
 
@@ -19,22 +34,19 @@ NeuralNetwork::NeuralNetwork(const std::vector<int>& layerSizes)
         float stddev = std::sqrt(2.0f / (inputSize + outputSize));
         std::normal_distribution<float> dist(0.0f, stddev);
 
-        // Weight matrix: outputSize x inputSize
-        Eigen::MatrixXf weight = Eigen::MatrixXf::Zero(outputSize, inputSize);
+        Eigen::MatrixXf& weight = weights[i];
         for (int r = 0; r < outputSize; r++) {
             for (int c = 0; c < inputSize; c++) {
                 weight(r, c) = dist(gen);
             }
         }
-        weights.push_back(weight);
 
-        // Bias vector: outputSize - initialize to small values
-        Eigen::VectorXf bias = Eigen::VectorXf::Zero(outputSize);
+        // Bias vector: initialize to small values
+        Eigen::VectorXf& bias = biases[i];
         std::uniform_real_distribution<float> biasDist(-0.1f, 0.1f);
         for (int j = 0; j < outputSize; j++) {
             bias(j) = biasDist(gen);
         }
-        biases.push_back(bias);
     }
 }
 
@@ -66,6 +78,25 @@ std::vector<float> NeuralNetwork::forward(const std::vector<float>& input) {
     return output;
 }
 
+void NeuralNetwork::forward(const float* input, float* output, Arena& scratch) const {
+    ArenaScope scope(scratch);
+    int widest = *std::max_element(layerSizes.begin() + 1, layerSizes.end());
+    float* buffers[2] = {scratch.allocateArray<float>(widest), scratch.allocateArray<float>(widest)};
+
+    // Product then bias, as Eigen evaluates the expression above (same floats),
+    // but straight into the arena buffer instead of a heap temporary
+    const float* previous = input;
+    for (size_t i = 0; i < weights.size(); i++) {
+        float* next = i + 1 == weights.size() ? output : buffers[i % 2];
+        Eigen::Map<const Eigen::VectorXf> x(previous, weights[i].cols());
+        Eigen::Map<Eigen::VectorXf> activation(next, weights[i].rows());
+        activation.noalias() = weights[i] * x;
+        activation += biases[i];
+        activation = activation.array().tanh();
+        previous = next;
+    }
+}
+
 void NeuralNetwork::setWeights(const std::vector<Eigen::MatrixXf>& w,
                                 const std::vector<Eigen::VectorXf>& b) {
     weights = w;
@@ -73,8 +104,11 @@ void NeuralNetwork::setWeights(const std::vector<Eigen::MatrixXf>& w,
 }
 
 void NeuralNetwork::mutate(float mutationRate, float mutationStrength) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    mutate(mutationRate, mutationStrength, std::random_device{}());
+}
+
+void NeuralNetwork::mutate(float mutationRate, float mutationStrength, uint32_t seed) {
+    std::mt19937 gen(seed);
     std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
     std::normal_distribution<float> mutateDist(0.0f, mutationStrength);
 
@@ -184,44 +218,77 @@ void NeuralNetwork::save(const std::string& filename) const {
     std::cout << "Нейросеть сохранена в " << filename << std::endl;
 }
 
-void NeuralNetwork::load(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
+bool NeuralNetwork::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         std::cerr << "Ошибка открытия файла для загрузки: " << filename << std::endl;
-        return;
+        return false;
     }
 
+    // Validated throughout: the file may be caught half-written or be
+    // something else entirely. The network changes only if all of it is valid.
+    size_t remaining = static_cast<size_t>(file.tellg());
+    file.seekg(0);
+    auto read = [&](void* out, size_t bytes) {
+        if (bytes > remaining || !file.read(reinterpret_cast<char*>(out), bytes)) {
+            return false;
+        }
+        remaining -= bytes;
+        return true;
+    };
+
     // Load layer sizes
-    size_t numLayers;
-    file.read(reinterpret_cast<char*>(&numLayers), sizeof(numLayers));
-    layerSizes.resize(numLayers);
-    file.read(reinterpret_cast<char*>(layerSizes.data()),
-              numLayers * sizeof(int));
+    size_t numLayers = 0;
+    std::vector<int> sizes;
+    if (!read(&numLayers, sizeof(numLayers)) || numLayers < 2 || numLayers > 64) {
+        std::cerr << "Неверный формат нейросети: " << filename << std::endl;
+        return false;
+    }
+    sizes.resize(numLayers);
+    if (!read(sizes.data(), numLayers * sizeof(int))) {
+        std::cerr << "Неверный формат нейросети: " << filename << std::endl;
+        return false;
+    }
+    for (int size : sizes) {
+        if (size < 1 || size > (1 << 16)) {
+            std::cerr << "Неверный размер слоя " << size << ": " << filename << std::endl;
+            return false;
+        }
+    }
 
     // Load weights and biases
-    weights.clear();
-    biases.clear();
-
-    for (size_t i = 0; i < numLayers - 1; i++) {
-        int rows, cols;
-        file.read(reinterpret_cast<char*>(&rows), sizeof(rows));
-        file.read(reinterpret_cast<char*>(&cols), sizeof(cols));
-
-        Eigen::MatrixXf weight(rows, cols);
-        file.read(reinterpret_cast<char*>(weight.data()),
-                  rows * cols * sizeof(float));
-        weights.push_back(weight);
-
-        int biasSize;
-        file.read(reinterpret_cast<char*>(&biasSize), sizeof(biasSize));
-        Eigen::VectorXf bias(biasSize);
-        file.read(reinterpret_cast<char*>(bias.data()),
-                  biasSize * sizeof(float));
-        biases.push_back(bias);
+    std::vector<Eigen::MatrixXf> newWeights(numLayers - 1);
+    std::vector<Eigen::VectorXf> newBiases(numLayers - 1);
+    for (size_t i = 0; i + 1 < numLayers; i++) {
+        int rows = 0, cols = 0, biasSize = 0;
+        if (!read(&rows, sizeof(rows)) || !read(&cols, sizeof(cols))
+            || rows != sizes[i + 1] || cols != sizes[i]
+            || (size_t)rows * cols * sizeof(float) > remaining) {
+            std::cerr << "Неверный формат нейросети: " << filename << std::endl;
+            return false;
+        }
+        newWeights[i].resize(rows, cols);
+        if (!read(newWeights[i].data(), newWeights[i].size() * sizeof(float))
+            || !read(&biasSize, sizeof(biasSize)) || biasSize != rows) {
+            std::cerr << "Неверный формат нейросети: " << filename << std::endl;
+            return false;
+        }
+        newBiases[i].resize(rows);
+        if (!read(newBiases[i].data(), newBiases[i].size() * sizeof(float))) {
+            std::cerr << "Неверный формат нейросети: " << filename << std::endl;
+            return false;
+        }
+    }
+    if (remaining != 0) {
+        std::cerr << "Лишние данные в файле нейросети: " << filename << std::endl;
+        return false;
     }
 
-    file.close();
+    layerSizes.swap(sizes);
+    weights.swap(newWeights);
+    biases.swap(newBiases);
     std::cout << "Нейросеть загружена из " << filename << std::endl;
+    return true;
 }
 
 int NeuralNetwork::getParameterCount() const {
@@ -235,6 +302,48 @@ int NeuralNetwork::getParameterCount() const {
     return count;
 }
 
+void NeuralNetwork::getParameters(std::vector<float>& params) const {
+    params.resize(getParameterCount());
+    float* out = params.data();
+    for (size_t i = 0; i < weights.size(); i++) {
+        out = std::copy(weights[i].data(), weights[i].data() + weights[i].size(), out);
+        out = std::copy(biases[i].data(), biases[i].data() + biases[i].size(), out);
+    }
+}
+
+void NeuralNetwork::setParameters(const std::vector<float>& params) {
+    if (params.size() != static_cast<size_t>(getParameterCount())) {
+        return; // Size mismatch
+    }
+
+    const float* in = params.data();
+    for (size_t i = 0; i < weights.size(); i++) {
+        std::copy(in, in + weights[i].size(), weights[i].data());
+        in += weights[i].size();
+        std::copy(in, in + biases[i].size(), biases[i].data());
+        in += biases[i].size();
+    }
+}
+
+uint64_t NeuralNetwork::hashParameters() const {
+    // FNV-1a over the raw bytes: identical genomes always hash the same
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            hash ^= p[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    mix(layerSizes.data(), layerSizes.size() * sizeof(int));
+    for (size_t i = 0; i < weights.size(); i++) {
+        mix(weights[i].data(), weights[i].size() * sizeof(float));
+        mix(biases[i].data(), biases[i].size() * sizeof(float));
+    }
+    return hash;
+}
+
 float NeuralNetwork::activate(float x) const {
     // tanh activation
     return std::tanh(x);
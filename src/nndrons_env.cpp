@@ -0,0 +1,90 @@
+#include "nndrons_env.h"
+#include "vec_env.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+struct NndronsEnv {
+    VecEnv vecEnv;
+
+    NndronsEnv(int numEnvs, const SimConfig& config, int numThreads)
+        : vecEnv(numEnvs, config, numThreads) {}
+};
+
+static_assert(NNDRONS_DONE_SUCCESS == (int)VecEnv::Success && NNDRONS_DONE_CRASHED == (int)VecEnv::Crashed &&
+              NNDRONS_DONE_TIMEOUT == (int)VecEnv::Timeout, "done codes");
+
+int nndrons_env_observation_size(void) {
+    return VecEnv::observationSize;
+}
+
+int nndrons_env_action_size(void) {
+    return VecEnv::actionSize;
+}
+
+NndronsEnv* nndrons_env_create(int num_envs, int num_threads, const char* settings) {
+    if (num_envs <= 0) {
+        std::cerr << "nndrons_env_create: число сред должно быть больше 0" << std::endl;
+        return nullptr;
+    }
+
+    SimConfig config;
+    if (settings) {
+        std::istringstream in(settings);
+        std::string assignment;
+        while (in >> assignment) {
+            size_t eq = assignment.find('=');
+            if (eq == std::string::npos ||
+                !config.set(assignment.substr(0, eq), assignment.substr(eq + 1))) {
+                std::cerr << "Неверный параметр: " << assignment << std::endl;
+                return nullptr;
+            }
+        }
+    }
+
+    // No exception may cross the C boundary
+    try {
+        return new NndronsEnv(num_envs, config, num_threads);
+    } catch (const std::exception& e) {
+        std::cerr << "nndrons_env_create: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+void nndrons_env_destroy(NndronsEnv* env) {
+    delete env;
+}
+
+int nndrons_env_num_envs(const NndronsEnv* env) {
+    return env ? env->vecEnv.getNumEnvs() : -1;
+}
+
+uint64_t nndrons_env_seed(const NndronsEnv* env) {
+    return env ? env->vecEnv.getSeed() : 0;
+}
+
+int nndrons_env_set_dt(NndronsEnv* env, float dt) {
+    if (!env || !(dt > 0.0f)) {
+        return -1;
+    }
+    env->vecEnv.setDt(dt);
+    return 0;
+}
+
+int nndrons_env_reset(NndronsEnv* env, const uint64_t* seeds, float* observations) {
+    if (!env) {
+        return -1;
+    }
+    env->vecEnv.reset(seeds, observations);
+    return 0;
+}
+
+int nndrons_env_step(NndronsEnv* env, const float* actions, float* observations,
+                     float* rewards, uint8_t* dones) {
+    if (!env || !actions || !observations || !rewards || !dones) {
+        std::cerr << "nndrons_env_step: не задан буфер" << std::endl;
+        return -1;
+    }
+    env->vecEnv.step(actions, observations, rewards, dones);
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "novelty_archive.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+NoveltyArchive::NoveltyArchive(int descriptorSize, int k)
+    : dims(descriptorSize), k(k), root(-1), builtSize(0) {
+}
+
+void NoveltyArchive::add(const std::vector<float>& descriptor) {
+    if (static_cast<int>(descriptor.size()) != dims) {
+        return; // Size mismatch
+    }
+
+    int pointIdx = static_cast<int>(size());
+    points.insert(points.end(), descriptor.begin(), descriptor.end());
+
+    // Incremental inserts keep queries cheap between rebuilds;
+    // a full rebuild each time the archive doubles keeps the tree balanced
+    // (amortized O(log n) per insert)
+    if (size() >= 2 * builtSize || root < 0) {
+        rebuild();
+    } else {
+        insert(pointIdx);
+    }
+}
+
+float NoveltyArchive::novelty(const std::vector<float>& descriptor) const {
+    if (root < 0 || static_cast<int>(descriptor.size()) != dims) {
+        return 0.0f;
+    }
+
+    int count = std::min<int>(k, static_cast<int>(size()));
+    std::vector<std::pair<float, int>> heap;
+    heap.reserve(count + 1);
+    search(root, descriptor.data(), heap, count);
+
+    float sum = 0.0f;
+    for (const auto& entry : heap) {
+        sum += std::sqrt(entry.first);
+    }
+    return heap.empty() ? 0.0f : sum / heap.size();
+}
+
+void NoveltyArchive::clear() {
+    points.clear();
+    nodes.clear();
+    root = -1;
+    builtSize = 0;
+}
+
+void NoveltyArchive::rebuild() {
+    TRACE_SCOPE("NoveltyArchive::rebuild");
+
+    int n = static_cast<int>(size());
+    std::vector<int> indices(n);
+    for (int i = 0; i < n; i++) {
+        indices[i] = i;
+    }
+
+    nodes.clear();
+    nodes.reserve(n);
+    root = build(indices, 0, n, 0);
+    builtSize = n;
+}
+
+int NoveltyArchive::build(std::vector<int>& indices, int begin, int end, int depth) {
+    if (begin >= end) {
+        return -1;
+    }
+
+    // Split along the dimension with the largest spread
+    int axis = depth % dims;
+    float bestSpread = -1.0f;
+    for (int d = 0; d < dims; d++) {
+        float lo = points[indices[begin] * dims + d];
+        float hi = lo;
+        for (int i = begin + 1; i < end; i++) {
+            float v = points[indices[i] * dims + d];
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        if (hi - lo > bestSpread) {
+            bestSpread = hi - lo;
+            axis = d;
+        }
+    }
+
+    int mid = begin + (end - begin) / 2;
+
+    // Median split along the current axis
+    std::nth_element(indices.begin() + begin, indices.begin() + mid, indices.begin() + end,
+                     [&](int a, int b) {
+                         return points[a * dims + axis] < points[b * dims + axis];
+                     });
+
+    int nodeIdx = static_cast<int>(nodes.size());
+    nodes.push_back({indices[mid], axis, -1, -1});
+
+    int left = build(indices, begin, mid, depth + 1);
+    int right = build(indices, mid + 1, end, depth + 1);
+    nodes[nodeIdx].left = left;
+    nodes[nodeIdx].right = right;
+
+    return nodeIdx;
+}
+
+void NoveltyArchive::insert(int pointIdx) {
+    const float* p = &points[pointIdx * dims];
+    int nodeIdx = root;
+    int depth = 0;
+
+    while (true) {
+        Node& node = nodes[nodeIdx];
+        bool goLeft = p[node.axis] < points[node.point * dims + node.axis];
+        int next = goLeft ? node.left : node.right;
+
+        if (next < 0) {
+            int newIdx = static_cast<int>(nodes.size());
+            // push_back may reallocate, so don't touch `node` afterwards
+            nodes.push_back({pointIdx, (depth + 1) % dims, -1, -1});
+            if (goLeft) {
+                nodes[nodeIdx].left = newIdx;
+            } else {
+                nodes[nodeIdx].right = newIdx;
+            }
+            return;
+        }
+
+        nodeIdx = next;
+        depth++;
+    }
+}
+
+void NoveltyArchive::search(int nodeIdx, const float* query,
+                            std::vector<std::pair<float, int>>& heap, int count) const {
+    if (nodeIdx < 0) {
+        return;
+    }
+
+    const Node& node = nodes[nodeIdx];
+    const float* p = &points[node.point * dims];
+
+    float distSq = distanceSquared(query, p);
+    if (static_cast<int>(heap.size()) < count) {
+        heap.push_back({distSq, node.point});
+        std::push_heap(heap.begin(), heap.end());
+    } else if (distSq < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = {distSq, node.point};
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    float diff = query[node.axis] - p[node.axis];
+    int nearSide = diff < 0 ? node.left : node.right;
+    int farSide = diff < 0 ? node.right : node.left;
+
+    search(nearSide, query, heap, count);
+
+    // Only visit the far side if the splitting plane is closer than the current k-th neighbour
+    if (static_cast<int>(heap.size()) < count || diff * diff < heap.front().first) {
+        search(farSide, query, heap, count);
+    }
+}
+
+float NoveltyArchive::distanceSquared(const float* a, const float* b) const {
+    float sum = 0.0f;
+    for (int i = 0; i < dims; i++) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
@@ -0,0 +1,293 @@
+#include "packed_population.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PACKED_X86_DISPATCH 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const char* precisionName(ParameterPrecision precision) {
+    switch (precision) {
+        case ParameterPrecision::Float16: return "fp16";
+        case ParameterPrecision::BFloat16: return "bf16";
+        default: return "fp32";
+    }
+}
+
+bool parsePrecision(const std::string& name, ParameterPrecision& precision) {
+    for (ParameterPrecision p : {ParameterPrecision::Float32, ParameterPrecision::Float16, ParameterPrecision::BFloat16}) {
+        if (name == precisionName(p)) {
+            precision = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits = floatBits(value);
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+    if (magnitude >= 0x7F800000) {  // Inf, NaN (stays quiet NaN)
+        return sign | 0x7C00 | (magnitude > 0x7F800000 ? 0x200 : 0);
+    }
+    if (magnitude >= 0x477FF000) {  // Rounds to 65520 or more
+        return sign | 0x7C00;
+    }
+    if (magnitude < 0x38800000) {  // Below 2^-14: half subnormal or zero
+        if (magnitude < 0x33000000) {  // Below 2^-25
+            return sign;
+        }
+        uint32_t shift = 126 - (magnitude >> 23);
+        uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+        uint32_t result = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        result += remainder > halfway || (remainder == halfway && (result & 1));
+        return sign | (uint16_t)result;
+    }
+    uint32_t result = (magnitude - 0x38000000) >> 13;  // Exponent bias 127 -> 15
+    uint32_t remainder = magnitude & 0x1FFF;
+    result += remainder > 0x1000 || (remainder == 0x1000 && (result & 1));  // Carry may bump the exponent
+    return sign | (uint16_t)result;
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+    if (exponent == 0x1F) {
+        return bitsFloat(sign | 0x7F800000 | (mantissa << 13));
+    }
+    if (exponent == 0) {
+        float subnormal = mantissa * (1.0f / 16777216.0f);  // mantissa * 2^-24, exact
+        return sign ? -subnormal : subnormal;
+    }
+    return bitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t floatToBFloat16(float value) {
+    uint32_t bits = floatBits(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return (uint16_t)((bits >> 16) | 0x40);  // Quiet NaN
+    }
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return (uint16_t)(bits >> 16);
+}
+
+float bfloat16ToFloat(uint16_t value) {
+    return bitsFloat((uint32_t)value << 16);
+}
+
+// fp16 -> fp32 of a whole slot. Conversion is exact, so every path gives the
+// same floats; the widest one the CPU supports is picked once at startup.
+static void widenHalfScalar(const uint16_t* in, float* out, int count) {
+    for (int i = 0; i < count; i++) {
+        out[i] = halfToFloat(in[i]);
+    }
+}
+
+#ifdef PACKED_X86_DISPATCH
+__attribute__((target("avx,f16c"))) static void widenHalfF16c(const uint16_t* in, float* out, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+    }
+    widenHalfScalar(in + i, out + i, count - i);
+}
+
+// GCC 12's _mm512_cvtph_ps passes an undefined vector as its masked-off
+// source and warns about it being used uninitialized; it never is
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+__attribute__((target("avx512f"))) static void widenHalfAvx512(const uint16_t* in, float* out, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i half = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm512_storeu_ps(out + i, _mm512_cvtph_ps(half));
+    }
+    widenHalfScalar(in + i, out + i, count - i);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+using WidenFunction = void (*)(const uint16_t*, float*, int);
+
+static WidenFunction pickWidenHalf() {
+#ifdef PACKED_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return widenHalfAvx512;
+    }
+    if (__builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx")) {
+        return widenHalfF16c;
+    }
+#endif
+    return widenHalfScalar;
+}
+
+static const WidenFunction widenHalf = pickWidenHalf();
+
+// bf16 -> fp32 is a 16-bit shift: interleave zeros below each value
+static void widenBFloat16(const uint16_t* in, float* out, int count) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i narrow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(zero, narrow));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(zero, narrow));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = bfloat16ToFloat(in[i]);
+    }
+}
+
+PackedPopulation::PackedPopulation(const std::vector<int>& layerSizes, int size, ParameterPrecision precision)
+    : layerSizes(layerSizes), size(std::max(size, 0)), parameterCount(0), precision(precision) {
+    int widest = 0;
+    for (size_t l = 0; l + 1 < layerSizes.size(); l++) {
+        parameterCount += layerSizes[l] * layerSizes[l + 1] + layerSizes[l + 1];
+        widest = std::max(widest, layerSizes[l + 1]);
+    }
+    size_t elementBytes = precision == ParameterPrecision::Float32 ? sizeof(float) : sizeof(uint16_t);
+    stride = (parameterCount * elementBytes + 63) / 64 * 64;
+    storage.assign(stride * this->size, 0);
+    params.resize(parameterCount);
+    activations[0].resize(widest);
+    activations[1].resize(widest);
+}
+
+void PackedPopulation::setParameters(int member, const float* values) {
+    uint8_t* out = slot(member);
+    if (precision == ParameterPrecision::Float32) {
+        std::memcpy(out, values, parameterCount * sizeof(float));
+        return;
+    }
+    uint16_t* narrow = reinterpret_cast<uint16_t*>(out);
+    for (int i = 0; i < parameterCount; i++) {
+        narrow[i] = precision == ParameterPrecision::Float16 ? floatToHalf(values[i]) : floatToBFloat16(values[i]);
+    }
+}
+
+void PackedPopulation::getParameters(int member, float* values) const {
+    const uint8_t* in = slot(member);
+    switch (precision) {
+        case ParameterPrecision::Float32:
+            std::memcpy(values, in, parameterCount * sizeof(float));
+            break;
+        case ParameterPrecision::Float16:
+            widenHalf(reinterpret_cast<const uint16_t*>(in), values, parameterCount);
+            break;
+        case ParameterPrecision::BFloat16:
+            widenBFloat16(reinterpret_cast<const uint16_t*>(in), values, parameterCount);
+            break;
+    }
+}
+
+void PackedPopulation::setNetwork(int member, const NeuralNetwork& network) {
+    std::vector<float> values;
+    network.getParameters(values);
+    if ((int)values.size() == parameterCount) {
+        setParameters(member, values.data());
+    }
+}
+
+void PackedPopulation::getNetwork(int member, NeuralNetwork& network) const {
+    std::vector<float> values(parameterCount);
+    getParameters(member, values.data());
+    network.setParameters(values);
+}
+
+void PackedPopulation::copyMember(int destination, int source) {
+    if (destination != source) {
+        std::memcpy(slot(destination), slot(source), stride);
+    }
+}
+
+void PackedPopulation::mutate(int member, float rate, float strength, uint32_t seed) {
+    getParameters(member, params.data());
+
+    // Same draws in the same order as NeuralNetwork::mutate: weights row by
+    // row (stored column-major), then biases
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+    std::normal_distribution<float> mutateDist(0.0f, strength);
+    float* layer = params.data();
+    for (size_t l = 0; l + 1 < layerSizes.size(); l++) {
+        int rows = layerSizes[l + 1], cols = layerSizes[l];
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                if (probDist(gen) < rate) {
+                    layer[c * rows + r] += mutateDist(gen);
+                }
+            }
+        }
+        layer += rows * cols + rows;
+    }
+    layer = params.data();
+    for (size_t l = 0; l + 1 < layerSizes.size(); l++) {
+        int rows = layerSizes[l + 1], cols = layerSizes[l];
+        float* bias = layer + rows * cols;
+        for (int i = 0; i < rows; i++) {
+            if (probDist(gen) < rate) {
+                bias[i] += mutateDist(gen);
+            }
+        }
+        layer += rows * cols + rows;
+    }
+
+    setParameters(member, params.data());
+}
+
+void PackedPopulation::forward(const float* observations, float* actions, const uint8_t* active) const {
+    const int inputs = layerSizes.front(), outputs = layerSizes.back();
+    for (int member = 0; member < size; member++) {
+        if (active && !active[member]) {
+            continue;
+        }
+        getParameters(member, params.data());
+
+        // Same expression as NeuralNetwork::forward, on the widened copy
+        const float* layer = params.data();
+        Eigen::Map<const Eigen::VectorXf> input(observations + (size_t)member * inputs, inputs);
+        for (size_t l = 0; l + 1 < layerSizes.size(); l++) {
+            int rows = layerSizes[l + 1], cols = layerSizes[l];
+            Eigen::Map<const Eigen::MatrixXf> weight(layer, rows, cols);
+            Eigen::Map<const Eigen::VectorXf> bias(layer + rows * cols, rows);
+            bool last = l + 2 == layerSizes.size();
+            Eigen::Map<Eigen::VectorXf> output(last ? actions + (size_t)member * outputs : activations[l % 2].data(),
+                                               rows);
+            if (l == 0) {
+                output = weight * input + bias;
+            } else {
+                Eigen::Map<const Eigen::VectorXf> previous(activations[(l - 1) % 2].data(), cols);
+                output = weight * previous + bias;
+            }
+            output = output.array().tanh();
+            layer += rows * cols + rows;
+        }
+    }
+}
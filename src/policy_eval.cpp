@@ -0,0 +1,42 @@
+#include "policy_eval.h"
+#include "vec_env.h"
+#include "random_streams.h"
+#include <vector>
+
+PolicyEvaluation evaluatePolicy(const BatchPolicy& policy, const SimConfig& config, int episodes) {
+    VecEnv env(episodes, config, 1);
+    std::vector<uint64_t> seeds(episodes);
+    for (int i = 0; i < episodes; i++) {
+        seeds[i] = deriveSeed(config.seed, SeedStream::Trial, i);
+    }
+
+    Eigen::MatrixXf observations(VecEnv::observationSize, episodes);  // Column i = env i
+    Eigen::MatrixXf actions(VecEnv::actionSize, episodes);
+    std::vector<float> rewards(episodes), returns(episodes, 0.0f);
+    std::vector<uint8_t> dones(episodes), finished(episodes, 0);
+    env.reset(seeds.data(), observations.data());
+
+    int successes = 0, remaining = episodes;
+    while (remaining > 0) {
+        policy(observations, actions);
+        env.step(actions.data(), observations.data(), rewards.data(), dones.data());
+        for (int i = 0; i < episodes; i++) {
+            if (finished[i]) {
+                continue;
+            }
+            returns[i] += rewards[i];
+            if (dones[i] != VecEnv::Running) {
+                finished[i] = 1;
+                successes += dones[i] == VecEnv::Success;
+                remaining--;
+            }
+        }
+    }
+
+    PolicyEvaluation result;
+    result.successRate = (float)successes / episodes;
+    for (float r : returns) {
+        result.meanReturn += r / episodes;
+    }
+    return result;
+}
@@ -0,0 +1,138 @@
+#include "policy_export.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Shortest text that reads back as exactly this float, as a C++ float literal
+static std::string floatLiteral(float value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    std::string literal = text;
+    if (literal.find_first_of(".e") == std::string::npos) {
+        literal += ".0";
+    }
+    return literal + "f";
+}
+
+static void writeArray(std::ostream& out, const std::string& name, const float* values, int count, int perLine) {
+    out << "alignas(32) constexpr float " << name << "[" << count << "] = {";
+    for (int i = 0; i < count; i++) {
+        out << (i % perLine == 0 ? "\n    " : " ") << floatLiteral(values[i]) << (i + 1 < count ? "," : "");
+    }
+    out << "\n};\n";
+}
+
+// Eigen's float tanh (generic_fast_tanh_float, non-FMA clamp): a 13/6 rational
+// approximation, which is what NeuralNetwork::forward actually evaluates.
+// Eigen returns x itself for |x| < 0.0004; skipping that (an error below 1e-10)
+// and writing the clamps as min/max keeps the function branch-free.
+static const char* fastTanhSource =
+    "inline float activate(float x) {\n"
+    "    x = x < 7.90531110763549805f ? x : 7.90531110763549805f;\n"
+    "    x = x > -7.90531110763549805f ? x : -7.90531110763549805f;\n"
+    "    const float x2 = x * x;\n"
+    "    float p = x2 * -2.76076847742355e-16f + 2.00018790482477e-13f;\n"
+    "    p = x2 * p + -8.60467152213735e-11f;\n"
+    "    p = x2 * p + 5.12229709037114e-08f;\n"
+    "    p = x2 * p + 1.48572235717979e-05f;\n"
+    "    p = x2 * p + 6.37261928875436e-04f;\n"
+    "    p = x2 * p + 4.89352455891786e-03f;\n"
+    "    p = x * p;\n"
+    "    float q = x2 * 1.19825839466702e-06f + 1.18534705686654e-04f;\n"
+    "    q = x2 * q + 2.26843463243900e-03f;\n"
+    "    q = x2 * q + 4.89352518554385e-03f;\n"
+    "    return p / q;\n"
+    "}\n";
+
+bool exportPolicyHeader(const NeuralNetwork& network, const std::string& filename,
+                        const PolicyExportOptions& options) {
+    const std::vector<int>& sizes = network.getLayerSizes();
+    std::vector<Eigen::MatrixXf> weights = network.getWeights();
+    std::vector<Eigen::VectorXf> biases = network.getBiases();
+    if (sizes.size() < 2 || weights.size() != sizes.size() - 1) {
+        std::cerr << "Ошибка экспорта: пустая нейросеть" << std::endl;
+        return false;
+    }
+
+    std::ostringstream out;
+    std::string layout;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        layout += (i ? "-" : "") + std::to_string(sizes[i]);
+    }
+
+    out << "// Generated by nndrons_export" << (options.source.empty() ? "" : " from " + options.source)
+        << " (" << layout << (options.fastTanh ? ", fast tanh" : "") << "). Do not edit.\n"
+        << "// Standalone policy: no Eigen, no heap, no I/O. policy() computes the same\n"
+        << "// as NeuralNetwork::forward (tanh after every layer).\n"
+        << "#pragma once\n";
+    if (!options.fastTanh) {
+        out << "#include <cmath>\n";
+    }
+    out << "\nnamespace " << options.nameSpace << " {\n\n";
+
+    out << "constexpr int layerCount = " << sizes.size() << ";\n"
+        << "constexpr int layerSizes[layerCount] = {";
+    for (size_t i = 0; i < sizes.size(); i++) {
+        out << (i ? ", " : "") << sizes[i];
+    }
+    out << "};\n"
+        << "constexpr int inputSize = " << sizes.front() << ";\n"
+        << "constexpr int outputSize = " << sizes.back() << ";\n\n";
+
+    // Eigen's column-major order, i.e. input-major: the unrolled policy adds
+    // one input into every neuron at a time, which vectorizes across neurons
+    for (size_t l = 0; l < weights.size(); l++) {
+        out << "// Layer " << l << ": " << sizes[l] << " -> " << sizes[l + 1] << "\n";
+        writeArray(out, "weights" + std::to_string(l), weights[l].data(), (int)weights[l].size(), 8);
+        writeArray(out, "biases" + std::to_string(l), biases[l].data(), (int)biases[l].size(), 8);
+        out << "\n";
+    }
+
+    if (options.fastTanh) {
+        out << fastTanhSource;
+    } else {
+        out << "inline float activate(float x) {\n    return std::tanh(x);\n}\n";
+    }
+
+    // Loops with compile-time bounds rather than one expression per neuron:
+    // the compiler unrolls them and vectorizes across neurons, which it
+    // doesn't do for textually unrolled sums. Each neuron still sums its
+    // products in input order and adds the bias last, as Eigen's W * x + b.
+    out << "\ninline void policy(const float in[" << sizes.front() << "], float out[" << sizes.back() << "]) {\n";
+    std::string input = "in";
+    for (size_t l = 0; l < weights.size(); l++) {
+        std::string rows = std::to_string(sizes[l + 1]);
+        std::string sum = "s" + std::to_string(l);
+        std::string w = "weights" + std::to_string(l);
+        bool last = l + 1 == weights.size();
+        std::string output = last ? "out" : "h" + std::to_string(l + 1);
+
+        out << (l ? "\n" : "") << "    // " << sizes[l] << " -> " << rows << "\n"
+            << "    float " << sum << "[" << rows << "];\n"
+            << "    for (int r = 0; r < " << rows << "; r++) {\n"
+            << "        " << sum << "[r] = " << w << "[r] * " << input << "[0];\n"
+            << "    }\n"
+            << "    for (int c = 1; c < " << sizes[l] << "; c++) {\n"
+            << "        for (int r = 0; r < " << rows << "; r++) {\n"
+            << "            " << sum << "[r] += " << w << "[c * " << rows << " + r] * " << input << "[c];\n"
+            << "        }\n"
+            << "    }\n";
+        if (!last) {
+            out << "    float " << output << "[" << rows << "];\n";
+        }
+        out << "    for (int r = 0; r < " << rows << "; r++) {\n"
+            << "        " << output << "[r] = activate(" << sum << "[r] + biases" << l << "[r]);\n"
+            << "    }\n";
+        input = output;
+    }
+    out << "}\n\n} // namespace " << options.nameSpace << "\n";
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка открытия файла для сохранения: " << filename << std::endl;
+        return false;
+    }
+    file << out.str();
+    return file.good();
+}
@@ -0,0 +1,507 @@
+#include "policy_server.h"
+#include "drone.h"
+#include "neural_network.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+static_assert(policyInputSize == Drone::sensorCount, "Protocol input must match the drone sensors");
+static_assert(policyOutputSize == Drone::controlCount, "Protocol output must match the drone controls");
+
+// epoll user data: fixed ids for the server's own descriptors, then connections
+enum : uint64_t { listenId = 0, inotifyId = 1, stopId = 2, timerId = 3, firstConnectionId = 16 };
+
+// Columns per forward pass: keeps Eigen's product blocking on the stack
+static const int inferenceChunk = 256;
+
+static const size_t latencyCapacity = 1 << 16;
+
+static const size_t requestBytesMax = sizeof(PolicyRequestHeader)
+                                      + (size_t)policyMaxRequestCount * policyInputSize * sizeof(float);
+static const size_t replyBytesMax = sizeof(PolicyReplyHeader)
+                                    + (size_t)policyMaxRequestCount * policyOutputSize * sizeof(float);
+
+PolicyServer::PolicyServer(const PolicyServerConfig& config)
+    : config(config), listenFd(-1), epollFd(-1), inotifyFd(-1), stopFd(-1), timerFd(-1),
+      stopping(false), watchId(-1), modelVersion(0), pendingRows(0),
+      activeConnections(0), busyConnections(0),
+      windowRequests(0), windowVectors(0), windowBatches(0) {
+    this->config.maxClients = std::max(1, config.maxClients);
+    this->config.maxBatch = std::max(policyMaxRequestCount, config.maxBatch);
+    this->config.maxDelayMicros = std::max(0, config.maxDelayMicros);
+
+    connections.resize(this->config.maxClients);
+    for (auto it = connections.rbegin(); it != connections.rend(); ++it) {
+        it->in.resize(requestBytesMax);
+        it->out.resize(replyBytesMax);
+        freeConnections.push_back(&*it);
+    }
+    pending.reserve(this->config.maxClients);
+    flushing.reserve(this->config.maxClients);
+    resume.reserve(this->config.maxClients);
+    resumeScratch.reserve(this->config.maxClients);
+    latencies.resize(latencyCapacity);
+    sortScratch.resize(latencyCapacity);
+}
+
+PolicyServer::~PolicyServer() {
+    for (Connection& connection : connections) {
+        if (connection.fd >= 0) {
+            close(connection.fd);
+        }
+    }
+    for (int fd : {listenFd, epollFd, inotifyFd, stopFd, timerFd}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    if (listenFd >= 0) {
+        unlink(config.socketPath.c_str());
+    }
+}
+
+bool PolicyServer::loadModel(bool initial) {
+    // NeuralNetwork::load validates the file: it may be caught half-written
+    NeuralNetwork model(std::vector<int>{policyInputSize, policyOutputSize}, 0u);
+    if (!model.load(config.modelFile)) {
+        if (!initial) {
+            std::cerr << "Модель не перезагружена, работает версия " << modelVersion << std::endl;
+        }
+        return false;
+    }
+    const std::vector<int>& sizes = model.getLayerSizes();
+    if (sizes.front() != policyInputSize || sizes.back() != policyOutputSize) {
+        std::cerr << "Модель должна иметь " << policyInputSize << " входа и " << policyOutputSize
+                  << " выхода: " << config.modelFile << std::endl;
+        return false;
+    }
+
+    bool resized = sizes != layerSizes;
+    layerSizes = sizes;
+    weights = model.getWeights();
+    biases = model.getBiases();
+    modelVersion++;
+    if (resized) {
+        allocateBatch();
+    }
+
+    std::string layout;
+    for (size_t i = 0; i < layerSizes.size(); i++) {
+        layout += (i ? "-" : "") + std::to_string(layerSizes[i]);
+    }
+    std::cout << (initial ? "Модель загружена" : "Модель перезагружена") << ": " << config.modelFile
+              << " (" << layout << ", версия " << modelVersion << ")" << std::endl;
+    return true;
+}
+
+void PolicyServer::allocateBatch() {
+    batchInput.resize(policyInputSize, config.maxBatch);
+    layerOutputs.resize(weights.size());
+    for (size_t i = 0; i < weights.size(); i++) {
+        layerOutputs[i].resize(layerSizes[i + 1], config.maxBatch);
+    }
+}
+
+bool PolicyServer::start() {
+    if (!loadModel(true)) {
+        return false;
+    }
+
+    if (config.socketPath.size() >= sizeof(sockaddr_un::sun_path)) {
+        std::cerr << "Слишком длинный путь сокета: " << config.socketPath << std::endl;
+        return false;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, config.socketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(config.socketPath.c_str());  // Stale socket from a previous run
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listenFd, config.maxClients) != 0) {
+        std::cerr << "Ошибка создания сокета " << config.socketPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (epollFd < 0 || stopFd < 0 || timerFd < 0 || inotifyFd < 0) {
+        std::cerr << "Ошибка инициализации epoll: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Watch the directory: saving usually replaces the file, which a watch
+    // on the file itself would lose
+    size_t slash = config.modelFile.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : config.modelFile.substr(0, slash + 1);
+    modelName = slash == std::string::npos ? config.modelFile : config.modelFile.substr(slash + 1);
+    watchId = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchId < 0) {
+        std::cerr << "Горячая перезагрузка недоступна (" << directory << "): " << std::strerror(errno) << std::endl;
+    }
+
+    const std::pair<int, uint64_t> fds[] = {
+        {listenFd, listenId}, {inotifyFd, inotifyId}, {stopFd, stopId}, {timerFd, timerId}};
+    for (const auto& entry : fds) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = entry.second;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, entry.first, &event);
+    }
+
+    std::cout << "Сервер политики слушает " << config.socketPath << " (до " << config.maxClients
+              << " клиентов, батч до " << config.maxBatch << ", ожидание до " << config.maxDelayMicros
+              << " мкс)" << std::endl;
+    return true;
+}
+
+void PolicyServer::requestStop() {
+    uint64_t one = 1;
+    if (stopFd >= 0) {
+        ssize_t written = write(stopFd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void PolicyServer::run() {
+    std::vector<epoll_event> events(config.maxClients + 4);
+    windowStart = Clock::now();
+    auto nextReport = windowStart + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(config.reportSeconds));
+
+    while (!stopping) {
+        int timeout = -1;
+        if (config.reportSeconds > 0.0) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextReport - Clock::now());
+            timeout = (int)std::max<long long>(0, wait.count() + 1);
+        }
+        int count = epoll_wait(epollFd, events.data(), (int)events.size(), timeout);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "Ошибка epoll_wait: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            uint64_t id = events[i].data.u64;
+            uint32_t flags = events[i].events;
+            if (id == listenId) {
+                acceptClients();
+            } else if (id == stopId) {
+                stopping = true;
+            } else if (id == timerId) {
+                uint64_t expirations;
+                while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+                }
+            } else if (id == inotifyId) {
+                handleModelChange();
+            } else {
+                Connection* connection = &connections[id - firstConnectionId];
+                if (connection->fd < 0) {
+                    continue;  // Closed earlier in this round
+                }
+                if ((flags & EPOLLOUT) && connection->outSent < connection->outBytes) {
+                    writeReply(connection);
+                }
+                if (connection->fd >= 0 && (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                    connection->readable = true;
+                    if (!connection->busy) {
+                        readRequests(connection);
+                    }
+                }
+            }
+        }
+        serviceClients();
+
+        if (config.reportSeconds > 0.0 && Clock::now() >= nextReport) {
+            report();
+            nextReport = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                            std::chrono::duration<double>(config.reportSeconds));
+        }
+    }
+    std::cout << "Сервер политики остановлен" << std::endl;
+}
+
+void PolicyServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "Ошибка accept: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        if (freeConnections.empty()) {
+            std::cerr << "Отказ клиенту: уже " << config.maxClients << " подключений" << std::endl;
+            close(fd);
+            continue;
+        }
+
+        Connection* connection = freeConnections.back();
+        freeConnections.pop_back();
+        connection->fd = fd;
+        connection->readable = true;
+        connection->busy = false;
+        connection->closing = false;
+        connection->inBytes = 0;
+        connection->outBytes = 0;
+        connection->outSent = 0;
+        activeConnections++;
+
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = firstConnectionId + (connection - connections.data());
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        readRequests(connection);
+    }
+}
+
+void PolicyServer::closeConnection(Connection* connection) {
+    // Never called while the connection's request sits in the batch
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+    close(connection->fd);
+    connection->fd = -1;
+    if (connection->busy) {
+        connection->busy = false;
+        busyConnections--;
+    }
+    activeConnections--;
+    freeConnections.push_back(connection);
+}
+
+// Read one request at a time, so pipelined requests wait in the socket
+// buffer until this one is answered
+void PolicyServer::readRequests(Connection* connection) {
+    while (connection->fd >= 0 && !connection->busy) {
+        size_t needed = sizeof(PolicyRequestHeader);
+        if (connection->inBytes >= needed) {
+            needed += (size_t)connection->count * policyInputSize * sizeof(float);
+        }
+        ssize_t got = read(connection->fd, connection->in.data() + connection->inBytes,
+                           needed - connection->inBytes);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                connection->readable = false;
+                return;
+            }
+            closeConnection(connection);
+            return;
+        }
+        if (got == 0) {
+            closeConnection(connection);  // Client hung up
+            return;
+        }
+        connection->inBytes += got;
+
+        if (connection->inBytes == sizeof(PolicyRequestHeader)) {
+            PolicyRequestHeader header;
+            std::memcpy(&header, connection->in.data(), sizeof(header));
+            if (header.magic != policyRequestMagic || header.count < 1
+                || header.count > (uint32_t)policyMaxRequestCount) {
+                PolicyReplyHeader reply = {policyReplyMagic, 0, PolicyStatusBadRequest, modelVersion};
+                std::memcpy(connection->out.data(), &reply, sizeof(reply));
+                connection->outBytes = sizeof(reply);
+                connection->outSent = 0;
+                connection->closing = true;
+                connection->busy = true;
+                busyConnections++;
+                writeReply(connection);
+                return;
+            }
+            connection->count = header.count;
+        } else if (connection->inBytes == needed) {
+            enqueue(connection);
+        }
+    }
+}
+
+void PolicyServer::enqueue(Connection* connection) {
+    int rows = (int)connection->count;
+    if (pendingRows + rows > config.maxBatch) {
+        flush();
+    }
+
+    connection->received = Clock::now();
+    connection->busy = true;
+    busyConnections++;
+    connection->batchOffset = pendingRows;
+    std::memcpy(batchInput.data() + (size_t)pendingRows * policyInputSize,
+                connection->in.data() + sizeof(PolicyRequestHeader),
+                (size_t)rows * policyInputSize * sizeof(float));
+    if (pending.empty()) {
+        oldestPending = connection->received;
+        if (config.maxDelayMicros > 0) {
+            itimerspec timer = {};
+            timer.it_value.tv_sec = config.maxDelayMicros / 1000000;
+            timer.it_value.tv_nsec = (config.maxDelayMicros % 1000000) * 1000L;
+            timerfd_settime(timerFd, 0, &timer, nullptr);
+        }
+    }
+    pending.push_back(connection);
+    pendingRows += rows;
+}
+
+// Flush when waiting can't help any more: nobody else can join the batch, or
+// the oldest request has used up its delay
+void PolicyServer::serviceClients() {
+    while (true) {
+        while (!resume.empty()) {
+            resume.swap(resumeScratch);
+            for (Connection* connection : resumeScratch) {
+                if (connection->fd >= 0 && connection->readable && !connection->busy) {
+                    readRequests(connection);
+                }
+            }
+            resumeScratch.clear();
+        }
+        if (pendingRows == 0) {
+            return;
+        }
+        bool expired = Clock::now() - oldestPending >= std::chrono::microseconds(config.maxDelayMicros);
+        if (!expired && busyConnections < activeConnections) {
+            return;  // The timer wakes the loop at the deadline
+        }
+        flush();
+    }
+}
+
+void PolicyServer::flush() {
+    if (pendingRows == 0) {
+        return;
+    }
+
+    // Forward pass in column chunks, tanh after every layer (NeuralNetwork::forward)
+    for (int begin = 0; begin < pendingRows; begin += inferenceChunk) {
+        int columns = std::min(inferenceChunk, pendingRows - begin);
+        for (size_t l = 0; l < weights.size(); l++) {
+            auto output = layerOutputs[l].middleCols(begin, columns);
+            if (l == 0) {
+                output.noalias() = weights[l] * batchInput.middleCols(begin, columns);
+            } else {
+                output.noalias() = weights[l] * layerOutputs[l - 1].middleCols(begin, columns);
+            }
+            output.colwise() += biases[l];
+            output = output.array().tanh();
+        }
+    }
+
+    // Copy every reply out before writing any, so a connection that is
+    // resumed right away can start the next batch
+    const Eigen::MatrixXf& controls = layerOutputs.back();
+    for (Connection* connection : pending) {
+        PolicyReplyHeader reply = {policyReplyMagic, connection->count, PolicyStatusOk, modelVersion};
+        std::memcpy(connection->out.data(), &reply, sizeof(reply));
+        size_t bytes = (size_t)connection->count * policyOutputSize * sizeof(float);
+        std::memcpy(connection->out.data() + sizeof(reply),
+                    controls.data() + (size_t)connection->batchOffset * policyOutputSize, bytes);
+        connection->outBytes = sizeof(reply) + bytes;
+        connection->outSent = 0;
+        windowVectors += connection->count;
+    }
+    windowBatches++;
+    pendingRows = 0;
+
+    flushing.swap(pending);
+    for (Connection* connection : flushing) {
+        writeReply(connection);
+    }
+    flushing.clear();
+}
+
+void PolicyServer::writeReply(Connection* connection) {
+    while (connection->outSent < connection->outBytes) {
+        ssize_t sent = send(connection->fd, connection->out.data() + connection->outSent,
+                            connection->outBytes - connection->outSent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;  // EPOLLOUT resumes
+            }
+            closeConnection(connection);
+            return;
+        }
+        connection->outSent += sent;
+    }
+
+    if (connection->closing) {
+        closeConnection(connection);
+        return;
+    }
+    recordLatency(connection->received);
+    connection->busy = false;
+    busyConnections--;
+    connection->inBytes = 0;
+    connection->outBytes = 0;
+    connection->outSent = 0;
+    if (connection->readable) {
+        resume.push_back(connection);
+    }
+}
+
+void PolicyServer::handleModelChange() {
+    alignas(inotify_event) char buffer[4096];
+    bool changed = false;
+    while (true) {
+        ssize_t got = read(inotifyFd, buffer, sizeof(buffer));
+        if (got <= 0) {
+            break;
+        }
+        for (char* cursor = buffer; cursor < buffer + got;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+            if (event->wd == watchId && event->len > 0 && modelName == event->name) {
+                changed = true;
+            }
+            cursor += sizeof(inotify_event) + event->len;
+        }
+    }
+    if (changed) {
+        flush();  // Requests already in the batch get the model they were sent to
+        loadModel(false);
+    }
+}
+
+void PolicyServer::recordLatency(Clock::time_point received) {
+    long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - received).count();
+    latencies[windowRequests % latencyCapacity] = (uint32_t)std::min<long long>(nanoseconds, UINT32_MAX);
+    windowRequests++;
+}
+
+void PolicyServer::report() {
+    double seconds = std::chrono::duration<double>(Clock::now() - windowStart).count();
+    if (windowRequests > 0) {
+        size_t samples = std::min<uint64_t>(windowRequests, latencyCapacity);
+        std::copy(latencies.begin(), latencies.begin() + samples, sortScratch.begin());
+        auto percentile = [&](double p) {
+            auto nth = sortScratch.begin() + std::min(samples - 1, (size_t)(p * samples));
+            std::nth_element(sortScratch.begin(), nth, sortScratch.begin() + samples);
+            return *nth / 1000.0;
+        };
+        double p50 = percentile(0.50);
+        double p99 = percentile(0.99);
+        double maximum = *std::max_element(sortScratch.begin(), sortScratch.begin() + samples) / 1000.0;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Запросов/с: " << windowRequests / seconds
+                  << ", векторов/с: " << windowVectors / seconds
+                  << ", векторов в батче: " << (double)windowVectors / std::max<uint64_t>(1, windowBatches)
+                  << ", задержка p50 " << p50 << " мкс, p99 " << p99 << " мкс, макс. " << maximum
+                  << " мкс, клиентов: " << activeConnections << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+    }
+    windowRequests = windowVectors = windowBatches = 0;
+    windowStart = Clock::now();
+}
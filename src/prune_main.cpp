@@ -0,0 +1,315 @@
+#include "sparse_network.h"
+#include "batch_mlp.h"
+#include "policy_eval.h"
+#include "random_streams.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Magnitude pruning of a trained policy: for each target sparsity, remove the
+// smallest weights, recover with a short masked evolution-strategies phase,
+// store the result as a SparseNetwork and report its size, inference latency
+// and success rate on a fixed seeded set of holes.
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string inFile = "best_network.bin";
+    std::vector<float> sparsities = {0.0f, 0.5f, 0.7f, 0.8f, 0.9f, 0.95f};
+    float threshold = -1.0f;       // Prune by |w| < threshold instead of by sparsity
+    int evalEpisodes = 200;        // Fixed holes, same for every level
+    int trainEpisodes = 128;       // Fresh holes every fine-tuning iteration
+    int iterations = 20;           // Fine-tuning iterations at most (0 = off)
+    int population = 16;           // Mirrored perturbation pairs per iteration
+    float sigma = 0.02f;
+    float learningRate = 0.005f;
+    std::string savePrefix;
+    std::string csvFile;
+};
+
+struct LevelResult {
+    float targetSparsity;
+    float sparsity;
+    int nonZeros;
+    size_t denseBytes, sparseBytes;
+    double denseNs, sparseNs;
+    float prunedSuccess, tunedSuccess, tunedReturn;
+    int iterations;  // Fine-tuning iterations used
+};
+
+static PolicyEvaluation evaluateParams(BatchMlp& policy, const std::vector<float>& params,
+                                       const SimConfig& config, int episodes) {
+    policy.setParameters(params);
+    return evaluatePolicy(
+        [&](const Eigen::MatrixXf& observations, Eigen::MatrixXf& actions) { actions = policy.predict(observations); },
+        config, episodes);
+}
+
+// Success first, mean return as the tie-break
+static bool better(const PolicyEvaluation& a, const PolicyEvaluation& b) {
+    return a.successRate != b.successRate ? a.successRate > b.successRate : a.meanReturn > b.meanReturn;
+}
+
+// Mirrored-sampling ES on the surviving weights (OpenAI-ES with centered
+// ranks); pruned weights get no noise and stay exactly zero. Perturbations
+// are ranked by mean return, which is smoother than the success rate. Each
+// iteration flies fresh holes (never the evaluation ones); its step is kept
+// only if it does at least as well there, and tuning stops as soon as the
+// pruned network is as good as the unpruned one on them. Returns the
+// iterations used.
+static int fineTune(std::vector<float>& params, const std::vector<float>& mask, const std::vector<float>& original,
+                    const std::vector<int>& layers, const SimConfig& config, const Options& options) {
+    BatchMlp policy(layers, false, 0);
+    std::vector<std::vector<float>> noise(options.population, std::vector<float>(params.size()));
+    std::vector<float> fitness(2 * options.population), candidate(params.size());
+    std::vector<int> order(fitness.size());
+
+    for (int iteration = 0; iteration < options.iterations; iteration++) {
+        SimConfig trainConfig = config;
+        trainConfig.seed = deriveSeed(config.seed, SeedStream::Repeat, iteration + 1);
+        PolicyEvaluation current = evaluateParams(policy, params, trainConfig, options.trainEpisodes);
+        PolicyEvaluation reference = evaluateParams(policy, original, trainConfig, options.trainEpisodes);
+        if (current.successRate >= reference.successRate) {
+            return iteration;
+        }
+
+        std::mt19937 rng(deriveSeed32(config.seed, SeedStream::Mutation, iteration));
+        std::normal_distribution<float> gauss(0.0f, 1.0f);
+        for (int p = 0; p < options.population; p++) {
+            for (size_t i = 0; i < params.size(); i++) {
+                noise[p][i] = gauss(rng) * mask[i];
+            }
+            for (int sign = 0; sign < 2; sign++) {
+                float scale = sign ? -options.sigma : options.sigma;
+                for (size_t i = 0; i < params.size(); i++) {
+                    candidate[i] = params[i] + scale * noise[p][i];
+                }
+                fitness[2 * p + sign] = evaluateParams(policy, candidate, trainConfig, options.trainEpisodes).meanReturn;
+            }
+        }
+
+        // Centered ranks in [-0.5, 0.5]
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = (int)i;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return fitness[a] < fitness[b]; });
+        std::vector<float> rank(order.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            rank[order[i]] = (float)i / (order.size() - 1) - 0.5f;
+        }
+
+        float step = options.learningRate / (options.population * options.sigma);
+        candidate = params;
+        for (int p = 0; p < options.population; p++) {
+            float weight = rank[2 * p] - rank[2 * p + 1];
+            for (size_t i = 0; i < params.size(); i++) {
+                candidate[i] += step * weight * noise[p][i];
+            }
+        }
+        if (!better(current, evaluateParams(policy, candidate, trainConfig, options.trainEpisodes))) {
+            params.swap(candidate);
+        }
+    }
+    return options.iterations;
+}
+
+// ns per inference over a fixed set of inputs
+template <typename Run>
+static double measureNs(Run run, int inputs) {
+    long long calls = 0;
+    auto start = Clock::now();
+    double seconds = 0.0;
+    while (seconds < 0.2) {
+        for (int i = 0; i < inputs; i++) {
+            run(i);
+        }
+        calls += inputs;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return seconds * 1e9 / calls;
+}
+
+static bool parseList(const std::string& text, std::vector<float>& values) {
+    values.clear();
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        try {
+            values.push_back(std::stof(item));
+        } catch (...) {
+            return false;
+        }
+    }
+    return !values.empty();
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    config.seed = 1;
+    Options options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--in" && i + 1 < argc) {
+            options.inFile = argv[++i];
+        } else if (arg == "--sparsity" && i + 1 < argc) {
+            if (!parseList(argv[++i], options.sparsities)) {
+                std::cerr << "Неверный список разреженностей: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            options.threshold = std::stof(argv[++i]);
+        } else if (arg == "--eval-episodes" && i + 1 < argc) {
+            options.evalEpisodes = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--train-episodes" && i + 1 < argc) {
+            options.trainEpisodes = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--population" && i + 1 < argc) {
+            options.population = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--sigma" && i + 1 < argc) {
+            options.sigma = std::stof(argv[++i]);
+        } else if (arg == "--lr" && i + 1 < argc) {
+            options.learningRate = std::stof(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--save" && i + 1 < argc) {
+            options.savePrefix = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csvFile = argv[++i];
+        } else {
+            std::cout << "Использование: nndrons_prune [--in best_network.bin] [--sparsity 0,0.5,0.8,0.9 | --threshold T]\n"
+                      << "  [--eval-episodes N] [--train-episodes N] [--iterations N] [--population P]\n"
+                      << "  [--sigma S] [--lr LR] [--seed S] [--save PREFIX] [--csv FILE]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    NeuralNetwork original(config.layerSizes, 0u);
+    if (!original.load(options.inFile)) {
+        return 1;
+    }
+    const std::vector<int>& layers = original.getLayerSizes();
+    int weightCount = 0;
+    for (size_t l = 0; l + 1 < layers.size(); l++) {
+        weightCount += layers[l] * layers[l + 1];
+    }
+
+    // Inputs for the latency measurements
+    std::mt19937 inputRng(7);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    const int inputCount = 256;
+    std::vector<std::vector<float>> inputs(inputCount, std::vector<float>(layers.front()));
+    for (auto& input : inputs) {
+        for (float& v : input) {
+            v = value(inputRng);
+        }
+    }
+
+    if (options.threshold >= 0.0f) {
+        options.sparsities = {-1.0f};  // One level, by threshold
+    }
+    std::cout << "Seed проверки: " << config.seed << ", " << options.evalEpisodes << " эпизодов; дообучение "
+              << options.iterations << " итераций x " << 2 * options.population << " x "
+              << options.trainEpisodes << " эпизодов" << std::endl;
+
+    BatchMlp evalPolicy(layers, false, 0);
+    std::vector<LevelResult> results;
+    for (float target : options.sparsities) {
+        auto start = Clock::now();
+        NeuralNetwork network = original.clone();
+        float threshold = target >= 0.0f ? pruningThreshold(network, target) : options.threshold;
+        int zeros = pruneWeights(network, threshold);
+
+        std::vector<float> params, mask;
+        network.getParameters(params);
+        // Per layer: weights (only survivors tunable), then biases (always tunable)
+        mask.resize(params.size());
+        for (size_t l = 0, i = 0; l + 1 < layers.size(); l++) {
+            for (int w = 0; w < layers[l] * layers[l + 1]; w++, i++) {
+                mask[i] = params[i] != 0.0f ? 1.0f : 0.0f;
+            }
+            for (int b = 0; b < layers[l + 1]; b++, i++) {
+                mask[i] = 1.0f;
+            }
+        }
+
+        LevelResult result = {};
+        result.targetSparsity = target;
+        result.sparsity = (float)zeros / weightCount;
+        result.prunedSuccess = evaluateParams(evalPolicy, params, config, options.evalEpisodes).successRate;
+        std::vector<float> originalParams;
+        original.getParameters(originalParams);
+        if (zeros > 0 && options.iterations > 0) {
+            result.iterations = fineTune(params, mask, originalParams, layers, config, options);
+            network.setParameters(params);
+        }
+        PolicyEvaluation tuned = evaluateParams(evalPolicy, params, config, options.evalEpisodes);
+        result.tunedSuccess = tuned.successRate;
+        result.tunedReturn = tuned.meanReturn;
+
+        SparseNetwork sparse(network);
+        if (sparse.getLayerSizes().empty()) {
+            return 1;
+        }
+        result.nonZeros = sparse.getNonZeroCount();
+        result.denseBytes = (size_t)network.getParameterCount() * sizeof(float);
+        result.sparseBytes = sparse.getStorageBytes();
+
+        // The sparse kernel must compute what the dense network does
+        std::vector<float> output(layers.back());
+        double maxError = 0.0;
+        for (const auto& input : inputs) {
+            std::vector<float> expected = network.forward(input);
+            sparse.forward(input.data(), output.data());
+            for (size_t o = 0; o < output.size(); o++) {
+                maxError = std::max(maxError, (double)std::fabs(output[o] - expected[o]));
+            }
+        }
+        if (maxError > 1e-5) {
+            std::cerr << "Внимание: разреженная сеть расходится с плотной на " << maxError << std::endl;
+        }
+
+        result.denseNs = measureNs([&](int i) { output[0] = network.forward(inputs[i])[0]; }, inputCount);
+        result.sparseNs = measureNs([&](int i) { sparse.forward(inputs[i].data(), output.data()); }, inputCount);
+        results.push_back(result);
+
+        if (!options.savePrefix.empty()) {
+            std::string name = options.savePrefix + "_s" + std::to_string((int)std::round(result.sparsity * 100));
+            network.save(name + ".bin");
+            sparse.save(name + ".sparse");
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "разреженность " << std::setw(5) << result.sparsity * 100.0f << "% | ненулевых "
+                  << std::setw(5) << result.nonZeros << " | " << std::setw(5) << result.denseBytes << " -> "
+                  << std::setw(5) << result.sparseBytes << " байт | forward " << std::setw(6) << result.denseNs
+                  << " -> " << std::setw(6) << result.sparseNs << " нс | успех " << std::setw(5)
+                  << result.prunedSuccess * 100.0f << "% -> " << std::setw(5) << result.tunedSuccess * 100.0f
+                  << "% (итераций " << result.iterations << ", "
+                  << std::chrono::duration<float>(Clock::now() - start).count() << " с)" << std::endl;
+    }
+
+    if (!options.csvFile.empty()) {
+        std::ofstream file(options.csvFile);
+        if (!file.is_open()) {
+            std::cerr << "Ошибка открытия файла для сохранения: " << options.csvFile << std::endl;
+            return 1;
+        }
+        file << "target_sparsity,sparsity,nonzeros,dense_bytes,sparse_bytes,dense_ns,sparse_ns,"
+                "pruned_success,tuned_success,tuned_return,iterations\n";
+        for (const auto& r : results) {
+            file << r.targetSparsity << "," << r.sparsity << "," << r.nonZeros << "," << r.denseBytes << ","
+                 << r.sparseBytes << "," << r.denseNs << "," << r.sparseNs << "," << r.prunedSuccess << ","
+                 << r.tunedSuccess << "," << r.tunedReturn << "," << r.iterations << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include "swarm.h"
+#include "swarm_snapshot.h"
+#include "software_renderer.h"
+#include "frame_writer.h"
+#include "trace.h"
+#include "metrics_log.h"
+#include "episode_log.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// Headless training with CPU-rendered frames: for servers with no display or
+// GPU. Frames go to PPM/PNG files or a raw RGB24 stream, e.g.
+//   nndrons_record --format raw --out - | ffmpeg -f rawvideo -pix_fmt rgb24 -s 800x600 -r 30 -i - run.mp4
+int main(int argc, char** argv) {
+    SimConfig config;
+    int numDrones = 100;
+    int maxGenerations = 500;
+    FrameFormat format = FrameFormat::PPM;
+    std::string outPath = "frames";
+    int width = 800;
+    int height = 600;
+    int frameEvery = 2;     // One frame per N simulation steps (2 = 30 fps of simulated time)
+    int threads = 0;
+    long long maxFrames = -1;
+    bool loadNetwork = false;
+    std::string networkFile = "best_network.bin";
+    std::string traceFile;
+    std::string metricsFile;
+    std::string episodeFile;
+    EpisodeRecorder::Options episodeOptions;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--format" && i + 1 < argc) {
+            if (!parseFrameFormat(argv[++i], format)) {
+                std::cerr << "Неизвестный формат кадров: " << argv[i] << " (ppm/png/raw)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                std::cerr << "Неверный размер кадра: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--every" && i + 1 < argc) {
+            frameEvery = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            maxFrames = std::stoll(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "--drones" && i + 1 < argc) {
+            numDrones = std::stoi(argv[++i]);
+        } else if (arg == "--max-generations" && i + 1 < argc) {
+            maxGenerations = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-log" && i + 1 < argc) {
+            metricsFile = argv[++i];
+        } else if (arg == "--episode-log" && i + 1 < argc) {
+            episodeFile = argv[++i];
+        } else if (arg == "--episode-lz") {
+            episodeOptions.compress = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--load" || arg == "-l") {
+            loadNetwork = true;
+        } else if (arg == "--set" && i + 1 < argc) {
+            std::string assignment = argv[++i];
+            size_t eq = assignment.find('=');
+            if (eq == std::string::npos ||
+                !config.set(assignment.substr(0, eq), assignment.substr(eq + 1))) {
+                std::cerr << "Неверный параметр: " << assignment << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Использование: nndrons_record [--out DIR|FILE|-] [--format ppm|png|raw]\n"
+                      << "  [--size WxH] [--every N] [--frames N] [--threads T] [--drones N]\n"
+                      << "  [--max-generations G] [--load] [--seed S] [--trace FILE.json]\n"
+                      << "  [--metrics-log FILE.csv|.jsonl|.bin] [--episode-log FILE [--episode-lz]]\n"
+                      << "  [--set name=value]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Raw frames on stdout - keep all text on stderr
+    if (format == FrameFormat::Raw && outPath == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    if (!traceFile.empty()) {
+        if (Trace::compiledIn()) {
+            Trace::setEnabled(true);
+            Trace::setThreadName("main");
+        } else {
+            std::cerr << "Трассировка отключена при сборке (cmake -DNNDRONS_TRACE=ON)" << std::endl;
+            traceFile.clear();
+        }
+    }
+
+    FrameWriter writer(format, outPath);
+    if (!writer.isOpen()) {
+        return 1;
+    }
+
+    MetricsLog metricsLog(metricsFile);
+    if (!metricsLog.isOpen()) {
+        return 1;
+    }
+    metricsLog.subscribe(makeConsoleReporter(1.0f));
+
+    Swarm swarm(numDrones, config);
+    swarm.setMetricsLog(&metricsLog);
+    std::cout << "Seed: " << swarm.getConfig().seed << std::endl;
+
+    std::unique_ptr<EpisodeRecorder> episodeRecorder;
+    if (!episodeFile.empty()) {
+        episodeRecorder.reset(new EpisodeRecorder(episodeFile, episodeOptions, swarm.getConfig().seed));
+        if (!episodeRecorder->isOpen()) {
+            return 1;
+        }
+        swarm.setEpisodeRecorder(episodeRecorder.get());
+    }
+    if (loadNetwork) {
+        swarm.loadNetwork(networkFile);
+    }
+
+    SoftwareRenderer renderer(width, height, threads);
+    SwarmSnapshot snapshot;
+
+    const float targetDt = 1.0f / 60.0f;
+    long long step = 0;
+    long long frames = 0;
+    double renderSeconds = 0.0;
+
+    while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < maxGenerations &&
+           (maxFrames < 0 || frames < maxFrames)) {
+        swarm.update(targetDt);
+
+        if (step++ % frameEvery == 0 || swarm.hasAnyDroneSucceeded()) {
+            auto start = std::chrono::high_resolution_clock::now();
+            snapshot.capture(swarm);
+            renderer.render(snapshot);
+            renderSeconds += std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            // Encoding and file I/O happen on the writer thread
+            writer.submit(renderer.getFramebuffer());
+            frames++;
+        }
+    }
+
+    metricsLog.flush();
+    std::cerr << "Кадров: " << frames << " (" << width << "x" << height << ", " << numDrones
+              << " дронов, потоков рендера " << renderer.getNumThreads() << "), рендер "
+              << std::fixed << std::setprecision(2) << (frames ? renderSeconds * 1000.0 / frames : 0.0)
+              << " мс/кадр (" << std::setprecision(1) << (renderSeconds > 0 ? frames / renderSeconds : 0.0)
+              << " кадр/с)" << std::endl;
+    std::cerr << "Поколение: " << swarm.getGeneration()
+              << (swarm.hasAnyDroneSucceeded() ? " (дрон нашёл дыру)" : "") << std::endl;
+
+    if (!traceFile.empty()) {
+        Trace::writeChromeJson(traceFile);
+    }
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include "renderer.h"
+#include "trace.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <initializer_list>
+#include <cstdio>
 
 #ifdef __APPLE__
 #define GL_SILENCE_DEPRECATION
@@ -9,15 +13,257 @@
 #else
 #include <GL/gl.h>
 #include <GL/glu.h>
+#include <GL/glext.h>
 #endif
 
+// Color of a drone by status
+static void droneColor(DroneSnapshot::Status status, float& r, float& g, float& b) {
+    if (status == DroneSnapshot::Successful) {
+        r = 0.2f; g = 1.0f; b = 0.2f; // Green for successful
+    } else if (status == DroneSnapshot::Failed) {
+        r = 1.0f; g = 0.2f; b = 0.2f; // Red for failed
+    } else {
+        r = 0.3f; g = 0.5f; b = 1.0f; // Blue for active
+    }
+}
+
+#ifndef __APPLE__
+// Buffer/shader/instancing entry points (GL 2.0 + 3.3), loaded at runtime through
+// GLFW since only GL 1.1 is guaranteed to be exported by the system library
+static struct {
+    PFNGLGENBUFFERSPROC genBuffers;
+    PFNGLDELETEBUFFERSPROC deleteBuffers;
+    PFNGLBINDBUFFERPROC bindBuffer;
+    PFNGLBUFFERDATAPROC bufferData;
+    PFNGLBUFFERSUBDATAPROC bufferSubData;
+    PFNGLCREATESHADERPROC createShader;
+    PFNGLSHADERSOURCEPROC shaderSource;
+    PFNGLCOMPILESHADERPROC compileShader;
+    PFNGLGETSHADERIVPROC getShaderiv;
+    PFNGLGETSHADERINFOLOGPROC getShaderInfoLog;
+    PFNGLDELETESHADERPROC deleteShader;
+    PFNGLCREATEPROGRAMPROC createProgram;
+    PFNGLATTACHSHADERPROC attachShader;
+    PFNGLBINDATTRIBLOCATIONPROC bindAttribLocation;
+    PFNGLLINKPROGRAMPROC linkProgram;
+    PFNGLGETPROGRAMIVPROC getProgramiv;
+    PFNGLDELETEPROGRAMPROC deleteProgram;
+    PFNGLUSEPROGRAMPROC useProgram;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC enableVertexAttribArray;
+    PFNGLDISABLEVERTEXATTRIBARRAYPROC disableVertexAttribArray;
+    PFNGLVERTEXATTRIBPOINTERPROC vertexAttribPointer;
+    PFNGLVERTEXATTRIBDIVISORPROC vertexAttribDivisor;
+    PFNGLDRAWELEMENTSINSTANCEDPROC drawElementsInstanced;
+    PFNGLGETUNIFORMLOCATIONPROC getUniformLocation;
+    PFNGLUNIFORM1FPROC uniform1f;
+    PFNGLUNIFORM3FPROC uniform3f;
+
+    // Trails (GL 4.4 / ARB_buffer_storage)
+    PFNGLBUFFERSTORAGEPROC bufferStorage;
+    PFNGLMAPBUFFERRANGEPROC mapBufferRange;
+    PFNGLUNMAPBUFFERPROC unmapBuffer;
+    PFNGLFENCESYNCPROC fenceSync;
+    PFNGLCLIENTWAITSYNCPROC clientWaitSync;
+    PFNGLDELETESYNCPROC deleteSync;
+    PFNGLMULTIDRAWARRAYSPROC multiDrawArrays;
+} gl;
+
+template <typename T>
+static bool loadProc(T& proc, const char* name) {
+    proc = reinterpret_cast<T>(glfwGetProcAddress(name));
+    return proc != nullptr;
+}
+
+// glfwGetProcAddress may hand out a stub for any name (GLX does), so a
+// non-null pointer proves nothing: check the context version or extension first
+static bool glVersionAtLeast(int major, int minor) {
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    int haveMajor = 0, haveMinor = 0;
+    if (!version || std::sscanf(version, "%d.%d", &haveMajor, &haveMinor) != 2) {
+        return false;
+    }
+    return haveMajor > major || (haveMajor == major && haveMinor >= minor);
+}
+
+// GL 3.3, or the ARB entry points on a GL 2.1 context (the shaders are GLSL 1.20)
+static bool loadInstancingFunctions() {
+    bool core = glVersionAtLeast(3, 3);
+    if (!core && !(glVersionAtLeast(2, 1) && glfwExtensionSupported("GL_ARB_instanced_arrays"))) {
+        return false;
+    }
+    return loadProc(gl.genBuffers, "glGenBuffers") &&
+           loadProc(gl.deleteBuffers, "glDeleteBuffers") &&
+           loadProc(gl.bindBuffer, "glBindBuffer") &&
+           loadProc(gl.bufferData, "glBufferData") &&
+           loadProc(gl.bufferSubData, "glBufferSubData") &&
+           loadProc(gl.createShader, "glCreateShader") &&
+           loadProc(gl.shaderSource, "glShaderSource") &&
+           loadProc(gl.compileShader, "glCompileShader") &&
+           loadProc(gl.getShaderiv, "glGetShaderiv") &&
+           loadProc(gl.getShaderInfoLog, "glGetShaderInfoLog") &&
+           loadProc(gl.deleteShader, "glDeleteShader") &&
+           loadProc(gl.createProgram, "glCreateProgram") &&
+           loadProc(gl.attachShader, "glAttachShader") &&
+           loadProc(gl.bindAttribLocation, "glBindAttribLocation") &&
+           loadProc(gl.linkProgram, "glLinkProgram") &&
+           loadProc(gl.getProgramiv, "glGetProgramiv") &&
+           loadProc(gl.deleteProgram, "glDeleteProgram") &&
+           loadProc(gl.useProgram, "glUseProgram") &&
+           loadProc(gl.enableVertexAttribArray, "glEnableVertexAttribArray") &&
+           loadProc(gl.disableVertexAttribArray, "glDisableVertexAttribArray") &&
+           loadProc(gl.vertexAttribPointer, "glVertexAttribPointer") &&
+           loadProc(gl.vertexAttribDivisor, core ? "glVertexAttribDivisor" : "glVertexAttribDivisorARB") &&
+           loadProc(gl.drawElementsInstanced, core ? "glDrawElementsInstanced" : "glDrawElementsInstancedARB") &&
+           loadProc(gl.getUniformLocation, "glGetUniformLocation") &&
+           loadProc(gl.uniform1f, "glUniform1f") &&
+           loadProc(gl.uniform3f, "glUniform3f");
+}
+
+// GL 4.4, or ARB_buffer_storage on GL 3.2+ (fences, glMapBufferRange)
+static bool loadTrailFunctions() {
+    if (!glVersionAtLeast(4, 4) && !(glVersionAtLeast(3, 2) && glfwExtensionSupported("GL_ARB_buffer_storage"))) {
+        return false;
+    }
+    return loadProc(gl.bufferStorage, "glBufferStorage") &&
+           loadProc(gl.mapBufferRange, "glMapBufferRange") &&
+           loadProc(gl.unmapBuffer, "glUnmapBuffer") &&
+           loadProc(gl.fenceSync, "glFenceSync") &&
+           loadProc(gl.clientWaitSync, "glClientWaitSync") &&
+           loadProc(gl.deleteSync, "glDeleteSync") &&
+           loadProc(gl.multiDrawArrays, "glMultiDrawArrays");
+}
+
+// Sphere instances in the compatibility profile: camera comes from the
+// fixed-function matrices, lighting matches GL_LIGHT0 set up in init()
+static const char* instanceVertexShader = R"(
+#version 120
+attribute vec3 vertex;     // Unit sphere (position = normal)
+attribute vec4 instance;   // xyz = center, w = radius
+attribute vec3 color;
+uniform float vertexScale; // 0 for point sprites: the vertex only supplies a normal
+uniform float pointScale;  // Pixels per unit at distance 1
+varying vec3 shadedColor;
+void main() {
+    vec4 eye = gl_ModelViewMatrix * vec4(instance.xyz + vertex * instance.w * vertexScale, 1.0);
+    gl_PointSize = max(1.0, 2.0 * instance.w * pointScale / -eye.z);
+    vec3 normal = normalize(gl_NormalMatrix * vertex);
+    vec3 toLight = normalize(vec3(10.0, 10.0, 10.0) - eye.xyz);
+    // Global ambient 0.2 + light ambient 0.3 + light diffuse 0.8
+    shadedColor = color * (0.5 + 0.8 * max(dot(normal, toLight), 0.0));
+    gl_Position = gl_ProjectionMatrix * eye;
+}
+)";
+
+static const char* instanceFragmentShader = R"(
+#version 120
+varying vec3 shadedColor;
+void main() {
+    gl_FragColor = vec4(min(shadedColor, vec3(1.0)), 1.0);
+}
+)";
+
+// Trail vertices fade out with age (in samples)
+static const char* trailVertexShader = R"(
+#version 120
+attribute vec4 trailSample;  // xyz = position, w = sample number
+uniform float newestSample;
+uniform float trailLength;
+varying float alpha;
+void main() {
+    alpha = 1.0 - (newestSample - trailSample.w) / trailLength;
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(trailSample.xyz, 1.0);
+}
+)";
+
+static const char* trailFragmentShader = R"(
+#version 120
+uniform vec3 color;
+varying float alpha;
+void main() {
+    gl_FragColor = vec4(color, 0.8 * alpha);
+}
+)";
+
+static GLuint compileShader(GLenum type, const char* source) {
+    GLuint shader = gl.createShader(type);
+    gl.shaderSource(shader, 1, &source, nullptr);
+    gl.compileShader(shader);
+
+    GLint ok = GL_FALSE;
+    gl.getShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[512];
+        gl.getShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "Ошибка компиляции шейдера: " << log << std::endl;
+        gl.deleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+// Link a program from vertex + fragment source; attribute names bound to 0, 1, 2...
+static GLuint linkProgram(const char* vertexSource, const char* fragmentSource,
+                          std::initializer_list<const char*> attributes) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vs || !fs) {
+        if (vs) gl.deleteShader(vs);
+        if (fs) gl.deleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = gl.createProgram();
+    gl.attachShader(program, vs);
+    gl.attachShader(program, fs);
+    GLuint location = 0;
+    for (const char* name : attributes) {
+        gl.bindAttribLocation(program, location++, name);
+    }
+    gl.linkProgram(program);
+    gl.deleteShader(vs);
+    gl.deleteShader(fs);
+
+    GLint linked = GL_FALSE;
+    gl.getProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        gl.deleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+#endif
+
+// Instance layout: center xyz, radius, color rgb
+static const int instanceFloats = 7;
+
 Renderer::Renderer(int width, int height)
     : window(nullptr), width(width), height(height),
-      cameraDistance(50.0f), cameraAngleX(10.0f), cameraAngleY(0.0f) {  // INCREASED from 25 to 50 - дроны стартуют на -35!
+      cameraDistance(50.0f), cameraAngleX(10.0f), cameraAngleY(0.0f),  // INCREASED from 25 to 50 - дроны стартуют на -35!
+      pixelsPerUnit(1.0f), instancing(false), sphereVbo(0), sphereIbo(0), instanceVbo(0), instanceProgram(0),
+      trailsAvailable(false), trailsEnabled(false), trailKeyDown(false), trailLength(60),
+      trailVbo(0), trailProgram(0), trailMapped(nullptr), trailFence(nullptr),
+      trailDrones(0), trailGeneration(-1), trailSteps(-1), trailSample(0), hudKeyDown(false) {
+    std::fill(sphereLists, sphereLists + LodPoint, 0);
 }
 
 Renderer::~Renderer() {
     if (window) {
+        // GL objects belong to this window's context
+        glfwMakeContextCurrent(window);
+#ifndef __APPLE__
+        releaseTrails();
+        if (trailProgram) {
+            gl.deleteProgram(trailProgram);
+        }
+        if (instancing) {
+            GLuint buffers[] = {sphereVbo, sphereIbo, instanceVbo};
+            gl.deleteBuffers(3, buffers);
+            gl.deleteProgram(instanceProgram);
+        }
+#endif
+        if (sphereLists[0]) {
+            glDeleteLists(sphereLists[0], LodPoint);
+        }
         glfwDestroyWindow(window);
     }
     glfwTerminate();
@@ -59,29 +305,307 @@ bool Renderer::init() {
 
     glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
 
+    // Drones are scaled unit spheres - keep normals unit length in the fixed-function path
+    glEnable(GL_NORMALIZE);
+
+    // Build the spheres once instead of a GLU quadric per drone per frame
+    sphereVertices.clear();
+    sphereIndices.clear();
+    sphereMeshes[LodHigh] = appendSphereMesh(16, 16);
+    sphereMeshes[LodMedium] = appendSphereMesh(8, 6);
+    sphereMeshes[LodLow] = appendSphereMesh(5, 3);
+    // Point sprite: one vertex whose normal faces the +z light side
+    sphereMeshes[LodPoint] = {static_cast<int>(sphereIndices.size()), 1};
+    sphereIndices.push_back(sphereVertices.size() / 3);
+    sphereVertices.insert(sphereVertices.end(), {0.0f, 0.0f, 1.0f});
+
+    instancing = initInstancing();
+    trailsAvailable = instancing && initTrails();
+
+    if (!instancing) {
+        sphereLists[0] = glGenLists(LodPoint);
+        for (int lod = 0; lod < LodPoint; lod++) {
+            sphereLists[lod] = sphereLists[0] + lod;
+            const SphereMesh& mesh = sphereMeshes[lod];
+            glNewList(sphereLists[lod], GL_COMPILE);
+            glBegin(GL_TRIANGLES);
+            for (int i = mesh.firstIndex; i < mesh.firstIndex + mesh.indexCount; i++) {
+                const float* v = &sphereVertices[sphereIndices[i] * 3];
+                glNormal3f(v[0], v[1], v[2]);
+                glVertex3f(v[0], v[1], v[2]);
+            }
+            glEnd();
+            glEndList();
+        }
+        std::cout << "Инстансинг недоступен - дроны рисуются через display list" << std::endl;
+    }
+
     return true;
 }
 
-void Renderer::render(const Swarm& swarm) {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+Renderer::SphereMesh Renderer::appendSphereMesh(int slices, int stacks) {
+    SphereMesh mesh;
+    mesh.firstIndex = static_cast<int>(sphereIndices.size());
+    unsigned short base = sphereVertices.size() / 3;
+
+    for (int i = 0; i <= stacks; i++) {
+        float phi = M_PI * i / stacks;  // 0 at the top pole
+        for (int j = 0; j <= slices; j++) {
+            float theta = 2.0f * M_PI * j / slices;
+            sphereVertices.push_back(std::sin(phi) * std::cos(theta));
+            sphereVertices.push_back(std::cos(phi));
+            sphereVertices.push_back(std::sin(phi) * std::sin(theta));
+        }
+    }
+
+    // Counter-clockwise when seen from outside
+    for (int i = 0; i < stacks; i++) {
+        for (int j = 0; j < slices; j++) {
+            unsigned short a = base + i * (slices + 1) + j;
+            unsigned short b = a + slices + 1;
+            sphereIndices.insert(sphereIndices.end(), {a, (unsigned short)(a + 1), b});
+            sphereIndices.insert(sphereIndices.end(), {(unsigned short)(a + 1), (unsigned short)(b + 1), b});
+        }
+    }
+
+    mesh.indexCount = static_cast<int>(sphereIndices.size()) - mesh.firstIndex;
+    return mesh;
+}
+
+bool Renderer::initInstancing() {
+#ifdef __APPLE__
+    // Legacy macOS contexts are GL 2.1 without core instancing
+    return false;
+#else
+    if (!loadInstancingFunctions()) {
+        return false;
+    }
+
+    instanceProgram = linkProgram(instanceVertexShader, instanceFragmentShader,
+                                  {"vertex", "instance", "color"});
+    if (!instanceProgram) {
+        return false;
+    }
+
+    GLuint buffers[3];
+    gl.genBuffers(3, buffers);
+    sphereVbo = buffers[0];
+    sphereIbo = buffers[1];
+    instanceVbo = buffers[2];
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, sphereVbo);
+    gl.bufferData(GL_ARRAY_BUFFER, sphereVertices.size() * sizeof(float),
+                  sphereVertices.data(), GL_STATIC_DRAW);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereIbo);
+    gl.bufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices.size() * sizeof(unsigned short),
+                  sphereIndices.data(), GL_STATIC_DRAW);
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    return true;
+#endif
+}
+
+bool Renderer::initTrails() {
+#ifdef __APPLE__
+    return false;
+#else
+    if (!loadTrailFunctions()) {
+        return false;
+    }
+    trailProgram = linkProgram(trailVertexShader, trailFragmentShader, {"trailSample"});
+    return trailProgram != 0;
+#endif
+}
+
+void Renderer::setTrailLength(int samples) {
+    samples = std::max(2, samples);
+    if (samples != trailLength) {
+        trailLength = samples;
+        releaseTrails();  // Reallocated at the new size on the next update
+    }
+}
+
+bool Renderer::allocateTrails(int numDrones) {
+#ifdef __APPLE__
+    return false;
+#else
+    releaseTrails();
+    if (numDrones == 0) {
+        return true;
+    }
 
-    // Setup camera
-    setupCamera();
+    // Immutable storage mapped once for the buffer's lifetime: writes go straight
+    // to memory the GPU reads, no per-frame map/unmap or driver copies
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr bytes = (GLsizeiptr)numDrones * 2 * trailLength * 4 * sizeof(float);
 
-    // Draw environment
-    drawWall(swarm.getEnvironment());
-    drawHole(swarm.getEnvironment());
+    gl.genBuffers(1, &trailVbo);
+    gl.bindBuffer(GL_ARRAY_BUFFER, trailVbo);
+    gl.bufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags);
+    trailMapped = static_cast<float*>(gl.mapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
 
-    // Draw drones
-    for (const auto& drone : swarm.getDrones()) {
-        drawDrone(*drone);
+    if (!trailMapped) {
+        std::cerr << "Ошибка отображения буфера следов" << std::endl;
+        releaseTrails();
+        return false;
     }
 
-    // Draw info text (generation, best fitness)
-    // Note: Text rendering in OpenGL is complex, so we'll skip for now
-    // You can add it later using a library like FreeType
+    trailDrones = numDrones;
+    trailFirsts.resize(numDrones);
+    trailCounts.assign(numDrones, trailLength);
+    trailGeneration = -1;  // Fill on the next update
+    return true;
+#endif
+}
 
-    glfwSwapBuffers(window);
+void Renderer::releaseTrails() {
+#ifndef __APPLE__
+    if (trailFence) {
+        gl.deleteSync(static_cast<GLsync>(trailFence));
+        trailFence = nullptr;
+    }
+    if (trailVbo) {
+        if (trailMapped) {
+            gl.bindBuffer(GL_ARRAY_BUFFER, trailVbo);
+            gl.unmapBuffer(GL_ARRAY_BUFFER);
+            gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+        gl.deleteBuffers(1, &trailVbo);
+    }
+#endif
+    trailVbo = 0;
+    trailMapped = nullptr;
+    trailDrones = 0;
+}
+
+void Renderer::updateTrails(const SwarmSnapshot& snapshot) {
+    TRACE_SCOPE("Renderer::updateTrails");
+
+#ifndef __APPLE__
+    int numDrones = static_cast<int>(snapshot.drones.size());
+    if (numDrones != trailDrones && !allocateTrails(numDrones)) {
+        trailsEnabled = false;
+        return;
+    }
+
+    // Drones jump back to the start on a new generation - restart the trails
+    bool restart = snapshot.generation != trailGeneration;
+    if (!restart && snapshot.simulatedSteps == trailSteps) {
+        return;  // Simulation hasn't published anything new
+    }
+
+    // The previous frame's draw may still be reading the slots we are about to overwrite
+    if (trailFence) {
+        gl.clientWaitSync(static_cast<GLsync>(trailFence), GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+        gl.deleteSync(static_cast<GLsync>(trailFence));
+        trailFence = nullptr;
+    }
+
+    const int droneStride = 2 * trailLength * 4;
+    if (restart) {
+        trailSample = 0;
+        trailGeneration = snapshot.generation;
+        for (int i = 0; i < numDrones; i++) {
+            const Vec3& pos = snapshot.drones[i].position;
+            float* out = trailMapped + (size_t)i * droneStride;
+            for (int s = 0; s < 2 * trailLength; s++, out += 4) {
+                out[0] = pos.x; out[1] = pos.y; out[2] = pos.z; out[3] = 0.0f;
+            }
+        }
+    } else {
+        // Only the newest sample per drone, written to both copies of its slot
+        trailSample++;
+        int slot = trailSample % trailLength;
+        for (int i = 0; i < numDrones; i++) {
+            const Vec3& pos = snapshot.drones[i].position;
+            float* out = trailMapped + (size_t)i * droneStride + slot * 4;
+            float* mirror = out + trailLength * 4;
+            out[0] = mirror[0] = pos.x;
+            out[1] = mirror[1] = pos.y;
+            out[2] = mirror[2] = pos.z;
+            out[3] = mirror[3] = (float)trailSample;
+        }
+    }
+    trailSteps = snapshot.simulatedSteps;
+#else
+    (void)snapshot;
+#endif
+}
+
+void Renderer::drawTrails() {
+    TRACE_SCOPE("Renderer::drawTrails");
+
+#ifndef __APPLE__
+    if (!trailDrones) {
+        return;
+    }
+
+    // Newest trailLength samples: slots [slot + 1, slot + trailLength]
+    int slot = trailSample % trailLength;
+    for (int i = 0; i < trailDrones; i++) {
+        trailFirsts[i] = i * 2 * trailLength + slot + 1;
+    }
+
+    gl.useProgram(trailProgram);
+    gl.uniform1f(gl.getUniformLocation(trailProgram, "newestSample"), (float)trailSample);
+    gl.uniform1f(gl.getUniformLocation(trailProgram, "trailLength"), (float)trailLength);
+    gl.uniform3f(gl.getUniformLocation(trailProgram, "color"), 1.0f, 0.9f, 0.3f);
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, trailVbo);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+
+    // All drones in one call
+    gl.multiDrawArrays(GL_LINE_STRIP, trailFirsts.data(), trailCounts.data(), trailDrones);
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    gl.disableVertexAttribArray(0);
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.useProgram(0);
+
+    trailFence = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
+
+void Renderer::render(const SwarmSnapshot& snapshot) {
+    TRACE_SCOPE("Renderer::render");
+
+    {
+        ScopedZoneTimer timer(MetricZone::Render);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Setup camera
+        setupCamera();
+
+        // Draw environment
+        drawWall(snapshot);
+        drawHole(snapshot);
+
+        // Draw drones
+        drawDrones(snapshot);
+
+        // Recent paths (T)
+        if (trailsEnabled) {
+            updateTrails(snapshot);
+            drawTrails();
+        }
+    }
+
+    // Performance overlay (H); its own drawing is not counted as Render
+    hud.update(snapshot);
+    hud.draw(width, height);
+
+    {
+        TRACE_SCOPE("Renderer::swapBuffers");
+        glfwSwapBuffers(window);
+    }
     glfwPollEvents();
 }
 
@@ -113,6 +637,24 @@ void Renderer::processInput() {
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
         cameraDistance += 0.5f;
     }
+
+    // Toggle trails on key press (not while held)
+    bool trailKey = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+    if (trailKey && !trailKeyDown) {
+        if (trailsAvailable) {
+            trailsEnabled = !trailsEnabled;
+            trailGeneration = -1;  // Start fresh instead of showing stale samples
+        } else {
+            std::cout << "Следы недоступны: нужен OpenGL 4.4 или GL_ARB_buffer_storage" << std::endl;
+        }
+    }
+    trailKeyDown = trailKey;
+
+    bool hudKey = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+    if (hudKey && !hudKeyDown) {
+        hud.setVisible(!hud.isVisible());
+    }
+    hudKeyDown = hudKey;
 }
 
 void Renderer::setupCamera() {
@@ -134,30 +676,193 @@ void Renderer::setupCamera() {
     gluLookAt(camX, camY, camZ,     // Camera position (behind drones)
               0.0, 0.0, -17.5,       // Look at center of action (was 0,0,0)
               0.0, 1.0, 0.0);        // Up vector
+
+    // Same frustum on the CPU for culling (avoids reading matrices back from GL)
+    cameraPos = Vec3(camX, camY, camZ);
+    Vec3 forward = (Vec3(0.0f, 0.0f, -17.5f) - cameraPos).normalized();
+    Vec3 right = Vec3(-forward.z, 0.0f, forward.x).normalized();        // forward x (0, 1, 0)
+    Vec3 up(right.y * forward.z - right.z * forward.y,                  // right x forward
+            right.z * forward.x - right.x * forward.z,
+            right.x * forward.y - right.y * forward.x);
+    float tanHalfY = std::tan(30.0f * M_PI / 180.0f);
+    float tanHalfX = tanHalfY * width / height;
+    pixelsPerUnit = 0.5f * height / tanHalfY;
+
+    // Side planes through the camera: inside when tan * depth >= lateral offset
+    frustumNormals[0] = (forward * tanHalfX + right).normalized();
+    frustumNormals[1] = (forward * tanHalfX - right).normalized();
+    frustumNormals[2] = (forward * tanHalfY + up).normalized();
+    frustumNormals[3] = (forward * tanHalfY - up).normalized();
+    for (int i = 0; i < 4; i++) {
+        frustumOffsets[i] = -frustumNormals[i].dot(cameraPos);
+    }
+    frustumNormals[4] = forward;                                  // Near (0.1)
+    frustumOffsets[4] = -forward.dot(cameraPos) - 0.1f;
+    frustumNormals[5] = forward * -1.0f;                          // Far (1000)
+    frustumOffsets[5] = forward.dot(cameraPos) + 1000.0f;
 }
 
-void Renderer::drawSphere(const Vec3& position, float radius, float r, float g, float b) {
-    glPushMatrix();
-    glTranslatef(position.x, position.y, position.z);
+int Renderer::classifyDrone(const DroneSnapshot& drone) const {
+    for (int i = 0; i < 6; i++) {
+        if (frustumNormals[i].dot(drone.position) + frustumOffsets[i] < -drone.radius) {
+            return LodCount;  // Entirely outside this plane
+        }
+    }
+
+    // Distance bands scaled by drone size: pick the mesh from the projected radius in pixels
+    float distance = std::max((drone.position - cameraPos).length(), 0.001f);
+    float radiusPixels = drone.radius * pixelsPerUnit / distance;
+    if (radiusPixels >= 12.0f) {
+        return LodHigh;
+    } else if (radiusPixels >= 4.0f) {
+        return LodMedium;
+    } else if (radiusPixels >= 1.5f) {
+        return LodLow;
+    }
+    return LodPoint;
+}
+
+void Renderer::drawSphere(const Vec3& position, float radius, float r, float g, float b, int lod) {
     glColor3f(r, g, b);
 
-    // Draw sphere using quad strips (simple method)
-    const int slices = 16;
-    const int stacks = 16;
+    if (lod == LodPoint) {
+        glPointSize(2.0f);
+        glBegin(GL_POINTS);
+        glNormal3f(0.0f, 0.0f, 1.0f);
+        glVertex3f(position.x, position.y, position.z);
+        glEnd();
+        return;
+    }
+
+    glPushMatrix();
+    glTranslatef(position.x, position.y, position.z);
+    glScalef(radius, radius, radius);
 
-    GLUquadric* quad = gluNewQuadric();
-    gluSphere(quad, radius, slices, stacks);
-    gluDeleteQuadric(quad);
+    // Unit sphere mesh compiled once in init()
+    glCallList(sphereLists[lod]);
 
     glPopMatrix();
 }
 
-void Renderer::drawWall(const Environment& env) {
+void Renderer::drawDrones(const SwarmSnapshot& snapshot) {
+    TRACE_SCOPE("Renderer::drawDrones");
+
+    stats = RenderStats();
+    const auto& drones = snapshot.drones;
+    if (drones.empty()) {
+        return;
+    }
+
+    // Cull and pick a detail level per drone
+    droneLods.resize(drones.size());
+    for (size_t i = 0; i < drones.size(); i++) {
+        int lod = classifyDrone(drones[i]);
+        droneLods[i] = lod;
+        if (lod == LodCount) {
+            stats.culled++;
+        } else {
+            stats.drawn[lod]++;
+        }
+    }
+
+    if (!instancing) {
+        for (size_t i = 0; i < drones.size(); i++) {
+            if (droneLods[i] != LodCount) {
+                drawDrone(drones[i], droneLods[i]);
+            }
+        }
+        return;
+    }
+
+#ifndef __APPLE__
+    // Per-frame instance data straight from the snapshot, grouped by LOD
+    int lodStart[LodCount + 1] = {0};
+    for (int lod = 0; lod < LodCount; lod++) {
+        lodStart[lod + 1] = lodStart[lod] + stats.drawn[lod];
+    }
+    int visible = lodStart[LodCount];
+    if (visible == 0) {
+        return;
+    }
+
+    instanceData.resize(visible * instanceFloats);
+    int fill[LodCount];
+    std::copy(lodStart, lodStart + LodCount, fill);
+    for (size_t i = 0; i < drones.size(); i++) {
+        if (droneLods[i] == LodCount) {
+            continue;
+        }
+        const DroneSnapshot& drone = drones[i];
+        float* out = &instanceData[fill[droneLods[i]]++ * instanceFloats];
+        out[0] = drone.position.x;
+        out[1] = drone.position.y;
+        out[2] = drone.position.z;
+        out[3] = drone.radius;
+        droneColor(drone.status, out[4], out[5], out[6]);
+    }
+
+    gl.useProgram(instanceProgram);
+    gl.uniform1f(gl.getUniformLocation(instanceProgram, "pointScale"), pixelsPerUnit);
+    GLint vertexScale = gl.getUniformLocation(instanceProgram, "vertexScale");
+
+    gl.bindBuffer(GL_ARRAY_BUFFER, sphereVbo);
+    gl.enableVertexAttribArray(0);
+    gl.vertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+
+    // Orphan the old storage so the driver doesn't stall on the previous frame
+    GLsizeiptr bytes = instanceData.size() * sizeof(float);
+    gl.bindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    gl.bufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    gl.bufferSubData(GL_ARRAY_BUFFER, 0, bytes, instanceData.data());
+
+    const GLsizei stride = instanceFloats * sizeof(float);
+    gl.enableVertexAttribArray(1);
+    gl.vertexAttribDivisor(1, 1);
+    gl.enableVertexAttribArray(2);
+    gl.vertexAttribDivisor(2, 1);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereIbo);
+
+    // One instanced call per non-empty LOD; instance attributes start at its group
+    for (int lod = 0; lod < LodCount; lod++) {
+        if (stats.drawn[lod] == 0) {
+            continue;
+        }
+        size_t offset = (size_t)lodStart[lod] * stride;
+        gl.vertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(offset));
+        gl.vertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride,
+                               reinterpret_cast<void*>(offset + 4 * sizeof(float)));
+
+        const SphereMesh& mesh = sphereMeshes[lod];
+        const void* indices = reinterpret_cast<void*>(mesh.firstIndex * sizeof(unsigned short));
+        if (lod == LodPoint) {
+            glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+            gl.uniform1f(vertexScale, 0.0f);
+            gl.drawElementsInstanced(GL_POINTS, mesh.indexCount, GL_UNSIGNED_SHORT, indices, stats.drawn[lod]);
+            glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+        } else {
+            gl.uniform1f(vertexScale, 1.0f);
+            gl.drawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_SHORT, indices, stats.drawn[lod]);
+        }
+    }
+
+    // Restore state for the fixed-function drawing
+    gl.vertexAttribDivisor(1, 0);
+    gl.vertexAttribDivisor(2, 0);
+    gl.disableVertexAttribArray(0);
+    gl.disableVertexAttribArray(1);
+    gl.disableVertexAttribArray(2);
+    gl.bindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl.useProgram(0);
+#endif
+}
+
+void Renderer::drawWall(const SwarmSnapshot& snapshot) {
     glPushMatrix();
 
-    float wallZ = env.getWallZ();
-    Vec3 min = env.getBoundsMin();
-    Vec3 max = env.getBoundsMax();
+    float wallZ = snapshot.wallZ;
+    Vec3 min = snapshot.boundsMin;
+    Vec3 max = snapshot.boundsMax;
 
     // Draw semi-transparent wall
     glEnable(GL_BLEND);
@@ -177,9 +882,9 @@ void Renderer::drawWall(const Environment& env) {
     glPopMatrix();
 }
 
-void Renderer::drawHole(const Environment& env) {
-    Vec3 center = env.getHoleCenter();
-    float radius = env.getHoleRadius();
+void Renderer::drawHole(const SwarmSnapshot& snapshot) {
+    Vec3 center = snapshot.holeCenter;
+    float radius = snapshot.holeRadius;
 
     // Draw hole as a bright circle
     glPushMatrix();
@@ -202,21 +907,12 @@ void Renderer::drawHole(const Environment& env) {
     glPopMatrix();
 }
 
-void Renderer::drawDrone(const Drone& drone) {
-    Vec3 pos = drone.getPosition();
-    float radius = drone.getRadius();
-
+void Renderer::drawDrone(const DroneSnapshot& drone, int lod) {
     // Color based on status
     float r, g, b;
-    if (drone.isSuccessful()) {
-        r = 0.2f; g = 1.0f; b = 0.2f; // Green for successful
-    } else if (!drone.isActive()) {
-        r = 1.0f; g = 0.2f; b = 0.2f; // Red for failed
-    } else {
-        r = 0.3f; g = 0.5f; b = 1.0f; // Blue for active
-    }
+    droneColor(drone.status, r, g, b);
 
-    drawSphere(pos, radius, r, g, b);
+    drawSphere(drone.position, drone.radius, r, g, b, lod);
 }
 
 void Renderer::setWindowTitle(const std::string& title) {
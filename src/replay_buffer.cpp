@@ -0,0 +1,100 @@
+#include "replay_buffer.h"
+#include <algorithm>
+#include <thread>
+
+template <typename T>
+static std::unique_ptr<std::atomic<T>[]> makeArray(size_t count) {
+    std::unique_ptr<std::atomic<T>[]> array(new std::atomic<T>[count]);
+    for (size_t i = 0; i < count; i++) {
+        array[i].store(T(), std::memory_order_relaxed);
+    }
+    return array;
+}
+
+ReplayBuffer::ReplayBuffer(size_t capacity, int observationSize, int actionSize)
+    : capacity(std::max<size_t>(1, capacity)), observationSize(observationSize), actionSize(actionSize),
+      versions(makeArray<uint64_t>(this->capacity)),
+      observations(makeArray<float>(this->capacity * observationSize)),
+      actions(makeArray<float>(this->capacity * actionSize)),
+      rewards(makeArray<float>(this->capacity)),
+      nextObservations(makeArray<float>(this->capacity * observationSize)),
+      terminals(makeArray<uint8_t>(this->capacity)),
+      writePos(0) {
+}
+
+void ReplayBuffer::push(const float* observation, const float* action, float reward,
+                        const float* nextObservation, bool terminal) {
+    uint64_t ticket = writePos.fetch_add(1, std::memory_order_relaxed);
+    size_t slot = ticket % capacity;
+
+    // The writer of the previous lap must be done with the slot (it only
+    // still is if it stalled for a whole lap of the ring)
+    uint64_t previous = ticket >= capacity ? 2 * (ticket - capacity) + 2 : 0;
+    while (versions[slot].load(std::memory_order_acquire) != previous) {
+        std::this_thread::yield();
+    }
+
+    versions[slot].store(2 * ticket + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::atomic<float>* obs = &observations[slot * observationSize];
+    std::atomic<float>* next = &nextObservations[slot * observationSize];
+    for (int i = 0; i < observationSize; i++) {
+        obs[i].store(observation[i], std::memory_order_relaxed);
+        next[i].store(nextObservation[i], std::memory_order_relaxed);
+    }
+    std::atomic<float>* act = &actions[slot * actionSize];
+    for (int i = 0; i < actionSize; i++) {
+        act[i].store(action[i], std::memory_order_relaxed);
+    }
+    rewards[slot].store(reward, std::memory_order_relaxed);
+    terminals[slot].store(terminal ? 1 : 0, std::memory_order_relaxed);
+
+    versions[slot].store(2 * ticket + 2, std::memory_order_release);
+}
+
+size_t ReplayBuffer::size() const {
+    return static_cast<size_t>(std::min<uint64_t>(writePos.load(std::memory_order_relaxed), capacity));
+}
+
+bool ReplayBuffer::sample(int batchSize, std::mt19937& rng, Batch& batch) const {
+    size_t stored = size();
+    if (batchSize <= 0 || stored < static_cast<size_t>(batchSize)) {
+        return false;
+    }
+
+    batch.observations.resize(observationSize, batchSize);
+    batch.actions.resize(actionSize, batchSize);
+    batch.rewards.resize(batchSize);
+    batch.nextObservations.resize(observationSize, batchSize);
+    batch.terminals.resize(batchSize);
+
+    std::uniform_int_distribution<size_t> pick(0, stored - 1);
+    int filled = 0;
+    while (filled < batchSize) {
+        size_t slot = pick(rng);
+        uint64_t before = versions[slot].load(std::memory_order_acquire);
+        if (before == 0 || (before & 1)) {
+            continue;  // Claimed but not written yet, or being rewritten
+        }
+
+        const std::atomic<float>* obs = &observations[slot * observationSize];
+        const std::atomic<float>* next = &nextObservations[slot * observationSize];
+        for (int i = 0; i < observationSize; i++) {
+            batch.observations(i, filled) = obs[i].load(std::memory_order_relaxed);
+            batch.nextObservations(i, filled) = next[i].load(std::memory_order_relaxed);
+        }
+        const std::atomic<float>* act = &actions[slot * actionSize];
+        for (int i = 0; i < actionSize; i++) {
+            batch.actions(i, filled) = act[i].load(std::memory_order_relaxed);
+        }
+        batch.rewards(filled) = rewards[slot].load(std::memory_order_relaxed);
+        batch.terminals(filled) = terminals[slot].load(std::memory_order_relaxed) ? 1.0f : 0.0f;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (versions[slot].load(std::memory_order_relaxed) == before) {
+            filled++;  // Otherwise overwritten mid-copy: draw again
+        }
+    }
+    return true;
+}
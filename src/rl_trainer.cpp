@@ -1,14 +1,19 @@
 #include "rl_trainer.h"
+#include "metrics.h"
+#include "trace.h"
+#include "random_streams.h"
 #include <algorithm>
 #include <cmath>
 
-RLTrainer::RLTrainer()
-    : mutationRate(0.05f), mutationStrength(0.1f) {
+RLTrainer::RLTrainer(const SimConfig& config)
+    : mutationRate(config.mutationRate), mutationStrength(config.mutationStrength),
+      seed(config.seed ? config.seed : randomMasterSeed()), trainSteps(0) {
     // Balanced mutation for exploration and exploitation
 }
 
 float RLTrainer::calculateReward(const Drone& drone, const Environment& env,
                                   bool reachedGoal, bool collided) const {
+    ScopedZoneTimer timer(MetricZone::Reward);
     float reward = 0.0f;
 
     if (reachedGoal) {
@@ -73,10 +78,17 @@ float RLTrainer::calculateReward(const Drone& drone, const Environment& env,
 }
 
 void RLTrainer::trainStep(std::vector<std::shared_ptr<NeuralNetwork>>& networks,
-                          const std::vector<float>& fitnessScores) {
+                          const std::vector<float>& fitnessScores,
+                          std::vector<Genome>* genomes) {
+    TRACE_SCOPE("RLTrainer::trainStep");
+
     if (networks.empty() || fitnessScores.size() != networks.size()) {
         return;
     }
+    if (genomes && genomes->size() != networks.size()) {
+        genomes = nullptr;
+    }
+    trainSteps++;
 
     // Find best network
     int bestIdx = getBestNetworkIndex(fitnessScores);
@@ -90,27 +102,58 @@ void RLTrainer::trainStep(std::vector<std::shared_ptr<NeuralNetwork>>& networks,
             continue; // Keep best network unchanged (elitism)
         }
 
-        // Clone best network
-        *networks[i] = bestNetwork->clone();
-
-        // Different mutation strategies for different drones:
-        // This creates a diverse population that can both exploit and explore
-        if (i == 0) {
-            // Very small mutations - fine-tune the best solution
-            networks[i]->mutate(mutationRate * 0.3f, mutationStrength * 0.3f);
-        } else if (i == 1) {
-            // Small-medium mutations - local exploitation
-            networks[i]->mutate(mutationRate * 0.6f, mutationStrength * 0.6f);
-        } else if (i == networks.size() - 1) {
-            // Very large mutation - aggressive exploration
-            networks[i]->mutate(mutationRate * 3.0f, mutationStrength * 3.0f);
-        } else if (i == networks.size() - 2) {
-            // Large mutation - exploration
-            networks[i]->mutate(mutationRate * 1.8f, mutationStrength * 1.8f);
-        } else {
-            // Normal mutation - balanced
-            networks[i]->mutate(mutationRate, mutationStrength);
+        // Copy best network (in place: same shapes, no allocation)
+        *networks[i] = *bestNetwork;
+
+        float scale = mutationScale(i, networks.size());
+        mutateNetwork(networks, genomes, i, bestIdx, mutationRate * scale, mutationStrength * scale);
+    }
+}
+
+void RLTrainer::trainStep(PackedPopulation& population, const std::vector<float>& fitnessScores) {
+    TRACE_SCOPE("RLTrainer::trainStep");
+
+    if (population.getSize() == 0 || fitnessScores.size() != (size_t)population.getSize()) {
+        return;
+    }
+    trainSteps++;
+
+    // Same selection, mutation sizes and seeds as the network version
+    int bestIdx = getBestNetworkIndex(fitnessScores);
+    size_t count = population.getSize();
+    for (size_t i = 0; i < count; i++) {
+        if (i == (size_t)bestIdx) {
+            continue;
         }
+        population.copyMember(i, bestIdx);
+        float scale = mutationScale(i, count);
+        uint32_t mutationSeed = deriveSeed32(seed, SeedStream::Mutation, (trainSteps << 32) | i);
+        population.mutate(i, mutationRate * scale, mutationStrength * scale, mutationSeed);
+    }
+}
+
+// Different mutation strategies for different drones:
+// This creates a diverse population that can both exploit and explore
+float RLTrainer::mutationScale(size_t i, size_t count) {
+    if (i == 0) {
+        return 0.3f;  // Very small mutations - fine-tune the best solution
+    } else if (i == 1) {
+        return 0.6f;  // Small-medium mutations - local exploitation
+    } else if (i == count - 1) {
+        return 3.0f;  // Very large mutation - aggressive exploration
+    } else if (i == count - 2) {
+        return 1.8f;  // Large mutation - exploration
+    }
+    return 1.0f;      // Normal mutation - balanced
+}
+
+void RLTrainer::mutateNetwork(std::vector<std::shared_ptr<NeuralNetwork>>& networks,
+                              std::vector<Genome>* genomes, size_t i, int parentIdx,
+                              float rate, float strength) {
+    uint32_t mutationSeed = deriveSeed32(seed, SeedStream::Mutation, (trainSteps << 32) | i);
+    networks[i]->mutate(rate, strength, mutationSeed);
+    if (genomes) {
+        (*genomes)[i] = (*genomes)[parentIdx].mutated(mutationSeed, rate, strength);
     }
 }
 
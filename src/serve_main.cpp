@@ -0,0 +1,224 @@
+#include "policy_server.h"
+#include "neural_network.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Policy inference daemon for other local processes (physics sims, HIL rigs),
+// and a load generator (--client) that measures its round-trip latency.
+
+static PolicyServer* activeServer = nullptr;
+
+static void handleSignal(int) {
+    if (activeServer) {
+        activeServer->requestStop();
+    }
+}
+
+static bool sendAll(int fd, const void* data, size_t bytes) {
+    const char* cursor = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t sent = send(fd, cursor, bytes, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        cursor += sent;
+        bytes -= sent;
+    }
+    return true;
+}
+
+static bool receiveAll(int fd, void* data, size_t bytes) {
+    char* cursor = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t got = recv(fd, cursor, bytes, 0);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        cursor += got;
+        bytes -= got;
+    }
+    return true;
+}
+
+static int connectTo(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Closed-loop clients: each sends a request, waits for the reply, repeats
+static int runClients(const std::string& socketPath, int threads, int requests, int batch,
+                      const std::string& checkModel) {
+    batch = std::max(1, std::min(batch, policyMaxRequestCount));
+    std::vector<std::vector<double>> latencies(threads);
+    std::atomic<bool> failed(false);
+    std::atomic<uint32_t> lastVersion(0);
+
+    // With --check every reply is compared to NeuralNetwork::forward
+    std::vector<int> sizes = {policyInputSize, policyOutputSize};
+    NeuralNetwork reference(sizes, 0u);
+    if (!checkModel.empty() && !reference.load(checkModel)) {
+        return 1;
+    }
+    std::vector<double> maxErrors(threads, 0.0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            int fd = connectTo(socketPath);
+            if (fd < 0) {
+                std::cerr << "Ошибка подключения к " << socketPath << ": " << std::strerror(errno) << std::endl;
+                failed = true;
+                return;
+            }
+            std::mt19937 rng(1000 + t);
+            std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+            PolicyRequestHeader header = {policyRequestMagic, (uint32_t)batch};
+            std::vector<float> inputs((size_t)batch * policyInputSize);
+            std::vector<float> outputs((size_t)batch * policyOutputSize);
+            latencies[t].reserve(requests);
+
+            for (int r = 0; r < requests && !failed; r++) {
+                for (float& v : inputs) {
+                    v = value(rng);
+                }
+                auto sent = std::chrono::steady_clock::now();
+                PolicyReplyHeader reply;
+                if (!sendAll(fd, &header, sizeof(header)) || !sendAll(fd, inputs.data(), inputs.size() * sizeof(float))
+                    || !receiveAll(fd, &reply, sizeof(reply)) || reply.magic != policyReplyMagic
+                    || reply.status != PolicyStatusOk || reply.count != (uint32_t)batch
+                    || !receiveAll(fd, outputs.data(), outputs.size() * sizeof(float))) {
+                    std::cerr << "Ошибка обмена с сервером (клиент " << t << ")" << std::endl;
+                    failed = true;
+                    break;
+                }
+                latencies[t].push_back(std::chrono::duration<double, std::micro>(
+                                           std::chrono::steady_clock::now() - sent).count());
+                lastVersion = reply.modelVersion;
+
+                if (!checkModel.empty()) {
+                    std::vector<float> input(policyInputSize);
+                    for (int i = 0; i < batch; i++) {
+                        std::copy(inputs.begin() + i * policyInputSize, inputs.begin() + (i + 1) * policyInputSize,
+                                  input.begin());
+                        std::vector<float> expected = reference.forward(input);
+                        for (int o = 0; o < policyOutputSize; o++) {
+                            maxErrors[t] = std::max(maxErrors[t],
+                                                    (double)std::fabs(expected[o] - outputs[i * policyOutputSize + o]));
+                        }
+                    }
+                }
+            }
+            close(fd);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (failed) {
+        return 1;
+    }
+
+    std::vector<double> all;
+    for (const auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[std::min(all.size() - 1, (size_t)(p * all.size()))]; };
+    std::cout << std::fixed << std::setprecision(1)
+              << threads << " клиентов x " << requests << " запросов по " << batch << " векторов: "
+              << all.size() / seconds << " запросов/с, задержка p50 " << percentile(0.50)
+              << " мкс, p99 " << percentile(0.99) << " мкс, макс. " << all.back()
+              << " мкс (модель версии " << lastVersion << ")" << std::endl;
+    if (!checkModel.empty()) {
+        double maxError = *std::max_element(maxErrors.begin(), maxErrors.end());
+        std::cout << std::scientific << std::setprecision(2)
+                  << "Макс. отклонение от NeuralNetwork::forward: " << maxError << std::endl;
+        if (maxError > 1e-5) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    PolicyServerConfig config;
+    int clientThreads = 0;
+    int clientRequests = 10000;
+    int clientBatch = 1;
+    std::string checkModel;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc) {
+            config.modelFile = argv[++i];
+        } else if (arg == "--socket" && i + 1 < argc) {
+            config.socketPath = argv[++i];
+        } else if (arg == "--max-clients" && i + 1 < argc) {
+            config.maxClients = std::stoi(argv[++i]);
+        } else if (arg == "--max-batch" && i + 1 < argc) {
+            config.maxBatch = std::stoi(argv[++i]);
+        } else if (arg == "--max-delay-us" && i + 1 < argc) {
+            config.maxDelayMicros = std::stoi(argv[++i]);
+        } else if (arg == "--report" && i + 1 < argc) {
+            config.reportSeconds = std::stod(argv[++i]);
+        } else if (arg == "--client" && i + 1 < argc) {
+            clientThreads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--requests" && i + 1 < argc) {
+            clientRequests = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            clientBatch = std::stoi(argv[++i]);
+        } else if (arg == "--check" && i + 1 < argc) {
+            checkModel = argv[++i];
+        } else {
+            std::cout << "Использование: nndrons_serve [--model best_network.bin] [--socket PATH]\n"
+                      << "  [--max-clients N] [--max-batch N] [--max-delay-us US] [--report SEC]\n"
+                      << "       nndrons_serve --client THREADS [--socket PATH] [--requests N] [--batch N]\n"
+                      << "  [--check best_network.bin]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (clientThreads > 0) {
+        return runClients(config.socketPath, clientThreads, clientRequests, clientBatch, checkModel);
+    }
+
+    PolicyServer server(config);
+    if (!server.start()) {
+        return 1;
+    }
+    activeServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    server.run();
+    activeServer = nullptr;
+    return 0;
+}
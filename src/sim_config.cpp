@@ -0,0 +1,101 @@
+#include "sim_config.h"
+#include <sstream>
+
+static bool parseFloat(const std::string& text, float& value) {
+    try {
+        size_t used = 0;
+        value = std::stof(text, &used);
+        return used == text.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+bool SimConfig::set(const std::string& name, const std::string& value) {
+    if (name == "layerSizes") {
+        std::vector<int> sizes;
+        std::stringstream ss(value);
+        std::string item;
+        while (std::getline(ss, item, '-')) {
+            try {
+                int size = std::stoi(item);
+                if (size < 1) {
+                    return false;
+                }
+                sizes.push_back(size);
+            } catch (...) {
+                return false;
+            }
+        }
+        // Sensors and controls are fixed by the drone
+        if (sizes.size() < 2 || sizes.front() != 22 || sizes.back() != 4) {
+            return false;
+        }
+        layerSizes = sizes;
+        return true;
+    }
+
+    if (name == "seed") {
+        try {
+            size_t used = 0;
+            seed = std::stoull(value, &used);
+            return used == value.size();
+        } catch (...) {
+            return false;
+        }
+    }
+
+    float v;
+    if (!parseFloat(value, v)) {
+        return false;
+    }
+
+    if (name == "mutationRate") {
+        mutationRate = v;
+    } else if (name == "mutationStrength") {
+        mutationStrength = v;
+    } else if (name == "maxEpisodeTime") {
+        maxEpisodeTime = v;
+    } else if (name == "holeRadius") {
+        holeRadius = v;
+    } else if (name == "controlStrength") {
+        controlStrength = v;
+    } else if (name == "maxSpeed") {
+        maxSpeed = v;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string SimConfig::get(const std::string& name) const {
+    std::ostringstream out;
+    if (name == "layerSizes") {
+        for (size_t i = 0; i < layerSizes.size(); i++) {
+            out << (i > 0 ? "-" : "") << layerSizes[i];
+        }
+    } else if (name == "mutationRate") {
+        out << mutationRate;
+    } else if (name == "mutationStrength") {
+        out << mutationStrength;
+    } else if (name == "maxEpisodeTime") {
+        out << maxEpisodeTime;
+    } else if (name == "holeRadius") {
+        out << holeRadius;
+    } else if (name == "controlStrength") {
+        out << controlStrength;
+    } else if (name == "maxSpeed") {
+        out << maxSpeed;
+    } else if (name == "seed") {
+        out << seed;
+    }
+    return out.str();
+}
+
+const std::vector<std::string>& SimConfig::parameterNames() {
+    static const std::vector<std::string> names = {
+        "mutationRate", "mutationStrength", "layerSizes", "maxEpisodeTime",
+        "holeRadius", "controlStrength", "maxSpeed", "seed"
+    };
+    return names;
+}
@@ -0,0 +1,309 @@
+#include "software_renderer.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+static Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+// Lighting of the viewer: global ambient 0.2 + light ambient 0.3 + diffuse 0.8
+static float lightFactor(const Vec3& normal, const Vec3& toLight) {
+    return 0.5f + 0.8f * std::max(0.0f, normal.dot(toLight));
+}
+
+// Same colors as Renderer
+static void droneColor(DroneSnapshot::Status status, float& r, float& g, float& b) {
+    if (status == DroneSnapshot::Successful) {
+        r = 0.2f; g = 1.0f; b = 0.2f;
+    } else if (status == DroneSnapshot::Failed) {
+        r = 1.0f; g = 0.2f; b = 0.2f;
+    } else {
+        r = 0.3f; g = 0.5f; b = 1.0f;
+    }
+}
+
+static const float nearPlane = 0.1f;
+static const Vec3 backgroundColor(0.1f, 0.1f, 0.15f);
+static const Vec3 wallColor(0.6f, 0.6f, 0.7f);
+static const float wallAlpha = 0.5f;
+static const Vec3 holeColor(0.2f, 1.0f, 0.2f);
+static const int holeSegments = 32;
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, int numThreads)
+    : width(width), height(height),
+      cameraDistance(50.0f), cameraAngleX(10.0f), cameraAngleY(0.0f),
+      tanHalfX(0.0f), tanHalfY(0.0f), scene(nullptr),
+      tilesX((width + tileSize - 1) / tileSize), tilesY((height + tileSize - 1) / tileSize),
+      tileBins(tilesX * tilesY), frameId(0), busyWorkers(0), stopping(false), nextTile(0) {
+    framebuffer.width = width;
+    framebuffer.height = height;
+    framebuffer.pixels.assign((size_t)width * height * 3, 0);
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&SoftwareRenderer::workerLoop, this);
+    }
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void SoftwareRenderer::setCamera(float distance, float angleX, float angleY) {
+    cameraDistance = distance;
+    cameraAngleX = angleX;
+    cameraAngleY = angleY;
+}
+
+void SoftwareRenderer::setupCamera() {
+    // Mirrors Renderer::setupCamera (gluPerspective 60 deg + gluLookAt)
+    eye = Vec3(cameraAngleY * 0.1f, 5.0f + cameraAngleX * 0.1f, -cameraDistance);
+    forward = (Vec3(0.0f, 0.0f, -17.5f) - eye).normalized();
+    right = cross(forward, Vec3(0.0f, 1.0f, 0.0f)).normalized();
+    up = cross(right, forward);
+
+    tanHalfY = std::tan(30.0f * M_PI / 180.0f);
+    tanHalfX = tanHalfY * width / height;
+
+    // GL_LIGHT0 at (10, 10, 10) in eye space
+    lightPos = eye + right * 10.0f + up * 10.0f - forward * 10.0f;
+}
+
+bool SoftwareRenderer::project(const Vec3& p, float& x, float& y, float& depth) const {
+    Vec3 v = p - eye;
+    depth = v.dot(forward);
+    if (depth < nearPlane) {
+        return false;
+    }
+    x = (v.dot(right) / (depth * tanHalfX) + 1.0f) * 0.5f * width;
+    y = (1.0f - v.dot(up) / (depth * tanHalfY)) * 0.5f * height;
+    return true;
+}
+
+void SoftwareRenderer::projectScene(const SwarmSnapshot& snapshot) {
+    scene = &snapshot;
+    for (auto& bin : tileBins) {
+        bin.clear();
+    }
+
+    // Drones: conservative screen bounds, then bin into tiles
+    const float focal = 0.5f * height / tanHalfY;
+    screenDrones.clear();
+    for (const auto& drone : snapshot.drones) {
+        float x, y, depth;
+        if (!project(drone.position, x, y, depth) || depth - drone.radius < nearPlane) {
+            continue;
+        }
+
+        // Off-axis spheres project to ellipses stretched by ~1/cos^2 of the view angle
+        float dx = x - 0.5f * width;
+        float dy = y - 0.5f * height;
+        float stretch = 1.0f + (dx * dx + dy * dy) / (focal * focal);
+        float radiusPx = drone.radius / (depth - drone.radius) * focal * stretch + 1.0f;
+
+        ScreenDrone sd;
+        sd.center = drone.position;
+        sd.radius = drone.radius;
+        droneColor(drone.status, sd.r, sd.g, sd.b);
+        sd.x0 = std::max(0, (int)std::floor(x - radiusPx));
+        sd.y0 = std::max(0, (int)std::floor(y - radiusPx));
+        sd.x1 = std::min(width - 1, (int)std::ceil(x + radiusPx));
+        sd.y1 = std::min(height - 1, (int)std::ceil(y + radiusPx));
+        if (sd.x0 > sd.x1 || sd.y0 > sd.y1) {
+            continue;  // Off screen
+        }
+
+        int droneIdx = static_cast<int>(screenDrones.size());
+        screenDrones.push_back(sd);
+        for (int ty = sd.y0 / tileSize; ty <= sd.y1 / tileSize; ty++) {
+            for (int tx = sd.x0 / tileSize; tx <= sd.x1 / tileSize; tx++) {
+                tileBins[ty * tilesX + tx].push_back(droneIdx);
+            }
+        }
+    }
+
+    // Hole ring: same 32-segment loop as Renderer::drawHole
+    ring.resize(holeSegments);
+    for (int i = 0; i < holeSegments; i++) {
+        float angle = i * 2.0f * M_PI / holeSegments;
+        ScreenPoint& point = ring[i];
+        point.world = snapshot.holeCenter + Vec3(std::cos(angle), std::sin(angle), 0.0f) * snapshot.holeRadius;
+        float depth;
+        point.visible = project(point.world, point.x, point.y, depth);
+    }
+}
+
+void SoftwareRenderer::render(const SwarmSnapshot& snapshot) {
+    TRACE_SCOPE("SoftwareRenderer::render");
+
+    setupCamera();
+    projectScene(snapshot);
+
+    // Scene data is published to the workers by the mutex
+    nextTile = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busyWorkers = static_cast<int>(workers.size());
+        frameId++;
+    }
+    frameReady.notify_all();
+
+    shadeTiles();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    frameDone.wait(lock, [this] { return busyWorkers == 0; });
+    scene = nullptr;
+}
+
+void SoftwareRenderer::workerLoop() {
+    Trace::setThreadName("raster worker");
+    uint64_t seenFrame = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameReady.wait(lock, [&] { return stopping || frameId != seenFrame; });
+            if (stopping) {
+                return;
+            }
+            seenFrame = frameId;
+        }
+
+        shadeTiles();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            frameDone.notify_one();
+        }
+    }
+}
+
+void SoftwareRenderer::shadeTiles() {
+    TRACE_SCOPE("SoftwareRenderer::shadeTiles");
+
+    const int numTiles = tilesX * tilesY;
+    int tileIdx;
+    while ((tileIdx = nextTile.fetch_add(1)) < numTiles) {
+        shadeTile(tileIdx);
+    }
+}
+
+void SoftwareRenderer::shadeTile(int tileIdx) {
+    const int x0 = (tileIdx % tilesX) * tileSize;
+    const int y0 = (tileIdx / tilesX) * tileSize;
+    const int x1 = std::min(x0 + tileSize, width);   // Exclusive
+    const int y1 = std::min(y0 + tileSize, height);
+    const int tileW = x1 - x0;
+
+    // Per-thread scratch: view rays, color and depth (distance along the ray)
+    thread_local Vec3 rays[tileSize * tileSize];
+    thread_local Vec3 color[tileSize * tileSize];
+    thread_local float depth[tileSize * tileSize];
+
+    const SwarmSnapshot& snapshot = *scene;
+
+    // Background + translucent wall (ray vs plane z = wallZ)
+    for (int y = y0; y < y1; y++) {
+        float ndcY = 1.0f - 2.0f * (y + 0.5f) / height;
+        for (int x = x0; x < x1; x++) {
+            int i = (y - y0) * tileW + (x - x0);
+            float ndcX = 2.0f * (x + 0.5f) / width - 1.0f;
+            Vec3 ray = (forward + right * (ndcX * tanHalfX) + up * (ndcY * tanHalfY)).normalized();
+            rays[i] = ray;
+            color[i] = backgroundColor;
+            depth[i] = INFINITY;
+
+            if (std::fabs(ray.z) < 1e-6f) {
+                continue;
+            }
+            float t = (snapshot.wallZ - eye.z) / ray.z;
+            Vec3 p = eye + ray * t;
+            if (t > 0.0f && p.x >= snapshot.boundsMin.x && p.x <= snapshot.boundsMax.x &&
+                p.y >= snapshot.boundsMin.y && p.y <= snapshot.boundsMax.y) {
+                Vec3 toLight = (lightPos - p).normalized();
+                Vec3 lit = wallColor * lightFactor(Vec3(0.0f, 0.0f, 1.0f), toLight);
+                color[i] = lit * wallAlpha + backgroundColor * (1.0f - wallAlpha);
+                depth[i] = t;
+            }
+        }
+    }
+
+    // Hole ring: 1 px lines, drawn over the wall it lies on
+    for (int s = 0; s < holeSegments; s++) {
+        const ScreenPoint& a = ring[s];
+        const ScreenPoint& b = ring[(s + 1) % holeSegments];
+        if (!a.visible || !b.visible ||
+            std::max(a.x, b.x) < x0 || std::min(a.x, b.x) >= x1 ||
+            std::max(a.y, b.y) < y0 || std::min(a.y, b.y) >= y1) {
+            continue;
+        }
+
+        int steps = std::max(1, (int)std::ceil(std::max(std::fabs(b.x - a.x), std::fabs(b.y - a.y))));
+        for (int k = 0; k <= steps; k++) {
+            float f = (float)k / steps;
+            int x = (int)std::floor(a.x + (b.x - a.x) * f);
+            int y = (int)std::floor(a.y + (b.y - a.y) * f);
+            if (x < x0 || x >= x1 || y < y0 || y >= y1) {
+                continue;
+            }
+            int i = (y - y0) * tileW + (x - x0);
+            float d = (a.world + (b.world - a.world) * f - eye).length();
+            if (d <= depth[i] + 0.05f) {
+                color[i] = holeColor;
+                depth[i] = d;
+            }
+        }
+    }
+
+    // Drones binned to this tile: ray-sphere intersection per covered pixel
+    for (int droneIdx : tileBins[tileIdx]) {
+        const ScreenDrone& sd = screenDrones[droneIdx];
+        Vec3 oc = eye - sd.center;
+        float c = oc.lengthSquared() - sd.radius * sd.radius;
+        float invRadius = 1.0f / sd.radius;
+        Vec3 baseColor(sd.r, sd.g, sd.b);
+
+        int px0 = std::max(sd.x0, x0), px1 = std::min(sd.x1 + 1, x1);
+        int py0 = std::max(sd.y0, y0), py1 = std::min(sd.y1 + 1, y1);
+        for (int y = py0; y < py1; y++) {
+            for (int x = px0; x < px1; x++) {
+                int i = (y - y0) * tileW + (x - x0);
+                const Vec3& ray = rays[i];
+                float b = oc.dot(ray);
+                float disc = b * b - c;
+                if (disc < 0.0f) {
+                    continue;
+                }
+                float t = -b - std::sqrt(disc);
+                if (t <= 0.0f || t >= depth[i]) {
+                    continue;
+                }
+
+                Vec3 p = eye + ray * t;
+                Vec3 normal = (p - sd.center) * invRadius;
+                color[i] = baseColor * lightFactor(normal, (lightPos - p).normalized());
+                depth[i] = t;
+            }
+        }
+    }
+
+    // Resolve to 8-bit RGB
+    for (int y = y0; y < y1; y++) {
+        uint8_t* out = &framebuffer.pixels[((size_t)y * width + x0) * 3];
+        for (int x = x0; x < x1; x++) {
+            const Vec3& c = color[(y - y0) * tileW + (x - x0)];
+            *out++ = (uint8_t)(std::min(c.x, 1.0f) * 255.0f + 0.5f);
+            *out++ = (uint8_t)(std::min(c.y, 1.0f) * 255.0f + 0.5f);
+            *out++ = (uint8_t)(std::min(c.z, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
@@ -0,0 +1,227 @@
+#include "sparse_network.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+static const uint32_t sparseMagic = 0x5053524E;  // "NRSP"
+static const uint32_t sparseVersion = 1;
+
+float pruningThreshold(const NeuralNetwork& network, float sparsity) {
+    std::vector<float> magnitudes;
+    for (const Eigen::MatrixXf& weight : network.getWeights()) {
+        for (int i = 0; i < weight.size(); i++) {
+            magnitudes.push_back(std::fabs(weight.data()[i]));
+        }
+    }
+    size_t removed = (size_t)std::round(std::min(std::max(sparsity, 0.0f), 1.0f) * magnitudes.size());
+    if (removed == 0 || magnitudes.empty()) {
+        return 0.0f;
+    }
+    if (removed >= magnitudes.size()) {
+        return INFINITY;
+    }
+    std::nth_element(magnitudes.begin(), magnitudes.begin() + removed, magnitudes.end());
+    return magnitudes[removed];
+}
+
+int pruneWeights(NeuralNetwork& network, float threshold) {
+    std::vector<Eigen::MatrixXf> weights = network.getWeights();
+    int zeros = 0;
+    for (Eigen::MatrixXf& weight : weights) {
+        for (int i = 0; i < weight.size(); i++) {
+            float& w = weight.data()[i];
+            if (std::fabs(w) < threshold) {
+                w = 0.0f;
+            }
+            zeros += w == 0.0f;
+        }
+    }
+    network.setWeights(weights, network.getBiases());
+    return zeros;
+}
+
+SparseNetwork::SparseNetwork(const NeuralNetwork& network)
+    : layerSizes(network.getLayerSizes()) {
+    std::vector<Eigen::MatrixXf> weights = network.getWeights();
+    std::vector<Eigen::VectorXf> biases = network.getBiases();
+    for (const Eigen::MatrixXf& weight : weights) {
+        if (weight.cols() > 65536) {
+            // Column indices are stored as uint16_t
+            std::cerr << "Слой шире 65536 входов не поддерживается разреженной сетью" << std::endl;
+            layerSizes.clear();
+            return;
+        }
+    }
+    int widest = 0;
+    for (size_t l = 0; l < weights.size(); l++) {
+        const Eigen::MatrixXf& weight = weights[l];
+        Layer layer;
+        layer.rows = (int)weight.rows();
+        layer.cols = (int)weight.cols();
+        layer.rowStart.push_back(0);
+        for (int r = 0; r < layer.rows; r++) {
+            for (int c = 0; c < layer.cols; c++) {
+                if (weight(r, c) != 0.0f) {
+                    layer.columns.push_back((uint16_t)c);
+                    layer.values.push_back(weight(r, c));
+                    nonZeros++;
+                }
+            }
+            while (layer.values.size() % 4 != 0) {
+                layer.columns.push_back(0);
+                layer.values.push_back(0.0f);
+            }
+            layer.rowStart.push_back((uint32_t)layer.values.size());
+        }
+        layer.biases.assign(biases[l].data(), biases[l].data() + biases[l].size());
+        widest = std::max(widest, layer.rows);
+        layers.push_back(std::move(layer));
+    }
+    scratch[0].resize(widest);
+    scratch[1].resize(widest);
+}
+
+void SparseNetwork::forward(const float* input, float* output) const {
+    const float* x = input;
+    for (size_t l = 0; l < layers.size(); l++) {
+        const Layer& layer = layers[l];
+        float* y = l + 1 == layers.size() ? output : scratch[l % 2].data();
+        const float* values = layer.values.data();
+        const uint16_t* columns = layer.columns.data();
+        for (int r = 0; r < layer.rows; r++) {
+            float a0 = 0.0f, a1 = 0.0f, a2 = 0.0f, a3 = 0.0f;
+            for (uint32_t k = layer.rowStart[r]; k < layer.rowStart[r + 1]; k += 4) {
+                a0 += values[k] * x[columns[k]];
+                a1 += values[k + 1] * x[columns[k + 1]];
+                a2 += values[k + 2] * x[columns[k + 2]];
+                a3 += values[k + 3] * x[columns[k + 3]];
+            }
+            y[r] = (a0 + a1) + (a2 + a3) + layer.biases[r];
+        }
+        // Eigen's vectorized tanh, as in NeuralNetwork::forward
+        Eigen::Map<Eigen::VectorXf> activation(y, layer.rows);
+        activation = activation.array().tanh();
+        x = y;
+    }
+}
+
+void SparseNetwork::copyTo(NeuralNetwork& network) const {
+    std::vector<Eigen::MatrixXf> weights;
+    std::vector<Eigen::VectorXf> biases;
+    for (const Layer& layer : layers) {
+        Eigen::MatrixXf weight = Eigen::MatrixXf::Zero(layer.rows, layer.cols);
+        for (int r = 0; r < layer.rows; r++) {
+            for (uint32_t k = layer.rowStart[r]; k < layer.rowStart[r + 1]; k++) {
+                weight(r, layer.columns[k]) += layer.values[k];  // Padding adds 0
+            }
+        }
+        weights.push_back(weight);
+        biases.push_back(Eigen::Map<const Eigen::VectorXf>(layer.biases.data(), layer.rows));
+    }
+    network.setWeights(weights, biases);
+}
+
+size_t SparseNetwork::getStorageBytes() const {
+    size_t bytes = 0;
+    for (const Layer& layer : layers) {
+        bytes += layer.values.size() * sizeof(float) + layer.columns.size() * sizeof(uint16_t)
+                 + layer.rowStart.size() * sizeof(uint32_t) + layer.biases.size() * sizeof(float);
+    }
+    return bytes;
+}
+
+// Layout: magic, version, layer count, layer sizes; per layer: entry count,
+// row starts, column indices, values, biases
+bool SparseNetwork::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка открытия файла для сохранения: " << filename << std::endl;
+        return false;
+    }
+    uint32_t header[3] = {sparseMagic, sparseVersion, (uint32_t)layerSizes.size()};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(layerSizes.data()), layerSizes.size() * sizeof(int));
+    for (const Layer& layer : layers) {
+        uint32_t entries = (uint32_t)layer.values.size();
+        file.write(reinterpret_cast<const char*>(&entries), sizeof(entries));
+        file.write(reinterpret_cast<const char*>(layer.rowStart.data()), layer.rowStart.size() * sizeof(uint32_t));
+        file.write(reinterpret_cast<const char*>(layer.columns.data()), entries * sizeof(uint16_t));
+        file.write(reinterpret_cast<const char*>(layer.values.data()), entries * sizeof(float));
+        file.write(reinterpret_cast<const char*>(layer.biases.data()), layer.biases.size() * sizeof(float));
+    }
+    return file.good();
+}
+
+bool SparseNetwork::load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка открытия файла для загрузки: " << filename << std::endl;
+        return false;
+    }
+    uint64_t fileBytes = (uint64_t)file.tellg();
+    file.seekg(0);
+    uint32_t header[3] = {};
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || header[0] != sparseMagic || header[1] != sparseVersion || header[2] < 2 || header[2] > 64) {
+        std::cerr << "Неверный формат разреженной сети: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<int> sizes(header[2]);
+    file.read(reinterpret_cast<char*>(sizes.data()), sizes.size() * sizeof(int));
+    for (size_t l = 0; file && l < sizes.size(); l++) {
+        if (sizes[l] < 1 || sizes[l] > (1 << 16)) {
+            std::cerr << "Неверный размер слоя разреженной сети: " << filename << std::endl;
+            return false;
+        }
+    }
+    std::vector<Layer> loaded;
+    int widest = 0, count = 0;
+    for (size_t l = 0; file && l + 1 < sizes.size(); l++) {
+        Layer layer;
+        layer.rows = sizes[l + 1];
+        layer.cols = sizes[l];
+        uint32_t entries = 0;
+        file.read(reinterpret_cast<char*>(&entries), sizeof(entries));
+        // Nothing is allocated past what the file can actually hold
+        uint64_t layerBytes = (uint64_t)entries * (sizeof(uint16_t) + sizeof(float))
+                              + (uint64_t)(2 * layer.rows + 1) * sizeof(uint32_t);
+        if (!file || entries > (uint64_t)layer.rows * ((layer.cols + 3) / 4 * 4) || layerBytes > fileBytes) {
+            break;
+        }
+        layer.rowStart.resize(layer.rows + 1);
+        layer.columns.resize(entries);
+        layer.values.resize(entries);
+        layer.biases.resize(layer.rows);
+        file.read(reinterpret_cast<char*>(layer.rowStart.data()), layer.rowStart.size() * sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(layer.columns.data()), entries * sizeof(uint16_t));
+        file.read(reinterpret_cast<char*>(layer.values.data()), entries * sizeof(float));
+        file.read(reinterpret_cast<char*>(layer.biases.data()), layer.rows * sizeof(float));
+
+        bool valid = file && layer.rowStart.front() == 0 && layer.rowStart.back() == entries;
+        for (int r = 0; valid && r < layer.rows; r++) {
+            valid = layer.rowStart[r] <= layer.rowStart[r + 1] && (layer.rowStart[r + 1] - layer.rowStart[r]) % 4 == 0;
+        }
+        for (uint32_t k = 0; valid && k < entries; k++) {
+            valid = layer.columns[k] < layer.cols;
+            count += layer.values[k] != 0.0f;
+        }
+        if (!valid) {
+            break;
+        }
+        widest = std::max(widest, layer.rows);
+        loaded.push_back(std::move(layer));
+    }
+    if (loaded.size() + 1 != sizes.size()) {
+        std::cerr << "Неверный формат разреженной сети: " << filename << std::endl;
+        return false;
+    }
+
+    layerSizes = sizes;
+    layers = std::move(loaded);
+    nonZeros = count;
+    scratch[0].assign(widest, 0.0f);
+    scratch[1].assign(widest, 0.0f);
+    return true;
+}
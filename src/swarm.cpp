@@ -1,39 +1,78 @@
 #include "swarm.h"
-#include <random>
+#include "episode_log.h"
+#include "metrics.h"
+#include "trace.h"
+#include "random_streams.h"
 #include <iostream>
-#include <iomanip>
+#include <algorithm>
 
-Swarm::Swarm(int numDrones)
-    : numDrones(numDrones), generation(0), bestFitness(0.0f),
-      episodeTime(0.0f), maxEpisodeTime(40.0f) {  // INCREASED to 40s - ОЧЕНЬ СЛОЖНАЯ задача!
+// Behavior descriptor = positions at 1/3 and 2/3 of the trajectory + final position
+static const int descriptorSamples = 3;
+
+// Fix the master seed up front so every component derives from the same one
+static SimConfig withMasterSeed(SimConfig config) {
+    if (!config.seed) {
+        config.seed = randomMasterSeed();
+    }
+    return config;
+}
+
+Swarm::Swarm(int numDrones, const SimConfig& config)
+    : layerSizes(config.layerSizes), config(withMasterSeed(config)),
+      environment(this->config), trainer(this->config),
+      numDrones(numDrones), generation(0), bestFitness(0.0f),
+      lastGenerationBest(0.0f), lastGenerationMean(0.0f),
+      episodeTime(0.0f), maxEpisodeTime(config.maxEpisodeTime),  // 40s by default - ОЧЕНЬ СЛОЖНАЯ задача!
+      simulatedSteps(0), verbose(true), noveltyArchive(descriptorSamples * 3),
+      noveltyEnabled(false), noveltyWeight(0.5f), fitnessCacheEnabled(true),
+      metricsLog(nullptr), generationCollisions(0), generationOutOfBounds(0), generationStartSteps(0),
+      generationStart(std::chrono::steady_clock::now()), episodeRecorder(nullptr), episodeSteps(0),
+      workerJob(0), busyWorkers(0), stoppingWorkers(false), workerDt(0.0f) {
 
     // Fixed starting position for all drones (they all start from the same point)
     // МАКСИМАЛЬНО ДАЛЕКО - старт очень далеко от стены!
     Vec3 fixedStartPos(0.0f, 0.0f, -35.0f); // Center, 35 units behind the wall (was -15, now MORE THAN 2X!)
 
+    // Seeds for initial weights and mutations are recorded in the genomes
+    const uint64_t seed = this->config.seed;
+
     for (int i = 0; i < numDrones; i++) {
-        drones.push_back(std::make_shared<Drone>(fixedStartPos));
+        drones.push_back(std::make_shared<Drone>(fixedStartPos, config));
+        drones.back()->setTrajectoryArena(&arena);
 
         // Create neural network for each drone
-        // Input: 22 sensors (was 18), Hidden: 24, 16, Output: 4 (control signals)
-        // Increased hidden layer size for more learning capacity
-        std::vector<int> layerSizes = {22, 24, 16, 4};
-        auto network = std::make_shared<NeuralNetwork>(layerSizes);
+        // Input: 22 sensors (was 18), Hidden: 24, 16 by default, Output: 4 (control signals)
+        uint32_t initSeed = deriveSeed32(seed, SeedStream::NetworkInit, i);
+        auto network = std::make_shared<NeuralNetwork>(layerSizes, initSeed);
+        Genome genome = Genome::root(initSeed);
 
         // ВАЖНО: Добавляем небольшую случайную мутацию для РАЗНООБРАЗИЯ
         // Иначе все дроны летят одинаково!
         if (i > 0) {  // Первый дрон без мутации
-            network->mutate(0.3f, 0.5f);  // Сильная начальная мутация для разнообразия
+            uint32_t mutationSeed = deriveSeed32(seed, SeedStream::InitialMutation, i);
+            network->mutate(0.3f, 0.5f, mutationSeed);  // Сильная начальная мутация для разнообразия
+            genome = genome.mutated(mutationSeed, 0.3f, 0.5f);
         }
 
         networks.push_back(network);
+        genomes.push_back(genome);
         fitnessScores.push_back(0.0f);
     }
 
+    cachedEvaluation.assign(numDrones, false);
+    cachedDescriptors.resize(numDrones);
+
     environment.reset();
+    applyFitnessCache();
+}
+
+Swarm::~Swarm() {
+    stopWorkers();
 }
 
 void Swarm::reset() {
+    TRACE_SCOPE("Swarm::reset");
+
     // DON'T reset environment - keep the same hole position!
     // environment.reset();  // Commented out - hole stays in same place
 
@@ -46,17 +85,30 @@ void Swarm::reset() {
         drone->clearTrajectory(); // Clear trajectory history
     }
 
+    // Nothing from the last generation is left in the arenas
+    arena.reset();
+    for (auto& workerArena : workerArenas) {
+        workerArena->reset();
+    }
+
     // Reset fitness scores
     for (auto& score : fitnessScores) {
         score = 0.0f;
     }
 
     episodeTime = 0.0f;
+    generationCollisions = 0;
+    generationOutOfBounds = 0;
+    generationStartSteps = simulatedSteps;
+    generationStart = std::chrono::steady_clock::now();
+    episodeSteps = 0;
 
-    std::cout << "Reset complete - " << drones.size() << " drones ready at origin" << std::endl;
+    applyFitnessCache();
 }
 
 void Swarm::update(float dt) {
+    TRACE_SCOPE("Swarm::update");
+
     episodeTime += dt;
 
     // FIRST: Check if any drone already succeeded - if so, STOP immediately!
@@ -64,147 +116,285 @@ void Swarm::update(float dt) {
         return; // Don't update anything - success achieved!
     }
 
-    // Update each drone
-    for (size_t i = 0; i < drones.size(); i++) {
-        auto& drone = drones[i];
+    if (workers.empty()) {
+        // Update each drone
+        for (size_t i = 0; i < drones.size(); i++) {
+            if (!drones[i]->isActive()) {
+                continue;
+            }
+            float control[Drone::controlCount];
+            moveDrone(i, dt, control, arena);
+            if (settleDrone(i, dt, control)) {
+                return;
+            }
+        }
+    } else {
+        // Every slice moves its drones, then the outcomes are settled in
+        // drone order (so a success still ends the step at its drone; the
+        // drones after it have moved but are not scored)
+        {
+            std::lock_guard<std::mutex> lock(workerMutex);
+            workerDt = dt;
+            busyWorkers = static_cast<int>(workers.size());
+            workerJob++;
+        }
+        workReady.notify_all();
+        moveSlice(0, dt);
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            workDone.wait(lock, [this] { return busyWorkers == 0; });
+        }
 
-        if (!drone->isActive()) {
-            continue;
+        for (size_t i = 0; i < drones.size(); i++) {
+            if (drones[i]->isActive() && settleDrone(i, dt, &controls[i * Drone::controlCount])) {
+                return;
+            }
         }
+    }
+    episodeSteps++;
+
+    // Check if episode is over (time limit or all drones inactive)
+    bool allInactive = true;
+    for (const auto& drone : drones) {
+        if (drone->isActive()) {
+            allInactive = false;
+            break;
+        }
+    }
+
+    // A success returns from the loop above, so getting here means no drone
+    // has found the hole yet
+    if (allInactive || episodeTime >= maxEpisodeTime) {
+        // Episode failed - no drone found the hole, try again
+        finishGeneration(episodeTime >= maxEpisodeTime ? GenerationRecord::Timeout : GenerationRecord::AllInactive);
+
+        // Train and reset to try again
+        ScopedZoneTimer timer(MetricZone::Training);
+        storeFitnessCache();
+        if (generationCallback) {
+            generationCallback(*this);
+        }
+        trainNetworks();
+        reset();
+        generation++;
+    }
+}
+
+void Swarm::moveDrone(size_t i, float dt, float* control, Arena& scratch) {
+    Drone& drone = *drones[i];
+
+    float sensors[Drone::sensorCount];
+    {
+        ScopedZoneTimer timer(MetricZone::Sensors);
 
         // Get sensor readings
-        std::vector<float> sensors = drone->getSensorReadings(environment);
+        drone.writeSensorReadings(environment, sensors);
 
         // Record trajectory for learning
-        drone->recordStep(sensors);
+        drone.recordStep(sensors);
+    }
+
+    {
+        ScopedZoneTimer timer(MetricZone::Inference);
 
         // Get control from neural network
-        std::vector<float> control = networks[i]->forward(sensors);
+        networks[i]->forward(sensors, control, scratch);
+    }
+
+    {
+        ScopedZoneTimer timer(MetricZone::Physics);
 
         // Apply control
-        drone->applyControl(control);
+        drone.applyControl(control);
 
         // Update physics
-        drone->update(dt);
-
-        // Check if passed through hole
-        // New logic: check if drone is near wall AND in hole area
-        Vec3 pos = drone->getPosition();
-        float wallZ = environment.getWallZ();
-
-        // Check if drone is crossing the wall (from -0.5 to +1.0 units)
-        if (pos.z > wallZ - 0.5f && pos.z < wallZ + 1.0f && !drone->isSuccessful()) {
-            if (environment.isInHole(pos)) {
-                drone->setSuccessful(true);
-                drone->setActive(false);
-                fitnessScores[i] += trainer.calculateReward(*drone, environment, true, false);
-                std::cout << "\n🎉 🎉 🎉 УСПЕХ! Дрон " << i << " нашёл дыру! 🎉 🎉 🎉" << std::endl;
-                std::cout << "Позиция: (" << pos.x << ", " << pos.y << ", " << pos.z << ")" << std::endl;
-                std::cout << "Центр дыры: (" << environment.getHoleCenter().x << ", "
-                          << environment.getHoleCenter().y << ", " << environment.getHoleCenter().z << ")" << std::endl;
-                std::cout << "Поколение: " << generation << std::endl;
-                std::cout << "Время: " << episodeTime << "с" << std::endl;
-
-                // LEARN FROM SUCCESS - apply gradient-based learning!
-                learnFromSuccessfulTrajectory(i);
-
-                // EXIT IMMEDIATELY - don't process other drones!
-                return;
-            }
-        }
+        drone.update(dt);
+    }
+}
 
-        // Check for collision with wall
-        if (drone->hasCollided(environment)) {
-            drone->setActive(false);
-            fitnessScores[i] += trainer.calculateReward(*drone, environment, false, true);
-        }
+bool Swarm::settleDrone(size_t i, float dt, const float* control) {
+    auto& drone = drones[i];
+
+    simulatedSteps++;
+    float fitnessBefore = fitnessScores[i];
+
+    // Check if passed through hole
+    // New logic: check if drone is near wall AND in hole area
+    Vec3 pos = drone->getPosition();
+    float wallZ = environment.getWallZ();
 
-        // Check if drone went out of bounds (flew away)
-        if (environment.isOutOfBounds(drone->getPosition())) {
+    // Check if drone is crossing the wall (from -0.5 to +1.0 units)
+    if (pos.z > wallZ - 0.5f && pos.z < wallZ + 1.0f && !drone->isSuccessful()) {
+        if (environment.isInHole(pos)) {
+            drone->setSuccessful(true);
             drone->setActive(false);
-            fitnessScores[i] += trainer.calculateReward(*drone, environment, false, true);
-            // Note: treating out of bounds same as collision
-        }
+            fitnessScores[i] += trainer.calculateReward(*drone, environment, true, false);
+            if (episodeRecorder) {
+                episodeRecorder->record(generation, episodeSteps, i, *drone, control,
+                                        fitnessScores[i] - fitnessBefore, EpisodeStatus::Success);
+            }
 
-        // Update fitness continuously
-        if (drone->isActive()) {
-            fitnessScores[i] += trainer.calculateReward(*drone, environment, false, false) * dt;
+            // Reported once, through the metrics log
+            finishGeneration(GenerationRecord::Success);
+
+            // LEARN FROM SUCCESS - apply gradient-based learning!
+            ScopedZoneTimer timer(MetricZone::Training);
+            learnFromSuccessfulTrajectory(i);
+
+            // EXIT IMMEDIATELY - don't process other drones!
+            return true;
         }
     }
 
-    // Check if episode is over (time limit or all drones inactive)
-    bool allInactive = true;
-    for (const auto& drone : drones) {
-        if (drone->isActive()) {
-            allInactive = false;
-            break;
-        }
+    // Check for collision with wall
+    bool collided = drone->hasCollided(environment);
+    if (collided) {
+        drone->setActive(false);
+        fitnessScores[i] += trainer.calculateReward(*drone, environment, false, true);
+        generationCollisions++;
     }
 
-    // Check if any drone succeeded (VICTORY CONDITION!)
-    bool anySuccess = false;
-    for (const auto& drone : drones) {
-        if (drone->isSuccessful()) {
-            anySuccess = true;
-            break;
+    // Check if drone went out of bounds (flew away)
+    if (environment.isOutOfBounds(drone->getPosition())) {
+        drone->setActive(false);
+        fitnessScores[i] += trainer.calculateReward(*drone, environment, false, true);
+        // Note: treating out of bounds same as collision
+        if (!collided) {
+            generationOutOfBounds++;
         }
     }
 
-    if (anySuccess) {
-        // SUCCESS! At least one drone found the hole - STOP SIMULATION!
-        std::cout << "\n🎉 🎉 🎉 УСПЕХ! Дрон нашёл дыру! 🎉 🎉 🎉" << std::endl;
-        std::cout << "Поколение: " << generation << std::endl;
-        std::cout << "Время: " << episodeTime << "с" << std::endl;
-        std::cout << "Обучение завершено!" << std::endl;
-        // Don't reset - let the main loop handle exit
-        return;
+    // Update fitness continuously
+    if (drone->isActive()) {
+        fitnessScores[i] += trainer.calculateReward(*drone, environment, false, false) * dt;
     }
 
-    if (allInactive || episodeTime >= maxEpisodeTime) {
-        // Episode failed - no drone found the hole, try again
-        std::string reason = (episodeTime >= maxEpisodeTime) ? "ВРЕМЯ ВЫШЛО" : "ВСЕ СТОЛКНУЛИСЬ";
+    if (episodeRecorder) {
+        EpisodeStatus status = collided ? EpisodeStatus::Collided
+                             : drone->isActive() ? EpisodeStatus::Flying : EpisodeStatus::OutOfBounds;
+        episodeRecorder->record(generation, episodeSteps, i, *drone, control, fitnessScores[i] - fitnessBefore,
+                                status);
+    }
+    return false;
+}
 
-        std::cout << "\n=== Поколение " << generation << " - " << reason << " ===" << std::endl;
-        std::cout << "Длительность: " << std::fixed << std::setprecision(1) << episodeTime
-                  << "с / " << maxEpisodeTime << "с" << std::endl;
+void Swarm::setNumThreads(int threads) {
+    stopWorkers();
+    threads = std::max(1, std::min(threads, numDrones));
 
-        int collisionCount = 0;
-        for (const auto& drone : drones) {
-            if (!drone->isActive()) collisionCount++;
+    // Slice 0 (the calling thread) keeps the swarm's arena
+    workerArenas.clear();
+    for (int slice = 1; slice < threads; slice++) {
+        workerArenas.emplace_back(new Arena());
+    }
+    for (int slice = 0; slice < threads; slice++) {
+        Arena& sliceArena = slice == 0 ? arena : *workerArenas[slice - 1];
+        for (size_t i = sliceBegin(slice, threads); i < sliceBegin(slice + 1, threads); i++) {
+            drones[i]->setTrajectoryArena(&sliceArena);
         }
-        std::cout << "Неактивных дронов: " << collisionCount << "/" << drones.size() << std::endl;
+    }
+    controls.assign(threads > 1 ? drones.size() * Drone::controlCount : 0, 0.0f);
 
-        // Find and show best drone
-        int bestIdx = trainer.getBestNetworkIndex(fitnessScores);
+    stoppingWorkers = false;
+    for (int slice = 1; slice < threads; slice++) {
+        workers.emplace_back(&Swarm::workerLoop, this, slice);
+    }
+}
+
+size_t Swarm::sliceBegin(int slice, int threads) const {
+    return drones.size() * slice / threads;
+}
 
-        // Calculate average fitness
-        float avgFitness = 0.0f;
-        for (float fitness : fitnessScores) {
-            avgFitness += fitness;
+void Swarm::moveSlice(int slice, float dt) {
+    int threads = getNumThreads();
+    Arena& scratch = slice == 0 ? arena : *workerArenas[slice - 1];
+    for (size_t i = sliceBegin(slice, threads); i < sliceBegin(slice + 1, threads); i++) {
+        if (drones[i]->isActive()) {
+            moveDrone(i, dt, &controls[i * Drone::controlCount], scratch);
         }
-        avgFitness /= fitnessScores.size();
-
-        std::cout << "Лучший дрон: D" << bestIdx << " - Результат: " << std::fixed
-                  << std::setprecision(1) << fitnessScores[bestIdx] << std::endl;
-        std::cout << "Средний результат: " << std::fixed << std::setprecision(1)
-                  << avgFitness << std::endl;
-
-        // Show fitness scores for debugging (only if few drones)
-        if (drones.size() <= 10) {
-            std::cout << "Все результаты: ";
-            for (size_t i = 0; i < fitnessScores.size(); i++) {
-                std::cout << "D" << i << "=" << std::fixed << std::setprecision(0)
-                          << fitnessScores[i] << " ";
+    }
+}
+
+void Swarm::workerLoop(int slice) {
+    Trace::setThreadName("swarm worker");
+    uint64_t seenJob = 0;
+    while (true) {
+        float dt;
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            workReady.wait(lock, [&] { return stoppingWorkers || workerJob != seenJob; });
+            if (stoppingWorkers) {
+                return;
             }
-            std::cout << std::endl;
+            seenJob = workerJob;
+            dt = workerDt;
         }
 
-        // Train and reset to try again
-        trainNetworks();
-        reset();
-        generation++;
+        moveSlice(slice, dt);
+
+        std::lock_guard<std::mutex> lock(workerMutex);
+        if (--busyWorkers == 0) {
+            workDone.notify_one();
+        }
+    }
+}
+
+void Swarm::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        stoppingWorkers = true;
+    }
+    workReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // New workers start at job 0: a stale count would look like a posted job
+    std::lock_guard<std::mutex> lock(workerMutex);
+    workerJob = 0;
+}
 
-        std::cout << "\n>>> Запуск поколения " << generation << "...\n" << std::endl;
+void Swarm::finishGeneration(GenerationRecord::Outcome outcome) {
+    GenerationRecord record;
+    record.generation = generation;
+    record.seed = config.seed;
+    record.outcome = outcome;
+    record.drones = static_cast<int>(drones.size());
+    record.successes = 0;
+    record.cached = 0;
+    for (size_t i = 0; i < drones.size(); i++) {
+        record.successes += drones[i]->isSuccessful();
+        record.cached += cachedEvaluation[i];
+    }
+    record.collisions = generationCollisions;
+    record.outOfBounds = generationOutOfBounds;
+    record.episodeSeconds = episodeTime;
+    record.wallSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - generationStart).count();
+
+    std::vector<float> sorted = fitnessScores;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](float p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1) + 0.5f)]; };
+    float sum = 0.0f;
+    for (float fitness : sorted) {
+        sum += fitness;
+    }
+    record.bestFitness = sorted.back();
+    record.meanFitness = sum / sorted.size();
+    record.p10Fitness = percentile(0.1f);
+    record.medianFitness = percentile(0.5f);
+    record.p90Fitness = percentile(0.9f);
+    record.stepsPerSecond = record.wallSeconds > 0.0f
+        ? (simulatedSteps - generationStartSteps) / record.wallSeconds : 0.0;
+
+    lastGenerationBest = record.bestFitness;
+    lastGenerationMean = record.meanFitness;
+
+    if (metricsLog) {
+        metricsLog->push(record);
+    }
+    if (episodeRecorder) {
+        episodeRecorder->endGeneration();
     }
 }
 
@@ -237,16 +427,155 @@ void Swarm::coordinateTowardsSuccess(int successfulDroneIdx) {
 }
 
 void Swarm::trainNetworks() {
-    trainer.trainStep(networks, fitnessScores);
+    TRACE_SCOPE("Swarm::trainNetworks");
 
-    // Update best fitness
+    // Update best fitness (raw fitness, before the elite is chosen)
     int bestIdx = trainer.getBestNetworkIndex(fitnessScores);
     if (fitnessScores[bestIdx] > bestFitness) {
         bestFitness = fitnessScores[bestIdx];
-        std::cout << "New best fitness: " << bestFitness << " at generation " << generation << std::endl;
+    }
+
+    if (noveltyEnabled) {
+        // Select on fitness blended with novelty so the population
+        // doesn't collapse into the same local optimum
+        trainer.trainStep(networks, calculateSelectionScores(), genomes.empty() ? nullptr : &genomes);
+    } else {
+        trainer.trainStep(networks, fitnessScores, genomes.empty() ? nullptr : &genomes);
+    }
+}
+
+void Swarm::enableNoveltySearch(bool enabled, float weight) {
+    noveltyEnabled = enabled;
+    noveltyWeight = std::min(std::max(weight, 0.0f), 1.0f);
+}
+
+void Swarm::enableFitnessCache(bool enabled) {
+    fitnessCacheEnabled = enabled;
+    if (!enabled) {
+        fitnessCache.clear();
+        cachedEvaluation.assign(drones.size(), false);
+    }
+}
+
+void Swarm::applyFitnessCache() {
+    TRACE_SCOPE("Swarm::applyFitnessCache");
+
+    if (!fitnessCacheEnabled) {
+        return;
+    }
+
+    fitnessCache.setEvaluationKey(evaluationKey());
+
+    for (size_t i = 0; i < networks.size(); i++) {
+        const FitnessCache::Entry* entry = fitnessCache.lookup(networks[i]->hashParameters());
+        cachedEvaluation[i] = entry != nullptr;
+        if (entry) {
+            // Same genome, same environment -> same result; no need to fly again
+            fitnessScores[i] = entry->fitness;
+            cachedDescriptors[i] = entry->descriptor;
+            drones[i]->setActive(false);
+        }
     }
 }
 
+void Swarm::storeFitnessCache() {
+    TRACE_SCOPE("Swarm::storeFitnessCache");
+
+    if (!fitnessCacheEnabled) {
+        return;
+    }
+
+    // Networks don't change during an episode, so hashing now matches the lookup at reset
+    for (size_t i = 0; i < networks.size(); i++) {
+        if (!cachedEvaluation[i]) {
+            fitnessCache.store(networks[i]->hashParameters(), fitnessScores[i], getBehaviorDescriptor(i));
+        }
+    }
+}
+
+uint64_t Swarm::evaluationKey() const {
+    // Episodes are deterministic given the hole and the episode length
+    // (the start position is fixed)
+    float values[] = {
+        environment.getHoleCenter().x, environment.getHoleCenter().y, environment.getHoleCenter().z,
+        environment.getHoleRadius(), environment.getWallZ(),
+        maxEpisodeTime
+    };
+
+    uint64_t hash = 1469598103934665603ULL;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(values);
+    for (size_t i = 0; i < sizeof(values); i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::vector<float> Swarm::getBehaviorDescriptor(int droneIdx) const {
+    if (fitnessCacheEnabled && cachedEvaluation[droneIdx]) {
+        // Drone didn't fly this episode - use the behavior recorded with the cached fitness
+        return cachedDescriptors[droneIdx];
+    }
+    const Drone& drone = *drones[droneIdx];
+    size_t length = drone.getTrajectoryLength();
+    std::vector<float> descriptor;
+    descriptor.reserve(descriptorSamples * 3);
+
+    // Sensors 0-2 hold the position scaled by 1/10 - use the same scale throughout
+    for (int s = 1; s < descriptorSamples; s++) {
+        if (length == 0) {
+            descriptor.insert(descriptor.end(), 3, 0.0f);
+            continue;
+        }
+        const float* sensors = drone.getTrajectoryStep((length - 1) * s / descriptorSamples);
+        descriptor.insert(descriptor.end(), sensors, sensors + 3);
+    }
+
+    Vec3 finalPos = drone.getPosition();
+    descriptor.push_back(finalPos.x / 10.0f);
+    descriptor.push_back(finalPos.y / 10.0f);
+    descriptor.push_back(finalPos.z / 10.0f);
+
+    return descriptor;
+}
+
+std::vector<float> Swarm::calculateSelectionScores() {
+    TRACE_SCOPE("Swarm::calculateSelectionScores");
+
+    size_t n = drones.size();
+    std::vector<std::vector<float>> descriptors(n);
+    std::vector<float> novelty(n);
+
+    // Novelty is measured against behaviors of all previous generations
+    for (size_t i = 0; i < n; i++) {
+        descriptors[i] = getBehaviorDescriptor(i);
+        novelty[i] = noveltyArchive.novelty(descriptors[i]);
+    }
+    for (const auto& descriptor : descriptors) {
+        noveltyArchive.add(descriptor);
+    }
+
+    // Min-max normalize both signals - fitness is in the thousands, novelty ~1
+    auto normalize = [](std::vector<float> values) {
+        auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+        float lo = *minIt;
+        float range = *maxIt - lo;
+        for (float& v : values) {
+            v = range > 1e-6f ? (v - lo) / range : 0.0f;
+        }
+        return values;
+    };
+
+    std::vector<float> fitnessNorm = normalize(fitnessScores);
+    std::vector<float> noveltyNorm = normalize(novelty);
+
+    std::vector<float> scores(n);
+    for (size_t i = 0; i < n; i++) {
+        scores[i] = (1.0f - noveltyWeight) * fitnessNorm[i] + noveltyWeight * noveltyNorm[i];
+    }
+    return scores;
+}
+
 float Swarm::calculateFitness(int droneIdx) {
     return fitnessScores[droneIdx];
 }
@@ -256,12 +585,55 @@ void Swarm::saveBestNetwork(const std::string& filename) {
     networks[bestIdx]->save(filename);
 }
 
-void Swarm::loadNetwork(const std::string& filename) {
+bool Swarm::loadNetwork(const std::string& filename) {
     // Load network into all drones
-    networks[0]->load(filename);
+    if (!networks[0]->load(filename)) {
+        return false;
+    }
     for (size_t i = 1; i < networks.size(); i++) {
-        *networks[i] = networks[0]->clone();
+        *networks[i] = *networks[0];
     }
+
+    // Loaded weights can't be expressed as a seed chain
+    genomes.clear();
+    return true;
+}
+
+void Swarm::importGenome(int droneIdx, const std::vector<float>& params, float fitness) {
+    networks[droneIdx]->setParameters(params);
+    fitnessScores[droneIdx] = fitness;
+
+    // Foreign parameters have no seed chain in this population
+    genomes.clear();
+}
+
+bool Swarm::saveGenomeCheckpoint(const std::string& filename) const {
+    if (genomes.empty()) {
+        std::cerr << "Геномы недоступны (сеть загружена или дообучена) - чекпоинт не сохранён" << std::endl;
+        return false;
+    }
+    return saveGenomes(filename, layerSizes, genomes, config.seed);
+}
+
+bool Swarm::loadGenomeCheckpoint(const std::string& filename) {
+    std::vector<int> loadedSizes;
+    std::vector<Genome> loaded;
+    if (!loadGenomes(filename, loadedSizes, loaded)) {
+        return false;
+    }
+    if (loadedSizes != layerSizes || loaded.empty()) {
+        std::cerr << "Чекпоинт геномов не подходит к архитектуре сети: " << filename << std::endl;
+        return false;
+    }
+
+    // Materialize genomes into the existing networks (cycling if the population differs)
+    GenomeMaterializer materializer(layerSizes);
+    genomes.resize(networks.size());
+    for (size_t i = 0; i < networks.size(); i++) {
+        genomes[i] = loaded[i % loaded.size()];
+        materializer.materialize(genomes[i], *networks[i]);
+    }
+    return true;
 }
 
 bool Swarm::hasAnyDroneSucceeded() const {
@@ -274,21 +646,26 @@ bool Swarm::hasAnyDroneSucceeded() const {
 }
 
 void Swarm::learnFromSuccessfulTrajectory(int successfulDroneIdx) {
+    TRACE_SCOPE("Swarm::learnFromSuccessfulTrajectory");
+
     // Get successful drone's trajectory
-    const auto& trajectory = drones[successfulDroneIdx]->getTrajectory();
+    const Drone& drone = *drones[successfulDroneIdx];
+    size_t length = drone.getTrajectoryLength();
 
-    if (trajectory.empty()) {
+    if (length == 0) {
         return;
     }
 
-    std::cout << "Обучение на успешной траектории (" << trajectory.size() << " шагов)..." << std::endl;
+    if (verbose) {
+        std::cout << "Обучение на успешной траектории (" << length << " шагов)..." << std::endl;
+    }
 
     // Learning rate - small adjustments
     float learningRate = 0.01f;
 
     // Go through trajectory and learn: at each step, teach network to move towards hole
-    for (size_t step = 0; step < trajectory.size(); step++) {
-        const auto& sensors = trajectory[step];
+    for (size_t step = 0; step < length; step++) {
+        std::vector<float> sensors(drone.getTrajectoryStep(step), drone.getTrajectoryStep(step) + Drone::sensorCount);
 
         // Calculate desired direction (towards hole)
         // Sensors 6-8 contain direction to hole (already normalized)
@@ -305,14 +682,21 @@ void Swarm::learnFromSuccessfulTrajectory(int successfulDroneIdx) {
         }
     }
 
-    std::cout << "Обучение завершено! Нейросеть скорректирована на основе успешного пути." << std::endl;
+    if (verbose) {
+        std::cout << "Обучение завершено! Нейросеть скорректирована на основе успешного пути." << std::endl;
+    }
+
+    // Gradient updates aren't part of the seed chain
+    genomes.clear();
 
     // Now copy this improved network to ALL other drones
     for (size_t i = 0; i < networks.size(); i++) {
         if (i != successfulDroneIdx) {
-            *networks[i] = networks[successfulDroneIdx]->clone();
+            *networks[i] = *networks[successfulDroneIdx];  // Reuses the weight storage
         }
     }
 
-    std::cout << "Знания переданы всем " << networks.size() << " дронам!" << std::endl;
+    if (verbose) {
+        std::cout << "Знания переданы всем " << networks.size() << " дронам!" << std::endl;
+    }
 }
@@ -0,0 +1,55 @@
+#include "swarm_snapshot.h"
+#include "swarm.h"
+
+void SwarmSnapshot::capture(const Swarm& swarm) {
+    const auto& swarmDrones = swarm.getDrones();
+    drones.resize(swarmDrones.size());
+    for (size_t i = 0; i < swarmDrones.size(); i++) {
+        const Drone& drone = *swarmDrones[i];
+        DroneSnapshot& out = drones[i];
+        out.position = drone.getPosition();
+        out.radius = drone.getRadius();
+        if (drone.isSuccessful()) {
+            out.status = DroneSnapshot::Successful;
+        } else if (!drone.isActive()) {
+            out.status = DroneSnapshot::Failed;
+        } else {
+            out.status = DroneSnapshot::Active;
+        }
+    }
+
+    const Environment& env = swarm.getEnvironment();
+    holeCenter = env.getHoleCenter();
+    holeRadius = env.getHoleRadius();
+    wallZ = env.getWallZ();
+    boundsMin = env.getBoundsMin();
+    boundsMax = env.getBoundsMax();
+
+    generation = swarm.getGeneration();
+    bestFitness = swarm.getBestFitness();
+    lastGenerationBest = swarm.getLastGenerationBest();
+    lastGenerationMean = swarm.getLastGenerationMean();
+    episodeTime = swarm.getEpisodeTime();
+    maxEpisodeTime = swarm.getMaxEpisodeTime();
+    simulatedSteps = swarm.getSimulatedSteps();
+    succeeded = swarm.hasAnyDroneSucceeded();
+}
+
+SnapshotBuffer::SnapshotBuffer()
+    : middle(1), backIdx(0), frontIdx(2) {
+}
+
+void SnapshotBuffer::publish() {
+    // Release: the consumer must see the snapshot contents before the index
+    uint8_t previous = middle.exchange(backIdx | freshBit, std::memory_order_acq_rel);
+    backIdx = previous & ~freshBit;
+}
+
+bool SnapshotBuffer::acquire() {
+    if (!(middle.load(std::memory_order_relaxed) & freshBit)) {
+        return false;
+    }
+    uint8_t previous = middle.exchange(frontIdx, std::memory_order_acq_rel);
+    frontIdx = previous & ~freshBit;
+    return true;
+}
@@ -0,0 +1,138 @@
+#include "sweep_runner.h"
+#include "random_streams.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <map>
+
+// Split "name=rest" at the first '='
+static bool splitAssignment(const std::string& text, std::string& name, std::string& value) {
+    size_t eq = text.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        return false;
+    }
+    name = text.substr(0, eq);
+    value = text.substr(eq + 1);
+    return true;
+}
+
+static void printUsage() {
+    std::cout << "Использование: nndrons_sweep [опции]\n"
+              << "  --grid name=v1,v2,...     значения параметра для сетки (можно повторять)\n"
+              << "  --random N                случайный поиск: N конфигураций\n"
+              << "  --range name=lo:hi        диапазон для случайного поиска (можно повторять)\n"
+              << "  --seed S                  master seed: выборка случайного поиска и запуски\n"
+              << "  --set name=value          базовое значение параметра\n"
+              << "  --repeats R               запусков на конфигурацию (по умолчанию 1)\n"
+              << "  --threads T               потоков (по умолчанию все ядра)\n"
+              << "  --drones N                дронов в рое (по умолчанию 100)\n"
+              << "  --max-generations G       лимит поколений (по умолчанию 200)\n"
+              << "  --out file.csv            итоговый CSV (по умолчанию sweep.csv)\n"
+              << "Параметры:";
+    for (const auto& name : SimConfig::parameterNames()) {
+        std::cout << " " << name;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    SimConfig base;
+    SweepOptions options;
+    std::vector<std::pair<std::string, std::vector<std::string>>> grid;
+    std::vector<SweepRange> ranges;
+    int randomCount = 0;
+    std::string outFile = "sweep.csv";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string name, value;
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--grid" && hasValue && splitAssignment(argv[++i], name, value)) {
+            std::vector<std::string> values;
+            std::stringstream ss(value);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                values.push_back(item);
+            }
+            grid.push_back({name, values});
+        } else if (arg == "--range" && hasValue && splitAssignment(argv[++i], name, value)) {
+            size_t colon = value.find(':');
+            if (colon == std::string::npos) {
+                std::cerr << "Диапазон должен быть lo:hi: " << argv[i] << std::endl;
+                return 1;
+            }
+            ranges.push_back({name, std::stof(value.substr(0, colon)), std::stof(value.substr(colon + 1))});
+        } else if (arg == "--set" && hasValue && splitAssignment(argv[++i], name, value)) {
+            if (!base.set(name, value)) {
+                std::cerr << "Неверный параметр: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--random" && hasValue) {
+            randomCount = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            base.seed = std::stoull(argv[++i]);
+        } else if (arg == "--repeats" && hasValue) {
+            options.repeats = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::stoi(argv[++i]);
+        } else if (arg == "--drones" && hasValue) {
+            options.numDrones = std::stoi(argv[++i]);
+        } else if (arg == "--max-generations" && hasValue) {
+            options.maxGenerations = std::stoi(argv[++i]);
+        } else if (arg == "--out" && hasValue) {
+            outFile = argv[++i];
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // One master seed decides the sampled configurations and every run
+    if (!base.seed) {
+        base.seed = randomMasterSeed();
+    }
+    std::cout << "Seed: " << base.seed << std::endl;
+
+    std::vector<SimConfig> configs;
+    unsigned sampleSeed = deriveSeed32(base.seed, SeedStream::SweepSample, 0);
+    bool ok = randomCount > 0 ? sampleRandom(base, ranges, randomCount, sampleSeed, configs)
+                              : expandGrid(base, grid, configs);
+    if (!ok) {
+        return 1;
+    }
+
+    std::cout << "Конфигураций: " << configs.size() << ", запусков на каждую: " << options.repeats << std::endl;
+
+    std::vector<SweepResult> results = runSweep(configs, options);
+    if (!writeSweepCsv(outFile, results)) {
+        return 1;
+    }
+
+    // Per-configuration summary (mean over repeats)
+    std::cout << "\nИтог по конфигурациям:" << std::endl;
+    for (size_t c = 0; c < configs.size(); c++) {
+        int runs = 0, solved = 0;
+        double seconds = 0.0, steps = 0.0;
+        for (const auto& r : results) {
+            if (r.configId == (int)c) {
+                runs++;
+                solved += r.solved;
+                seconds += r.seconds;
+                steps += r.stepsPerSecond;
+            }
+        }
+        std::cout << "  #" << c;
+        for (const auto& axis : grid) {
+            std::cout << " " << axis.first << "=" << configs[c].get(axis.first);
+        }
+        for (const auto& range : ranges) {
+            std::cout << " " << range.name << "=" << configs[c].get(range.name);
+        }
+        std::cout << " | решено " << solved << "/" << runs << ", " << std::fixed << std::setprecision(1)
+                  << seconds / runs << "с, " << std::setprecision(0) << steps / runs << " шагов/с" << std::endl;
+    }
+    std::cout << "Результаты записаны в " << outFile << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include "sweep_runner.h"
+#include "swarm.h"
+#include "random_streams.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+bool expandGrid(const SimConfig& base,
+                const std::vector<std::pair<std::string, std::vector<std::string>>>& grid,
+                std::vector<SimConfig>& configs) {
+    configs.assign(1, base);
+
+    for (const auto& axis : grid) {
+        std::vector<SimConfig> expanded;
+        for (const auto& config : configs) {
+            for (const auto& value : axis.second) {
+                SimConfig next = config;
+                if (!next.set(axis.first, value)) {
+                    std::cerr << "Неверный параметр сетки: " << axis.first << "=" << value << std::endl;
+                    configs.clear();
+                    return false;
+                }
+                expanded.push_back(next);
+            }
+        }
+        configs.swap(expanded);
+    }
+    return true;
+}
+
+bool sampleRandom(const SimConfig& base, const std::vector<SweepRange>& ranges,
+                  int count, unsigned seed, std::vector<SimConfig>& configs) {
+    std::mt19937 rng(seed);
+    configs.clear();
+
+    for (int i = 0; i < count; i++) {
+        SimConfig config = base;
+        for (const auto& range : ranges) {
+            std::uniform_real_distribution<float> dist(range.lo, range.hi);
+            if (!config.set(range.name, std::to_string(dist(rng)))) {
+                std::cerr << "Неверный параметр диапазона: " << range.name << std::endl;
+                configs.clear();
+                return false;
+            }
+        }
+        configs.push_back(config);
+    }
+    return true;
+}
+
+// Train one configuration headless until success or the generation limit
+static SweepResult runJob(int configId, int repeat, const SimConfig& config, const SweepOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Repeats of one configuration must not share a seed
+    SimConfig jobConfig = config;
+    if (jobConfig.seed && repeat > 0) {
+        jobConfig.seed = deriveSeed(jobConfig.seed, SeedStream::Repeat, repeat);
+    }
+    Swarm swarm(options.numDrones, jobConfig);
+    swarm.setVerbose(false);
+
+    const float targetDt = 1.0f / 60.0f;
+    while (!swarm.hasAnyDroneSucceeded() && swarm.getGeneration() < options.maxGenerations) {
+        swarm.update(targetDt);
+    }
+
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+    SweepResult result;
+    result.configId = configId;
+    result.repeat = repeat;
+    result.config = swarm.getConfig();  // With the seed actually used
+    result.solved = swarm.hasAnyDroneSucceeded();
+    result.generations = swarm.getGeneration();
+    result.seconds = seconds;
+    result.bestFitness = swarm.getBestFitness();
+    result.stepsPerSecond = seconds > 0.0f ? swarm.getSimulatedSteps() / seconds : 0.0;
+    return result;
+}
+
+struct SweepJob {
+    int configId;
+    int repeat;
+};
+
+// Per-worker deque: the owner pops from the back, thieves take from the front
+struct SweepWorkerQueue {
+    std::mutex mutex;
+    std::deque<SweepJob> jobs;
+};
+
+static bool popOwn(SweepWorkerQueue& queue, SweepJob& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+static bool steal(SweepWorkerQueue& queue, SweepJob& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+}
+
+std::vector<SweepResult> runSweep(const std::vector<SimConfig>& configs, const SweepOptions& options) {
+    int threads = options.threads > 0 ? options.threads
+                                      : std::max(1u, std::thread::hardware_concurrency());
+    int totalJobs = configs.size() * options.repeats;
+    threads = std::max(1, std::min(threads, totalJobs));
+
+    // Deal jobs round-robin; run times differ wildly (a lucky config solves in
+    // one generation), so idle workers steal from the others
+    std::vector<std::unique_ptr<SweepWorkerQueue>> queues;
+    for (int t = 0; t < threads; t++) {
+        queues.push_back(std::make_unique<SweepWorkerQueue>());
+    }
+    int next = 0;
+    for (int repeat = 0; repeat < options.repeats; repeat++) {
+        for (size_t c = 0; c < configs.size(); c++) {
+            queues[next++ % threads]->jobs.push_back({(int)c, repeat});
+        }
+    }
+
+    std::vector<SweepResult> results;
+    std::mutex resultsMutex;
+
+    auto worker = [&](int self) {
+        SweepJob job;
+        while (true) {
+            bool found = popOwn(*queues[self], job);
+            for (int k = 1; !found && k < threads; k++) {
+                found = steal(*queues[(self + k) % threads], job);
+            }
+            if (!found) {
+                return;  // Jobs are never added after start, so empty everywhere = done
+            }
+
+            SweepResult result = runJob(job.configId, job.repeat, configs[job.configId], options);
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            results.push_back(result);
+            if (options.progress) {
+                std::cout << "[" << results.size() << "/" << totalJobs << "] конфигурация "
+                          << result.configId << " #" << result.repeat << ": "
+                          << (result.solved ? "решено" : "не решено") << " за "
+                          << result.generations << " поколений, " << std::fixed << std::setprecision(1)
+                          << result.seconds << "с" << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back(worker, t);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    std::sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        return a.configId != b.configId ? a.configId < b.configId : a.repeat < b.repeat;
+    });
+    return results;
+}
+
+bool writeSweepCsv(const std::string& filename, const std::vector<SweepResult>& results) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Ошибка открытия файла для сохранения: " << filename << std::endl;
+        return false;
+    }
+
+    file << "config_id,repeat";
+    for (const auto& name : SimConfig::parameterNames()) {
+        file << "," << name;
+    }
+    file << ",solved,generations,seconds,best_fitness,steps_per_sec\n";
+
+    for (const auto& r : results) {
+        file << r.configId << "," << r.repeat;
+        for (const auto& name : SimConfig::parameterNames()) {
+            file << "," << r.config.get(name);
+        }
+        file << "," << (r.solved ? 1 : 0) << "," << r.generations << "," << r.seconds
+             << "," << r.bestFitness << "," << (long long)r.stepsPerSecond << "\n";
+    }
+    return file.good();
+}
@@ -0,0 +1,122 @@
+#include "td3_learner.h"
+#include "random_streams.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+
+static std::vector<int> criticLayers(const std::vector<int>& actorLayers, const TD3Config& config) {
+    std::vector<int> layers = {actorLayers.front() + actorLayers.back()};  // Observation + action
+    layers.insert(layers.end(), config.criticHidden.begin(), config.criticHidden.end());
+    layers.push_back(1);
+    return layers;
+}
+
+TD3Learner::TD3Learner(const std::vector<int>& actorLayers, const TD3Config& config, uint64_t seed)
+    : config(config),
+      actor(actorLayers, false, deriveSeed32(seed, SeedStream::NetworkInit, 0)),
+      actorTarget(actor),
+      critic1(criticLayers(actorLayers, config), true, deriveSeed32(seed, SeedStream::NetworkInit, 1)),
+      critic2(criticLayers(actorLayers, config), true, deriveSeed32(seed, SeedStream::NetworkInit, 2)),
+      critic1Target(critic1), critic2Target(critic2),
+      rng(deriveSeed32(seed, SeedStream::ReplaySample, 0)),
+      updates(0), criticLoss(0.0f), actorVersion(0), stopping(false) {
+    publishActor();
+}
+
+TD3Learner::~TD3Learner() {
+    stop();
+}
+
+bool TD3Learner::trainStep(ReplayBuffer& buffer) {
+    TRACE_SCOPE("TD3Learner::trainStep");
+
+    if (!buffer.sample(config.batchSize, rng, batch)) {
+        return false;
+    }
+    const int n = config.batchSize;
+    const int observationSize = buffer.getObservationSize();
+    const int actionSize = buffer.getActionSize();
+
+    // Target: r + gamma * min(Q1', Q2')(s', smoothed actor'(s'))
+    Eigen::MatrixXf nextActions = actorTarget.predict(batch.nextObservations);
+    std::normal_distribution<float> noise(0.0f, config.targetNoise);
+    for (int i = 0; i < nextActions.size(); i++) {
+        float eps = std::max(-config.noiseClip, std::min(config.noiseClip, noise(rng)));
+        nextActions.data()[i] = std::max(-1.0f, std::min(1.0f, nextActions.data()[i] + eps));
+    }
+
+    Eigen::MatrixXf input(observationSize + actionSize, n);
+    input.topRows(observationSize) = batch.nextObservations;
+    input.bottomRows(actionSize) = nextActions;
+    Eigen::RowVectorXf nextQ = critic1Target.predict(input).cwiseMin(critic2Target.predict(input));
+    Eigen::RowVectorXf target = config.rewardScale * batch.rewards +
+                                config.gamma * (1.0f - batch.terminals.array()).matrix().cwiseProduct(nextQ);
+
+    // Critics: mean squared TD error
+    input.topRows(observationSize) = batch.observations;
+    input.bottomRows(actionSize) = batch.actions;
+    float loss = 0.0f;
+    for (BatchMlp* critic : {&critic1, &critic2}) {
+        Eigen::RowVectorXf error = critic->forward(input) - target;
+        loss += error.squaredNorm() / n;
+        critic->backward((2.0f / n) * error);
+        critic->adamStep(config.criticLearningRate);
+    }
+    criticLoss.store(loss * 0.5f, std::memory_order_relaxed);
+
+    long long update = updates.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    // Delayed actor: ascend Q1(s, actor(s)), then move the targets
+    if (update % config.policyDelay == 0) {
+        input.bottomRows(actionSize) = actor.forward(batch.observations);
+        critic1.forward(input);
+        Eigen::MatrixXf inputGradient = critic1.backward(Eigen::RowVectorXf::Constant(n, -1.0f / n), false);
+        actor.backward(inputGradient.bottomRows(actionSize));
+        actor.adamStep(config.actorLearningRate);
+
+        actorTarget.softUpdate(actor, config.tau);
+        critic1Target.softUpdate(critic1, config.tau);
+        critic2Target.softUpdate(critic2, config.tau);
+    }
+
+    if (update % config.publishInterval == 0) {
+        publishActor();
+    }
+    return true;
+}
+
+void TD3Learner::publishActor() {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    actor.getParameters(publishedActor);
+    actorVersion.fetch_add(1, std::memory_order_release);
+}
+
+void TD3Learner::getActorParameters(std::vector<float>& params) const {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    params = publishedActor;
+}
+
+void TD3Learner::start(ReplayBuffer& buffer, float replayRatio) {
+    stop();
+    stopping = false;
+    thread = std::thread(&TD3Learner::run, this, &buffer, replayRatio);
+}
+
+void TD3Learner::stop() {
+    stopping = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void TD3Learner::run(ReplayBuffer* buffer, float replayRatio) {
+    Trace::setThreadName("td3 learner");
+    while (!stopping.load()) {
+        long long allowed = (long long)(buffer->getPushed() * (double)replayRatio / config.batchSize);
+        if (getUpdates() >= allowed || !trainStep(*buffer)) {
+            // Ahead of the collectors (or still warming up)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    publishActor();
+}
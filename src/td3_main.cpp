@@ -0,0 +1,316 @@
+#include "td3_learner.h"
+#include "vec_env.h"
+#include "swarm.h"
+#include "random_streams.h"
+#include "policy_eval.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <algorithm>
+
+// Sample efficiency of off-policy TD3 against the evolutionary RLTrainer:
+// both get the same budget of environment steps (drone-steps) and their
+// current best policy is evaluated on the same fixed episodes along the way.
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    long long envSteps = 1000000;
+    long long evalEvery = 100000;
+    int evalEpisodes = 100;
+    int collectors = 2;
+    int envsPerCollector = 64;
+    float replayRatio = 32.0f;    // Sampled transitions per collected transition
+    float explorationNoise = 0.3f;
+    long long warmupSteps = 20000;  // Uniform random actions before the first update
+    size_t bufferCapacity = 1 << 20;
+    int drones = 100;             // Evolution population
+    bool td3 = true;
+    bool evolution = true;
+    std::string saveFile;         // Best evaluated TD3 actor (NeuralNetwork::save format)
+};
+
+// Env-steps until the first successful training episode (-1 = none yet)
+static std::atomic<long long> firstSuccessSteps[2] = {{-1}, {-1}};
+enum Method { TD3, Evolution };
+
+struct Checkpoint {
+    const char* method;
+    long long envSteps;
+    float successRate;
+    float meanReturn;
+    float wallSeconds;
+};
+
+static void evaluate(const BatchMlp& policy, const SimConfig& config, int episodes,
+                     float& successRate, float& meanReturn) {
+    PolicyEvaluation evaluation = evaluatePolicy(
+        [&](const Eigen::MatrixXf& observations, Eigen::MatrixXf& actions) { actions = policy.predict(observations); },
+        config, episodes);
+    successRate = evaluation.successRate;
+    meanReturn = evaluation.meanReturn;
+}
+
+// A simulation thread's envs and its copy of the actor
+struct Collector {
+    VecEnv env;
+    BatchMlp policy;
+    uint64_t policyVersion;
+    std::mt19937 rng;
+    Eigen::MatrixXf observations, nextObservations, actions;
+    std::vector<float> rewards;
+    std::vector<uint8_t> dones;
+
+    Collector(int numEnvs, const SimConfig& config, const std::vector<int>& layers, uint32_t seed)
+        : env(numEnvs, config, 1), policy(layers, false, seed), policyVersion(0), rng(seed),
+          observations(VecEnv::observationSize, numEnvs), nextObservations(VecEnv::observationSize, numEnvs),
+          actions(VecEnv::actionSize, numEnvs), rewards(numEnvs), dones(numEnvs) {
+        env.reset(nullptr, observations.data());
+    }
+};
+
+static void collect(Collector& c, ReplayBuffer& buffer, TD3Learner& learner, const Options& options,
+                    int batchSize, long long stepLimit, std::atomic<long long>& envSteps) {
+    const int n = c.env.getNumEnvs();
+    std::normal_distribution<float> noise(0.0f, options.explorationNoise);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::vector<float> params;
+
+    while (envSteps.fetch_add(n) < stepLimit) {
+        if (learner.getActorVersion() != c.policyVersion) {
+            c.policyVersion = learner.getActorVersion();
+            learner.getActorParameters(params);
+            c.policy.setParameters(params);
+        }
+
+        if ((long long)buffer.getPushed() < options.warmupSteps) {
+            for (int i = 0; i < c.actions.size(); i++) {
+                c.actions.data()[i] = uniform(c.rng);
+            }
+        } else {
+            c.actions = c.policy.predict(c.observations);
+            for (int i = 0; i < c.actions.size(); i++) {
+                c.actions.data()[i] = std::max(-1.0f, std::min(1.0f, c.actions.data()[i] + noise(c.rng)));
+            }
+        }
+
+        c.env.step(c.actions.data(), c.nextObservations.data(), c.rewards.data(), c.dones.data());
+        for (int i = 0; i < n; i++) {
+            if (c.dones[i] == VecEnv::Success && firstSuccessSteps[TD3].load() < 0) {
+                long long none = -1;
+                firstSuccessSteps[TD3].compare_exchange_strong(none, envSteps.load());
+            }
+            // A timed-out env's next row is already the new episode; the
+            // transition can't be bootstrapped, so drop it
+            if (c.dones[i] != VecEnv::Timeout) {
+                buffer.push(c.observations.col(i).data(), c.actions.col(i).data(), c.rewards[i],
+                            c.nextObservations.col(i).data(), c.dones[i] != VecEnv::Running);
+            }
+        }
+        std::swap(c.observations, c.nextObservations);
+
+        // Don't run away from the learner
+        while ((long long)(buffer.getPushed() * (double)options.replayRatio / batchSize) - learner.getUpdates() > 1000 &&
+               (long long)buffer.getPushed() >= options.warmupSteps) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+}
+
+static void runTD3(const SimConfig& config, const Options& options, std::vector<Checkpoint>& checkpoints) {
+    auto start = Clock::now();
+    TD3Config td3;
+    ReplayBuffer buffer(options.bufferCapacity, VecEnv::observationSize, VecEnv::actionSize);
+    TD3Learner learner(config.layerSizes, td3, config.seed);
+
+    std::vector<std::unique_ptr<Collector>> collectors;
+    for (int c = 0; c < options.collectors; c++) {
+        SimConfig collectorConfig = config;
+        collectorConfig.seed = deriveSeed(config.seed, SeedStream::Exploration, c);
+        collectors.emplace_back(new Collector(options.envsPerCollector, collectorConfig, config.layerSizes,
+                                              deriveSeed32(config.seed, SeedStream::Exploration, c)));
+    }
+
+    BatchMlp policy(config.layerSizes, false, 0);
+    std::vector<float> params;
+    std::atomic<long long> envSteps(0);
+    float bestSuccessRate = -1.0f;
+    for (long long limit = options.evalEvery; limit <= options.envSteps; limit += options.evalEvery) {
+        learner.start(buffer, options.replayRatio);
+        std::vector<std::thread> threads;
+        for (auto& collector : collectors) {
+            threads.emplace_back(collect, std::ref(*collector), std::ref(buffer), std::ref(learner),
+                                 std::cref(options), td3.batchSize, limit, std::ref(envSteps));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        envSteps = limit;  // Drop the overshoot of the last claims
+
+        // Let the learner finish the updates this data allows, then freeze it
+        long long due = (long long)(buffer.getPushed() * (double)options.replayRatio / td3.batchSize);
+        while (buffer.getPushed() >= (uint64_t)td3.batchSize && learner.getUpdates() < due) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        learner.stop();
+
+        learner.getActorParameters(params);
+        policy.setParameters(params);
+        Checkpoint checkpoint = {"td3", limit, 0.0f, 0.0f, 0.0f};
+        evaluate(policy, config, options.evalEpisodes, checkpoint.successRate, checkpoint.meanReturn);
+        checkpoint.wallSeconds = std::chrono::duration<float>(Clock::now() - start).count();
+        checkpoints.push_back(checkpoint);
+        if (!options.saveFile.empty() && checkpoint.successRate > bestSuccessRate) {
+            bestSuccessRate = checkpoint.successRate;
+            NeuralNetwork network(config.layerSizes, 0u);
+            policy.copyTo(network);
+            network.save(options.saveFile);
+        }
+
+        std::cout << "td3       шагов " << std::setw(9) << limit << " | успех " << std::setw(5) << std::fixed
+                  << std::setprecision(1) << checkpoint.successRate * 100.0f << "% | возврат "
+                  << std::setw(8) << checkpoint.meanReturn << " | обновлений " << learner.getUpdates()
+                  << ", ошибка критика " << std::setprecision(4) << learner.getCriticLoss() << std::endl;
+    }
+}
+
+static void runEvolution(const SimConfig& config, const Options& options, std::vector<Checkpoint>& checkpoints) {
+    auto start = Clock::now();
+    Swarm swarm(options.drones, config);
+    swarm.setVerbose(false);
+    swarm.enableFitnessCache(false);  // Cached fitness belongs to the previous hole
+
+    // Same task distribution as the TD3 envs: a new random hole every
+    // generation (the swarm alone keeps one hole for the whole run)
+    std::mt19937 holeRng(deriveSeed32(config.seed, SeedStream::Environment, 0));
+    std::uniform_real_distribution<float> holeDist(-10.0f, 10.0f);
+    auto moveHole = [&] { swarm.setHoleCenter(Vec3(holeDist(holeRng), holeDist(holeRng), 0.0f)); };
+    moveHole();
+
+    // Best network of the last finished generation (fitness is final in the callback)
+    std::vector<float> best;
+    swarm.getNetworks()[0]->getParameters(best);
+    swarm.setGenerationCallback([&](Swarm& s) {
+        const std::vector<float>& scores = s.getFitnessScores();
+        size_t idx = std::max_element(scores.begin(), scores.end()) - scores.begin();
+        s.getNetworks()[idx]->getParameters(best);
+        moveHole();
+    });
+
+    BatchMlp policy(config.layerSizes, false, 0);
+    const float dt = 1.0f / 60.0f;
+    for (long long limit = options.evalEvery; limit <= options.envSteps; limit += options.evalEvery) {
+        while (swarm.getSimulatedSteps() < limit) {
+            swarm.update(dt);
+            int successful = swarm.getSuccessfulDroneIndex();
+            if (successful >= 0) {
+                // The swarm stops at a success; keep that drone as the best
+                // and carry on with the next generation
+                long long none = -1;
+                firstSuccessSteps[Evolution].compare_exchange_strong(none, swarm.getSimulatedSteps());
+                swarm.getNetworks()[successful]->getParameters(best);
+                swarm.trainNetworks();
+                moveHole();
+                swarm.reset();
+            }
+        }
+
+        policy.setParameters(best);
+        Checkpoint checkpoint = {"evolution", limit, 0.0f, 0.0f, 0.0f};
+        evaluate(policy, config, options.evalEpisodes, checkpoint.successRate, checkpoint.meanReturn);
+        checkpoint.wallSeconds = std::chrono::duration<float>(Clock::now() - start).count();
+        checkpoints.push_back(checkpoint);
+
+        std::cout << "evolution шагов " << std::setw(9) << limit << " | успех " << std::setw(5) << std::fixed
+                  << std::setprecision(1) << checkpoint.successRate * 100.0f << "% | возврат "
+                  << std::setw(8) << checkpoint.meanReturn << " | поколение " << swarm.getGeneration() << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    SimConfig config;
+    Options options;
+    std::string outFile;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--env-steps" && i + 1 < argc) {
+            options.envSteps = std::stoll(argv[++i]);
+        } else if (arg == "--eval-every" && i + 1 < argc) {
+            options.evalEvery = std::max(1LL, std::stoll(argv[++i]));
+        } else if (arg == "--eval-episodes" && i + 1 < argc) {
+            options.evalEpisodes = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--collectors" && i + 1 < argc) {
+            options.collectors = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--envs" && i + 1 < argc) {
+            options.envsPerCollector = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--replay-ratio" && i + 1 < argc) {
+            options.replayRatio = std::stof(argv[++i]);
+        } else if (arg == "--drones" && i + 1 < argc) {
+            options.drones = std::stoi(argv[++i]);
+        } else if (arg == "--only" && i + 1 < argc) {
+            std::string method = argv[++i];
+            options.td3 = method == "td3";
+            options.evolution = method == "evolution";
+        } else if (arg == "--seed" && i + 1 < argc) {
+            config.seed = std::stoull(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outFile = argv[++i];
+        } else if (arg == "--save" && i + 1 < argc) {
+            options.saveFile = argv[++i];
+        } else if (arg == "--set" && i + 1 < argc) {
+            std::string assignment = argv[++i];
+            size_t eq = assignment.find('=');
+            if (eq == std::string::npos ||
+                !config.set(assignment.substr(0, eq), assignment.substr(eq + 1))) {
+                std::cerr << "Неверный параметр: " << assignment << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "Использование: nndrons_td3 [--env-steps N] [--eval-every N] [--eval-episodes N]\n"
+                      << "  [--collectors C] [--envs N] [--replay-ratio R] [--drones N] [--only td3|evolution]\n"
+                      << "  [--seed S] [--out FILE.csv] [--save best_network.bin] [--set name=value]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (!config.seed) {
+        config.seed = randomMasterSeed();
+    }
+    std::cout << "Seed: " << config.seed << ", бюджет " << options.envSteps << " шагов, оценка на "
+              << options.evalEpisodes << " эпизодах каждые " << options.evalEvery << " шагов" << std::endl;
+
+    std::vector<Checkpoint> checkpoints;
+    if (options.td3) {
+        runTD3(config, options, checkpoints);
+    }
+    if (options.evolution) {
+        runEvolution(config, options, checkpoints);
+    }
+
+    const char* names[2] = {"td3", "evolution"};
+    for (int m = 0; m < 2; m++) {
+        if (m == TD3 ? options.td3 : options.evolution) {
+            std::cout << names[m] << ": первый успех в обучении "
+                      << (firstSuccessSteps[m] >= 0 ? "на шаге " + std::to_string(firstSuccessSteps[m].load())
+                                                    : std::string("не достигнут")) << std::endl;
+        }
+    }
+
+    if (!outFile.empty()) {
+        std::ofstream file(outFile);
+        if (!file.is_open()) {
+            std::cerr << "Ошибка открытия файла для сохранения: " << outFile << std::endl;
+            return 1;
+        }
+        file << "method,env_steps,success_rate,mean_return,wall_s\n";
+        for (const auto& c : checkpoints) {
+            file << c.method << "," << c.envSteps << "," << c.successRate << "," << c.meanReturn
+                 << "," << c.wallSeconds << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+
+std::atomic<bool> Trace::enabledFlag(false);
+
+namespace {
+
+// Single-producer ring: only the owning thread writes, any thread may read.
+// Slots are relaxed atomics so a concurrent dump is race-free; a reader drops
+// the slots the writer may have overwritten while they were being copied.
+struct ThreadRing {
+    struct Slot {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+    };
+
+    std::atomic<uint64_t> head{0};  // Events ever written
+    Slot slots[Trace::ringCapacity];
+    int tid = 0;
+    std::string threadName;  // Guarded by registryMutex
+};
+
+struct Event {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Rings are never freed, so events of finished threads survive until the dump
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadRing>> registry;
+const uint64_t processStart = Trace::now();
+
+// A thread gets its ring on the first recorded event, so threads that never
+// trace cost nothing; a name set before that is kept here
+thread_local ThreadRing* currentRing = nullptr;
+thread_local std::string pendingThreadName;
+
+ThreadRing* threadRing() {
+    ThreadRing*& ring = currentRing;
+    if (!ring) {
+        auto owned = std::make_unique<ThreadRing>();
+        owned->threadName = pendingThreadName;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        owned->tid = static_cast<int>(registry.size()) + 1;
+        ring = owned.get();
+        registry.push_back(std::move(owned));
+    }
+    return ring;
+}
+
+void snapshotRing(const ThreadRing& ring, std::vector<Event>& events) {
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    uint64_t first = head > Trace::ringCapacity ? head - Trace::ringCapacity : 0;
+
+    size_t base = events.size();
+    for (uint64_t i = first; i < head; i++) {
+        const auto& slot = ring.slots[i % Trace::ringCapacity];
+        events.push_back({slot.name.load(std::memory_order_relaxed),
+                          slot.start.load(std::memory_order_relaxed),
+                          slot.end.load(std::memory_order_relaxed)});
+    }
+
+    // Anything at or behind the slot being written now may be torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t newHead = ring.head.load(std::memory_order_relaxed);
+    if (newHead + 1 > first + Trace::ringCapacity) {
+        uint64_t stale = std::min(newHead + 1 - Trace::ringCapacity - first, head - first);
+        events.erase(events.begin() + base, events.begin() + base + stale);
+    }
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            out << '\\' << ch;
+        } else if (static_cast<unsigned char>(ch) >= 0x20) {
+            out << ch;
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+bool Trace::compiledIn() {
+#ifdef NNDRONS_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Trace::record(const char* name, uint64_t start, uint64_t end) {
+    ThreadRing* ring = threadRing();
+    uint64_t index = ring->head.load(std::memory_order_relaxed);
+    auto& slot = ring->slots[index % ringCapacity];
+
+    // Pairs with the reader's acquire fence: a reader that sees any of these
+    // stores also sees head >= index and discards this slot
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    ring->head.store(index + 1, std::memory_order_release);
+}
+
+void Trace::setThreadName(const std::string& name) {
+    if (!currentRing) {
+        pendingThreadName = name;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(registryMutex);
+    currentRing->threadName = name;
+}
+
+bool Trace::writeChromeJson(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Ошибка открытия файла трассировки: " << filename << std::endl;
+        return false;
+    }
+
+    int pid = static_cast<int>(getpid());
+    size_t total = 0;
+    bool first = true;
+    std::vector<Event> events;
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& ring : registry) {
+        if (!ring->threadName.empty()) {
+            file << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                 << ",\"tid\":" << ring->tid << ",\"args\":{\"name\":";
+            writeJsonString(file, ring->threadName);
+            file << "}}";
+            first = false;
+        }
+
+        events.clear();
+        snapshotRing(*ring, events);
+        total += events.size();
+
+        // Complete events, microseconds since process start
+        char line[256];
+        for (const Event& event : events) {
+            double ts = (event.start - processStart) / 1000.0;
+            double dur = (event.end - event.start) / 1000.0;
+            std::snprintf(line, sizeof(line), "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                          event.name, ts, dur, pid, ring->tid);
+            file << (first ? "\n" : ",\n") << line;
+            first = false;
+        }
+    }
+
+    file << "\n]}\n";
+    if (!file) {
+        std::cerr << "Ошибка записи файла трассировки: " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Трассировка записана в " << filename << " (" << total << " событий)" << std::endl;
+    return true;
+}
@@ -0,0 +1,223 @@
+#include "vec_env.h"
+#include "batch_physics.h"
+#include "random_streams.h"
+#include "trace.h"
+#include <algorithm>
+
+static SimConfig withMasterSeed(SimConfig config) {
+    if (!config.seed) {
+        config.seed = randomMasterSeed();
+    }
+    return config;
+}
+
+static SimConfig envConfig(const SimConfig& config, uint64_t seed) {
+    SimConfig result = config;
+    result.seed = seed ? seed : 1;  // 0 would mean "draw a random seed"
+    return result;
+}
+
+VecEnv::VecEnv(int numEnvs, const SimConfig& config, int numThreads)
+    : numEnvs(std::max(0, numEnvs)), config(withMasterSeed(config)), trainer(this->config),
+      dt(1.0f / 60.0f), startPosition(0.0f, 0.0f, -35.0f),  // Same start as Swarm
+      episodeTimes(this->numEnvs, 0.0f),
+      job(Job::Step), jobSeeds(nullptr), jobActions(nullptr), jobObservations(nullptr),
+      jobRewards(nullptr), jobDones(nullptr),
+      jobId(0), busyWorkers(0), stopping(false), nextChunk(0) {
+    environments.reserve(this->numEnvs);
+    drones.reserve(this->numEnvs);
+    for (int i = 0; i < this->numEnvs; i++) {
+        environments.emplace_back(envConfig(this->config, deriveSeed(this->config.seed, SeedStream::VecEnv, i)));
+        drones.emplace_back(startPosition, this->config);
+    }
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // No more threads than chunks
+    int chunks = (this->numEnvs + chunkSize - 1) / chunkSize;
+    numThreads = std::max(1, std::min(numThreads, chunks));
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&VecEnv::workerLoop, this);
+    }
+}
+
+VecEnv::~VecEnv() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void VecEnv::reset(const uint64_t* seeds, float* observations) {
+    TRACE_SCOPE("VecEnv::reset");
+    jobSeeds = seeds;
+    jobObservations = observations;
+    run(Job::Reset);
+}
+
+void VecEnv::step(const float* actions, float* observations, float* rewards, uint8_t* dones) {
+    TRACE_SCOPE("VecEnv::step");
+    jobActions = actions;
+    jobObservations = observations;
+    jobRewards = rewards;
+    jobDones = dones;
+    run(Job::Step);
+}
+
+void VecEnv::run(Job nextJob) {
+    job = nextJob;
+    nextChunk = 0;
+
+    if (workers.empty()) {
+        processChunks();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busyWorkers = static_cast<int>(workers.size());
+        jobId++;
+    }
+    jobReady.notify_all();
+
+    processChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobDone.wait(lock, [this] { return busyWorkers == 0; });
+}
+
+void VecEnv::workerLoop() {
+    Trace::setThreadName("vec env worker");
+    uint64_t seenJob = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [&] { return stopping || jobId != seenJob; });
+            if (stopping) {
+                return;
+            }
+            seenJob = jobId;
+        }
+
+        processChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            jobDone.notify_one();
+        }
+    }
+}
+
+void VecEnv::processChunks() {
+    int chunk;
+    while ((chunk = nextChunk.fetch_add(1)) * chunkSize < numEnvs) {
+        int begin = chunk * chunkSize;
+        int end = std::min(begin + chunkSize, numEnvs);
+        if (job == Job::Reset) {
+            resetRange(begin, end);
+        } else {
+            stepRange(begin, end);
+        }
+    }
+}
+
+void VecEnv::resetEnv(int i) {
+    environments[i].reset();
+    drones[i].reset(startPosition);
+    episodeTimes[i] = 0.0f;
+}
+
+void VecEnv::resetRange(int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        if (jobSeeds) {
+            environments[i] = Environment(envConfig(config, jobSeeds[i]));  // First hole of the new sequence
+            drones[i].reset(startPosition);
+            episodeTimes[i] = 0.0f;
+        } else {
+            resetEnv(i);
+        }
+        if (jobObservations) {
+            drones[i].writeSensorReadings(environments[i], jobObservations + (size_t)i * observationSize);
+        }
+    }
+}
+
+void VecEnv::stepRange(int begin, int end) {
+    // Physics and wall tests for simdLanes envs at a time (bit-identical to
+    // Drone / Environment), then rewards and resets env by env
+    for (int block = begin; block < end; block += simdLanes) {
+        int count = std::min(simdLanes, end - block);
+        Vec3xN position, velocity, control;
+        FloatN radius = splat(0.0f);
+        WallN wall;
+        MaskN active = maskFirst(count);
+        for (int l = 0; l < count; l++) {
+            const Drone& drone = drones[block + l];
+            const float* action = jobActions + (size_t)(block + l) * actionSize;
+            position.setLane(l, drone.getPosition());
+            velocity.setLane(l, drone.getVelocity());
+            control.setLane(l, Vec3(action[0], action[1], action[2]));
+            radius[l] = drone.getRadius();
+            wall.setLane(l, environments[block + l]);
+            if (!drone.isActive()) {
+                active[l] = 0;
+            }
+        }
+
+        // The drones were built from config, so they share its limits
+        applyControlN(velocity, control, active, config.controlStrength, config.maxSpeed);
+        updateN(position, velocity, active, dt);
+
+        // Same order of checks as Swarm::update
+        MaskN inHole = (position.z > wall.wallZ - splat(0.5f)) & (position.z < wall.wallZ + splat(1.0f)) &
+                       isInHoleN(wall, position);
+        MaskN hitWall = collidesWithWallN(wall, position, radius);
+        MaskN outOfBounds = isOutOfBoundsN(wall, position);
+
+        for (int l = 0; l < count; l++) {
+            int i = block + l;
+            Drone& drone = drones[i];
+            const Environment& environment = environments[i];
+            drone.setState(position.lane(l), velocity.lane(l));
+            episodeTimes[i] += dt;
+
+            float reward = 0.0f;
+            uint8_t done = Running;
+            if (inHole[l]) {
+                drone.setSuccessful(true);
+                reward = trainer.calculateReward(drone, environment, true, false);
+                done = Success;
+            } else {
+                bool collided = hitWall[l] != 0;
+                if (collided) {
+                    reward += trainer.calculateReward(drone, environment, false, true);
+                }
+                if (outOfBounds[l]) {
+                    reward += trainer.calculateReward(drone, environment, false, true);
+                    collided = true;
+                }
+                if (collided) {
+                    done = Crashed;
+                } else {
+                    reward = trainer.calculateReward(drone, environment, false, false) * dt;
+                    if (episodeTimes[i] >= config.maxEpisodeTime) {
+                        done = Timeout;
+                    }
+                }
+            }
+
+            if (done != Running) {
+                resetEnv(i);
+            }
+
+            jobRewards[i] = reward;
+            jobDones[i] = done;
+            drone.writeSensorReadings(environments[i], jobObservations + (size_t)i * observationSize);
+        }
+    }
+}